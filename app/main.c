@@ -1,4 +1,6 @@
 #include "book_management.h"
+#include "library_journal.h"
+#include "library_lazy.h"
 #include "library_management.h"
 #include "member_management.h"
 #include <stdio.h>
@@ -50,11 +52,67 @@ void print_menu(void)
     printf("Choose an option: ");
 }
 
-int main(void)
+// Answers one query from the saved library.dat without loading it; changes
+// still only in the journal are not seen
+int run_query(int argc, char *argv[])
+{
+    int identity = argc == 3 ? atoi(argv[2]) : 0;
+    int is_stats = argc == 2 && strcmp(argv[1], "--stats") == 0;
+    int is_book = identity > 0 && strcmp(argv[1], "--book") == 0;
+    int is_member = identity > 0 && strcmp(argv[1], "--member") == 0;
+    if (!is_stats && !is_book && !is_member)
+    {
+        fprintf(stderr, "Usage: %s [--stats | --book ID | --member ID]\n",
+                argv[0]);
+        return 2;
+    }
+
+    LazyLibrary *library = open_library_lazily("library.dat", 0);
+    if (!library)
+    {
+        return 1;
+    }
+    int found = 1;
+    if (is_stats)
+    {
+        print_lazy_library_statistics(library);
+    }
+    else if (is_book)
+    {
+        const Book *book = lazy_find_book_by_id(library, identity);
+        found = book != NULL;
+        if (found)
+        {
+            print_book(book);
+        }
+    }
+    else
+    {
+        const Member *member = lazy_find_member_by_id(library, identity);
+        found = member != NULL;
+        if (found)
+        {
+            print_member(member);
+        }
+    }
+    if (!found)
+    {
+        printf("No record with ID %d\n", identity);
+    }
+    close_lazy_library(library);
+    return found ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
 {
     Library *library = NULL;
+    LibraryJournal journal;
 
     open_syslog_connection();
+    if (argc > 1)
+    {
+        return run_query(argc, argv);
+    }
 
     // Try to load existing library data
     library = load_library_from_file("library.dat");
@@ -70,6 +128,16 @@ int main(void)
         }
     }
 
+    // Operations since the last save are recovered from the journal
+    if (!journal_open(&journal, "library.journal", "library.dat", library))
+    {
+        fprintf(stderr, "Failed to open library journal\n");
+        delete_library(library);
+        return 1;
+    }
+    // One operation per prompt, so there is nothing to batch
+    journal.group_commit_records = 1;
+
     int choice = 0;
     char title[MAX_TITLE_LENGTH];
     char author[MAX_AUTHOR_LENGTH];
@@ -97,7 +165,7 @@ int main(void)
             read_string(author, MAX_AUTHOR_LENGTH, "Enter author: ");
             read_string(isbn, MAX_ISBN_LENGTH, "Enter ISBN: ");
 
-            if (add_book_to_library(library, title, author, isbn))
+            if (journal_add_book(&journal, library, title, author, isbn))
             {
                 printf("Book added successfully!\n");
                 syslog(LOG_INFO,
@@ -122,7 +190,7 @@ int main(void)
             read_string(name, MAX_NAME_LENGTH, "Enter member name: ");
             read_string(email, MAX_EMAIL_LENGTH, "Enter email: ");
 
-            if (add_member_to_library(library, name, email))
+            if (journal_add_member(&journal, library, name, email))
             {
                 printf("Member added successfully!\n");
                 syslog(LOG_INFO,
@@ -147,7 +215,7 @@ int main(void)
             scanf("%d", &book_id);
             clear_input_buffer();
 
-            if (borrow_book(library, member_id, book_id))
+            if (journal_borrow_book(&journal, library, member_id, book_id))
             {
                 printf("Book borrowed successfully!\n");
                 syslog(LOG_INFO,
@@ -172,7 +240,7 @@ int main(void)
             scanf("%d", &book_id);
             clear_input_buffer();
 
-            if (return_book(library, member_id, book_id))
+            if (journal_return_book(&journal, library, member_id, book_id))
             {
                 printf("Book returned successfully!\n");
                 syslog(LOG_INFO,
@@ -202,7 +270,7 @@ int main(void)
             printf("Enter book ID to remove: ");
             scanf("%d", &book_id);
             clear_input_buffer();
-            remove_book_from_library(library, book_id);
+            journal_remove_book(&journal, library, book_id);
             printf("Book removed if it existed.\n");
             break;
 
@@ -210,16 +278,22 @@ int main(void)
             printf("Enter member ID to remove: ");
             scanf("%d", &member_id);
             clear_input_buffer();
-            remove_member_from_library(library, member_id);
+            journal_remove_member(&journal, library, member_id);
             printf("Member removed if they existed.\n");
             break;
 
         case 9:
             print_library_statistics(library);
+            if (journal.background.metrics.completed > 0)
+            {
+                printf("Last Snapshot: %lld bytes in %lld ms\n",
+                       journal.background.metrics.bytes_written,
+                       journal.background.metrics.duration_ms);
+            }
             break;
 
         case 10:
-            if (save_library_to_file(library, "library.dat"))
+            if (journal_checkpoint(&journal, library))
             {
                 printf("Library data saved successfully!\n");
                 syslog(LOG_INFO, "Library data saved to file\n");
@@ -229,6 +303,7 @@ int main(void)
                 printf("Failed to save library data.\n");
                 syslog(LOG_ERR, "Failed to save library data to file\n");
             }
+            journal_close(&journal);
             delete_library(library);
             return 0;
 
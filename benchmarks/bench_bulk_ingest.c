@@ -0,0 +1,90 @@
+// Compares per-call add_book_to_library with the streaming CSV importer.
+// Usage: BenchBulkIngest [rows] (default 1000000)
+#include "book_import.h"
+#include "book_management.h"
+#include "library_management.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <time.h>
+
+#define FEED_FILENAME "bench_bulk_ingest.csv"
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int write_feed(long rows)
+{
+    FILE *file = fopen(FEED_FILENAME, "w");
+    if (!file)
+    {
+        return 0;
+    }
+    fputs("title,author,isbn\n", file);
+    for (long i = 0; i < rows; i++)
+    {
+        fprintf(file, "Title %ld,Author %ld,%ld\n", i, i % 5000, i);
+    }
+    return fclose(file) == 0;
+}
+
+static void report(const char *label, long rows, double elapsed)
+{
+    printf("%-24s %10ld rows %10.3f s %14.0f rows/s\n",
+           label,
+           rows,
+           elapsed,
+           (double)rows / elapsed);
+}
+
+int main(int argc, char **argv)
+{
+    long rows = argc > 1 ? strtol(argv[1], NULL, 10) : 1000000L;
+
+    // Keep per-book syslog traffic out of the measurement
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    if (rows <= 0 || !write_feed(rows))
+    {
+        fprintf(stderr, "Failed to write %s\n", FEED_FILENAME);
+        return 1;
+    }
+
+    Library *library = create_library();
+    if (!library)
+    {
+        return 1;
+    }
+    char title[MAX_TITLE_LENGTH];
+    char author[MAX_AUTHOR_LENGTH];
+    char isbn[MAX_ISBN_LENGTH];
+    double start = now_seconds();
+    for (long i = 0; i < rows; i++)
+    {
+        snprintf(title, sizeof(title), "Title %ld", i);
+        snprintf(author, sizeof(author), "Author %ld", i % 5000);
+        snprintf(isbn, sizeof(isbn), "%ld", i);
+        add_book_to_library(library, title, author, isbn);
+    }
+    report("add_book_to_library", rows, now_seconds() - start);
+    deinit_library(library);
+    free(library);
+
+    library = create_library();
+    if (!library)
+    {
+        return 1;
+    }
+    start = now_seconds();
+    int imported = import_books_from_file(library, FEED_FILENAME, ',', 1);
+    report("import_books_from_file", imported, now_seconds() - start);
+    deinit_library(library);
+    free(library);
+
+    remove(FEED_FILENAME);
+    return imported == rows ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// Measures borrow/return throughput on a shared library as threads are
+// added, with the lock-free checkout path against the same calls behind
+// one global mutex. Each thread borrows as its own member from books
+// interleaved with the other threads' books, so all threads contend for
+// the same availability-bitmap words and cache lines.
+// Usage: BenchConcurrentCheckout [pairs_per_thread] (default 1000000)
+#include "book_management.h"
+#include "library_management.h"
+#include "member_management.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <time.h>
+
+#define MAX_THREADS 8
+#define BOOKS_PER_THREAD 4096
+
+typedef struct
+{
+    Library *library;
+    pthread_mutex_t *mutex;
+    int member_id;
+    int first_book;
+    int stride;
+    long pairs;
+} Worker;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void *checkout_loop(void *argument)
+{
+    Worker *worker = (Worker *)argument;
+    for (long i = 0; i < worker->pairs; i++)
+    {
+        int book_id = worker->first_book +
+                      (int)(i % BOOKS_PER_THREAD) * worker->stride;
+        if (worker->mutex)
+        {
+            pthread_mutex_lock(worker->mutex);
+        }
+        borrow_book(worker->library, worker->member_id, book_id);
+        return_book(worker->library, worker->member_id, book_id);
+        if (worker->mutex)
+        {
+            pthread_mutex_unlock(worker->mutex);
+        }
+    }
+    return NULL;
+}
+
+static double run(Library *library,
+                  pthread_mutex_t *mutex,
+                  int num_threads,
+                  long pairs)
+{
+    Worker workers[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    for (int i = 0; i < num_threads; i++)
+    {
+        workers[i].library = library;
+        workers[i].mutex = mutex;
+        workers[i].member_id = library->members[i].ident;
+        workers[i].first_book = library->books[i].ident;
+        workers[i].stride = num_threads;
+        workers[i].pairs = pairs;
+    }
+
+    double start = now_seconds();
+    int started = 0;
+    while (started < num_threads &&
+           pthread_create(&threads[started],
+                          NULL,
+                          checkout_loop,
+                          &workers[started]) == 0)
+    {
+        started++;
+    }
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    return (double)started * (double)pairs / (now_seconds() - start);
+}
+
+int main(int argc, char **argv)
+{
+    long pairs = argc > 1 ? strtol(argv[1], NULL, 10) : 1000000L;
+
+    // Keep per-checkout syslog traffic out of the measurement
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    Library *library = create_library();
+    if (!library || pairs <= 0)
+    {
+        return 1;
+    }
+    for (int i = 0; i < MAX_THREADS * BOOKS_PER_THREAD; i++)
+    {
+        add_book_to_library(library, "Title", "Author", "");
+    }
+    for (int i = 0; i < MAX_THREADS; i++)
+    {
+        add_member_to_library(library, "Reader", "reader@example.com");
+    }
+
+    printf("%-10s %8s %16s\n", "mode", "threads", "pairs/s");
+    printf("%-10s %8d %16.0f\n", "unshared", 1, run(library, NULL, 1, pairs));
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2)
+    {
+        printf("%-10s %8d %16.0f\n",
+               "mutex",
+               threads,
+               run(library, &mutex, threads, pairs));
+    }
+    pthread_mutex_destroy(&mutex);
+
+    if (!enable_library_concurrency(library))
+    {
+        return 1;
+    }
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2)
+    {
+        printf("%-10s %8d %16.0f\n",
+               "lock-free",
+               threads,
+               run(library, NULL, threads, pairs));
+    }
+
+    deinit_library(library);
+    free(library);
+    return 0;
+}
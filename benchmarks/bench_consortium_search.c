@@ -0,0 +1,82 @@
+// Measures a consortium-wide "find an available copy" title search when
+// one branch holds most of the books, as work-stealing threads are added.
+// Usage: BenchConsortiumSearch [books] (default 1000000)
+#include "book_management.h"
+#include "consortium.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <time.h>
+
+#define BRANCHES 8
+#define REPEATS 3
+// Share of the books held by branch 0; the rest split evenly
+#define BUSY_PERCENT 80
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int fill_branches(Consortium *consortium, int num_books)
+{
+    BookRecord *records = malloc((size_t)num_books * sizeof(BookRecord));
+    if (!records)
+    {
+        return 0;
+    }
+    for (int i = 0; i < num_books; i++)
+    {
+        records[i] = (BookRecord){"Filler", "Author", "", 0, 0};
+    }
+    int busy = (int)((long)num_books * BUSY_PERCENT / 100);
+    int rest = (num_books - busy) / (BRANCHES - 1);
+    int added = add_books_bulk(consortium_branch(consortium, 0), records, busy);
+    for (int i = 1; i < BRANCHES; i++)
+    {
+        Library *branch = consortium_branch(consortium, i);
+        added += add_books_bulk(branch, records, rest);
+    }
+    free(records);
+    return added == busy + rest * (BRANCHES - 1);
+}
+
+int main(int argc, char **argv)
+{
+    long num_books = argc > 1 ? strtol(argv[1], NULL, 10) : 1000000L;
+
+    // Keep per-call syslog traffic out of the measurement
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    printf("%8s %14s\n", "threads", "search ms");
+    for (int threads = 1; threads <= 8; threads *= 2)
+    {
+        Consortium *consortium =
+            create_consortium(BRANCHES, CONSORTIUM_SHARD_BY_BRANCH, threads);
+        if (!consortium || num_books <= 0 || num_books > 100000000L ||
+            !fill_branches(consortium, (int)num_books))
+        {
+            fprintf(stderr, "Failed to allocate %ld books\n", num_books);
+            delete_consortium(consortium);
+            return 1;
+        }
+
+        // A title no branch holds, so every book is scanned
+        double best = 1e9;
+        int found = 0;
+        for (int repeat = 0; repeat < REPEATS; repeat++)
+        {
+            ConsortiumCopy copy;
+            double start = now_seconds();
+            found += consortium_find_available_copy(
+                consortium, "Missing Title", 1, &copy);
+            double elapsed = now_seconds() - start;
+            best = elapsed < best ? elapsed : best;
+        }
+        printf("%8d %14.1f   (found %d)\n", threads, best * 1e3, found);
+        delete_consortium(consortium);
+    }
+    return 0;
+}
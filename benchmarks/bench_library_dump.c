@@ -0,0 +1,148 @@
+// Measures the JSON Lines / CSV exporters and importers against a
+// printf-per-field baseline.
+// Usage: BenchLibraryDump [books] (default 1000000)
+#include "book_management.h"
+#include "library_export.h"
+#include "library_management.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <time.h>
+
+#define DUMP_FILENAME "bench_library_dump.txt"
+#define FILL_BATCH 4096
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static long file_size(const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static void report(const char *label, long rows, double elapsed)
+{
+    printf("%-24s %10ld rows %10.3f s %14.0f rows/s %8.1f MB/s\n",
+           label,
+           rows,
+           elapsed,
+           (double)rows / elapsed,
+           (double)file_size(DUMP_FILENAME) / elapsed / 1e6);
+}
+
+static int fill_library(Library *library, long books)
+{
+    static char titles[FILL_BATCH][MAX_TITLE_LENGTH];
+    static char authors[FILL_BATCH][MAX_AUTHOR_LENGTH];
+    static char isbns[FILL_BATCH][MAX_ISBN_LENGTH];
+    BookRecord records[FILL_BATCH];
+    for (long done = 0; done < books;)
+    {
+        int count = 0;
+        for (; count < FILL_BATCH && done < books; count++, done++)
+        {
+            snprintf(titles[count],
+                     MAX_TITLE_LENGTH,
+                     "Title \"%ld\", volume %ld",
+                     done,
+                     done % 7);
+            snprintf(
+                authors[count], MAX_AUTHOR_LENGTH, "Author %ld", done % 5000);
+            snprintf(isbns[count], MAX_ISBN_LENGTH, "%d", (int)done);
+            records[count] =
+                (BookRecord){titles[count], authors[count], isbns[count], 0, 0};
+        }
+        if (add_books_bulk(library, records, count) != count)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// What a caller had to write before: one fprintf per field
+static long export_with_fprintf(const Library *library)
+{
+    FILE *file = fopen(DUMP_FILENAME, "w");
+    if (!file)
+    {
+        return -1;
+    }
+    long written = 0;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        const Book *book = &library->books[i];
+        fprintf(file, "%s,", book->title);
+        fprintf(file, "%s,", book->author);
+        fprintf(file, "%s,", book->isbn);
+        fprintf(file, "%d,", book->ident);
+        fprintf(file, "%d,", book->is_available);
+        fprintf(file, "%lld\n", (long long)book->added_date);
+        written++;
+    }
+    fclose(file);
+    return written;
+}
+
+int main(int argc, char **argv)
+{
+    long books = argc > 1 ? strtol(argv[1], NULL, 10) : 1000000L;
+
+    // Keep per-book syslog traffic out of the measurement
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    Library *library = create_library();
+    if (!library || books <= 0 || books > 100000000L ||
+        !fill_library(library, books))
+    {
+        fprintf(stderr, "Failed to build a library of %ld books\n", books);
+        return 1;
+    }
+
+    double start = now_seconds();
+    long baseline = export_with_fprintf(library);
+    report("fprintf per field", baseline, now_seconds() - start);
+
+    int ok = 1;
+    const DumpFormat formats[] = {DUMP_CSV, DUMP_JSON_LINES};
+    const char *names[] = {"csv", "jsonl"};
+    for (int f = 0; f < 2; f++)
+    {
+        char label[64];
+        start = now_seconds();
+        int exported = export_library_books(library, DUMP_FILENAME, formats[f]);
+        snprintf(label, sizeof(label), "export %s", names[f]);
+        report(label, exported, now_seconds() - start);
+
+        Library *imported = create_library();
+        if (!imported)
+        {
+            return 1;
+        }
+        reset_book_id();
+        start = now_seconds();
+        int added = import_library_books(imported, DUMP_FILENAME, formats[f]);
+        snprintf(label, sizeof(label), "import %s", names[f]);
+        report(label, added, now_seconds() - start);
+        ok = ok && exported == books && added == books;
+        deinit_library(imported);
+        free(imported);
+    }
+
+    remove(DUMP_FILENAME);
+    deinit_library(library);
+    free(library);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+// Measures find_member_by_id cost as the member base grows.
+// Usage: BenchMemberLookup [max_members] (default 10000000)
+#include "library_management.h"
+#include "member_management.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <time.h>
+
+#define LOOKUPS_PER_SIZE 1000000
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int fill_members(Library *library, int count)
+{
+    Member *members =
+        realloc(library->members, (size_t)count * sizeof(Member));
+    if (!members)
+    {
+        return 0;
+    }
+    library->members = members;
+    library->capacity_members = count;
+    for (int i = library->num_members; i < count; i++)
+    {
+        members[i].ident = i + 1;
+        snprintf(members[i].name, MAX_NAME_LENGTH, "Member %d", i + 1);
+        members[i].email[0] = '\0';
+        members[i].num_borrowed_books = 0;
+    }
+    library->num_members = count;
+    return rebuild_member_index(library);
+}
+
+int main(int argc, char **argv)
+{
+    long max_members = argc > 1 ? strtol(argv[1], NULL, 10) : 10000000L;
+
+    // Keep per-lookup syslog traffic out of the measurement
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    Library *library = create_library();
+    if (!library)
+    {
+        return 1;
+    }
+
+    printf("%12s %14s %14s\n", "members", "ns/lookup", "hits");
+    unsigned int seed = 12345U;
+    for (long size = 10000; size <= max_members; size *= 10)
+    {
+        if (!fill_members(library, (int)size))
+        {
+            fprintf(stderr, "Failed to allocate %ld members\n", size);
+            break;
+        }
+
+        long hits = 0;
+        double start = now_seconds();
+        for (int i = 0; i < LOOKUPS_PER_SIZE; i++)
+        {
+            seed = seed * 1103515245U + 12345U;
+            int ident = (int)(seed % (unsigned int)size) + 1;
+            hits += find_member_by_id(library, ident) != NULL;
+        }
+        double elapsed = now_seconds() - start;
+
+        printf("%12ld %14.1f %14ld\n",
+               size,
+               elapsed * 1e9 / LOOKUPS_PER_SIZE,
+               hits);
+    }
+
+    deinit_library(library);
+    free(library);
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Measures catalog-wide scans (availability count, date-range count and
+// unindexed search) as parallel_for threads are added.
+// Usage: BenchParallelScan [books] (default 10000000)
+#include "book_columns.h"
+#include "book_management.h"
+#include "library_management.h"
+#include "parallel_for.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <time.h>
+
+// Counts are best of REPEATS; the much slower search runs once
+#define REPEATS 3
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Fills the array directly so the text index stays unbuilt and search
+// takes the scan path
+static int fill_books(Library *library, int count)
+{
+    Book *books = realloc(library->books, (size_t)count * sizeof(Book));
+    if (!books)
+    {
+        return 0;
+    }
+    library->books = books;
+    library->capacity_books = count;
+    for (int i = 0; i < count; i++)
+    {
+        Book *book = &books[i];
+        book->ident = i + 1;
+        snprintf(book->title, MAX_TITLE_LENGTH, "Title %d", i % 100000);
+        snprintf(book->author, MAX_AUTHOR_LENGTH, "Author %d", i % 5000);
+        book->isbn[0] = '\0';
+        book->is_available = i % 3 != 0;
+        book->added_date = (time_t)i;
+        book->author_id = 0;
+    }
+    library->num_books = count;
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    long num_books = argc > 1 ? strtol(argv[1], NULL, 10) : 10000000L;
+
+    // Keep per-search syslog traffic out of the measurement
+    setlogmask(LOG_UPTO(LOG_WARNING));
+
+    Library library = {0};
+    if (num_books <= 0 || num_books > 100000000L ||
+        !fill_books(&library, (int)num_books))
+    {
+        fprintf(stderr, "Failed to allocate %ld books\n", num_books);
+        return 1;
+    }
+
+    printf("%8s %14s %14s %14s\n",
+           "threads",
+           "available ms",
+           "added ms",
+           "search ms");
+    for (int threads = 1; threads <= 8; threads *= 2)
+    {
+        set_parallel_for_threads(threads);
+        double best[2] = {1e9, 1e9};
+        long checksum = 0;
+        for (int repeat = 0; repeat < REPEATS; repeat++)
+        {
+            double start = now_seconds();
+            checksum += count_available_books(&library);
+            double available = now_seconds() - start;
+
+            start = now_seconds();
+            checksum +=
+                count_books_added_between(&library, 0, (time_t)num_books / 2);
+            double added = now_seconds() - start;
+
+            best[0] = available < best[0] ? available : best[0];
+            best[1] = added < best[1] ? added : best[1];
+        }
+
+        double start = now_seconds();
+        int num_results = 0;
+        free(search_books(&library, "title 4242", &num_results));
+        checksum += num_results;
+        double search = now_seconds() - start;
+        printf("%8d %14.1f %14.1f %14.1f   (checksum %ld)\n",
+               threads,
+               best[0] * 1e3,
+               best[1] * 1e3,
+               search * 1e3,
+               checksum);
+    }
+
+    set_parallel_for_threads(0);
+    free(library.books);
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include "book_availability.h"
+#include "book_columns.h"
+#include "book_management.h"
+#include "../indexManagement/bitset.h"
+#include "../indexManagement/library_lock.h"
+#include <stdio.h>
+
+int rebuild_book_availability(Library *library)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Rebuild Availability Library pointer is NULL\n");
+        syslog(LOG_ERR, "Rebuild Availability Library pointer is NULL\n");
+        return 0;
+    }
+
+    int max_ident = 0;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        if (library->books[i].ident > max_ident)
+        {
+            max_ident = library->books[i].ident;
+        }
+    }
+
+    int ready = bitset_is_built(&library->available_books)
+                    ? bitset_reserve(&library->available_books, max_ident)
+                    : bitset_init(&library->available_books, max_ident);
+    if (!ready)
+    {
+        bitset_deinit(&library->available_books);
+        return 0;
+    }
+
+    bitset_clear_all(&library->available_books);
+    library->num_available_books = 0;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        const Book *book = &library->books[i];
+        if (book->ident > 0 && book->is_available)
+        {
+            bitset_set(&library->available_books, book->ident);
+            library->num_available_books++;
+        }
+    }
+    return 1;
+}
+
+int track_book_added(Library *library, const Book *book)
+{
+    if (!bitset_is_built(&library->available_books))
+    {
+        return 1;
+    }
+    if (!bitset_reserve(&library->available_books, book->ident))
+    {
+        return 0;
+    }
+    if (book->is_available)
+    {
+        bitset_set(&library->available_books, book->ident);
+        library->num_available_books++;
+    }
+    return 1;
+}
+
+void track_book_removed(Library *library, const Book *book)
+{
+    if (bitset_test(&library->available_books, book->ident))
+    {
+        bitset_reset(&library->available_books, book->ident);
+        library->num_available_books--;
+    }
+}
+
+void set_book_available(Library *library, Book *book, int available)
+{
+    if (!library || !book)
+    {
+        return;
+    }
+
+    available = available ? 1 : 0;
+    if (bitset_is_built(&library->available_books) &&
+        bitset_test(&library->available_books, book->ident) != available)
+    {
+        if (available)
+        {
+            bitset_set(&library->available_books, book->ident);
+            library->num_available_books++;
+        }
+        else
+        {
+            bitset_reset(&library->available_books, book->ident);
+            library->num_available_books--;
+        }
+    }
+
+    book->is_available = available;
+    if (library->books && book >= library->books &&
+        book < library->books + library->num_books)
+    {
+        book_columns_store(library, (int)(book - library->books));
+    }
+}
+
+// Mirrors a claimed or released book into the bitmap, counter and column.
+// Only the thread that won the book's is_available flip calls this, so the
+// bit it changes cannot be changing under it.
+static void track_book_flip(Library *library, Book *book, int available)
+{
+    if (bitset_is_built(&library->available_books))
+    {
+        if (available)
+        {
+            bitset_set(&library->available_books, book->ident);
+        }
+        else
+        {
+            bitset_reset(&library->available_books, book->ident);
+        }
+        atomic_fetch_add_explicit(&library->num_available_books,
+                                  available ? 1 : -1,
+                                  memory_order_relaxed);
+    }
+    if (book_columns_enabled(library) && book >= library->books &&
+        book < library->books + library->num_books)
+    {
+        atomic_store_explicit(
+            &library->book_columns.available[book - library->books],
+            (unsigned char)available,
+            memory_order_relaxed);
+    }
+}
+
+int claim_book(Library *library, Book *book)
+{
+    int expected = 1;
+    if (!library || !book ||
+        !atomic_compare_exchange_strong(&book->is_available, &expected, 0))
+    {
+        return 0;
+    }
+    track_book_flip(library, book, 0);
+    return 1;
+}
+
+void release_book(Library *library, Book *book)
+{
+    if (!library || !book)
+    {
+        return;
+    }
+    // The flag goes last, so the next claimant finds the bitmap settled
+    track_book_flip(library, book, 1);
+    atomic_store(&book->is_available, 1);
+}
+
+int available_book_total(const Library *library)
+{
+    if (!library)
+    {
+        return 0;
+    }
+    if (bitset_is_built(&library->available_books))
+    {
+        return library->num_available_books;
+    }
+    return count_available_books(library);
+}
+
+static int count_available_books_in_range_unlocked(const Library *library,
+                                                   int first_id,
+                                                   int last_id)
+{
+    if (!library || first_id > last_id)
+    {
+        return 0;
+    }
+
+    if (bitset_is_built(&library->available_books))
+    {
+        return bitset_count_range(
+            &library->available_books, first_id, last_id + 1);
+    }
+
+    int count = 0;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        const Book *book = &library->books[i];
+        count += book->ident >= first_id && book->ident <= last_id &&
+                 book->ident != 0 && book->is_available;
+    }
+    return count;
+}
+
+// Bitmap words are atomic, so scans run alongside checkouts and see each
+// book either before or after its latest flip
+int count_available_books_in_range(const Library *library,
+                                   int first_id,
+                                   int last_id)
+{
+    library_lock_shared(library);
+    int count =
+        count_available_books_in_range_unlocked(library, first_id, last_id);
+    library_unlock_shared(library);
+    return count;
+}
+
+static Book *find_first_available_book_unlocked(Library *library,
+                                                int first_id,
+                                                int last_id)
+{
+    if (!library || first_id > last_id)
+    {
+        return NULL;
+    }
+
+    if (bitset_is_built(&library->available_books))
+    {
+        int ident = bitset_find_next(
+            &library->available_books, first_id, last_id + 1);
+        return ident < 0 ? NULL : find_book_by_id(library, ident);
+    }
+
+    Book *first = NULL;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        Book *book = &library->books[i];
+        if (book->ident >= first_id && book->ident <= last_id &&
+            book->ident != 0 && book->is_available &&
+            (!first || book->ident < first->ident))
+        {
+            first = book;
+        }
+    }
+    return first;
+}
+
+Book *find_first_available_book(Library *library, int first_id, int last_id)
+{
+    library_lock_shared(library);
+    Book *book = find_first_available_book_unlocked(library, first_id, last_id);
+    library_unlock_shared(library);
+    return book;
+}
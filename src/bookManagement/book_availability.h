@@ -0,0 +1,23 @@
+// include/book_availability.h
+#ifndef BOOK_AVAILABILITY_H
+#define BOOK_AVAILABILITY_H
+
+#include "../include/structures.h"
+
+int rebuild_book_availability(Library *library);
+int track_book_added(Library *library, const Book *book);
+void track_book_removed(Library *library, const Book *book);
+void set_book_available(Library *library, Book *book, int available);
+// Lock-free checkout transitions. claim_book takes the book off the shelf
+// only if it is on it, and returns 0 when another caller got there first;
+// release_book puts a claimed book back.
+int claim_book(Library *library, Book *book);
+void release_book(Library *library, Book *book);
+
+int available_book_total(const Library *library);
+int count_available_books_in_range(const Library *library,
+                                   int first_id,
+                                   int last_id);
+Book *find_first_available_book(Library *library, int first_id, int last_id);
+
+#endif
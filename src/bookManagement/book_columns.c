@@ -0,0 +1,313 @@
+#include "book_columns.h"
+#include "../indexManagement/parallel_for.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int book_columns_enabled(const Library *library)
+{
+    return library && library->book_columns.idents != NULL;
+}
+
+static int reserve_columns(BookColumns *columns, int capacity)
+{
+    if (capacity <= columns->capacity)
+    {
+        return 1;
+    }
+
+    int *idents =
+        realloc(columns->idents, (size_t)capacity * sizeof(int));
+    if (!idents)
+    {
+        return 0;
+    }
+    columns->idents = idents;
+
+    atomic_uchar *available =
+        realloc(columns->available, (size_t)capacity * sizeof(atomic_uchar));
+    if (!available)
+    {
+        return 0;
+    }
+    columns->available = available;
+
+    time_t *added_dates =
+        realloc(columns->added_dates, (size_t)capacity * sizeof(time_t));
+    if (!added_dates)
+    {
+        return 0;
+    }
+    columns->added_dates = added_dates;
+
+    columns->capacity = capacity;
+    return 1;
+}
+
+int book_columns_reserve(Library *library, int capacity)
+{
+    if (!book_columns_enabled(library))
+    {
+        return 1;
+    }
+    if (!reserve_columns(&library->book_columns, capacity))
+    {
+        fprintf(stderr, "Memory allocation failed for book columns\n");
+        syslog(LOG_ERR, "Memory allocation failed for book columns\n");
+        return 0;
+    }
+    return 1;
+}
+
+void book_columns_store(Library *library, int slot)
+{
+    if (!book_columns_enabled(library))
+    {
+        return;
+    }
+
+    const Book *book = &library->books[slot];
+    BookColumns *columns = &library->book_columns;
+    columns->idents[slot] = book->ident;
+    atomic_store_explicit(&columns->available[slot],
+                          (unsigned char)book->is_available,
+                          memory_order_relaxed);
+    columns->added_dates[slot] = book->added_date;
+}
+
+void book_columns_erase(Library *library, int slot)
+{
+    if (!book_columns_enabled(library))
+    {
+        return;
+    }
+
+    BookColumns *columns = &library->book_columns;
+    size_t tail = (size_t)(library->num_books - slot - 1);
+    memmove(&columns->idents[slot], &columns->idents[slot + 1],
+            tail * sizeof(int));
+    for (size_t i = (size_t)slot; i < (size_t)slot + tail; i++)
+    {
+        atomic_store_explicit(
+            &columns->available[i],
+            atomic_load_explicit(&columns->available[i + 1],
+                                 memory_order_relaxed),
+            memory_order_relaxed);
+    }
+    memmove(&columns->added_dates[slot], &columns->added_dates[slot + 1],
+            tail * sizeof(time_t));
+}
+
+int book_columns_refresh(Library *library)
+{
+    if (!book_columns_enabled(library))
+    {
+        return 1;
+    }
+    if (!book_columns_reserve(library, library->capacity_books))
+    {
+        return 0;
+    }
+    for (int i = 0; i < library->num_books; i++)
+    {
+        book_columns_store(library, i);
+    }
+    return 1;
+}
+
+int enable_book_columns(Library *library)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Enable Columns Library pointer is NULL\n");
+        syslog(LOG_ERR, "Enable Columns Library pointer is NULL\n");
+        return 0;
+    }
+
+    BookColumns *columns = &library->book_columns;
+    int capacity = library->capacity_books > 0 ? library->capacity_books : 1;
+    if (!reserve_columns(columns, capacity))
+    {
+        fprintf(stderr, "Memory allocation failed for book columns\n");
+        syslog(LOG_ERR, "Memory allocation failed for book columns\n");
+        disable_book_columns(library);
+        return 0;
+    }
+
+    book_columns_refresh(library);
+    syslog(LOG_INFO, "Enabled columnar book storage\n");
+    return 1;
+}
+
+void disable_book_columns(Library *library)
+{
+    if (!library)
+    {
+        return;
+    }
+    free(library->book_columns.idents);
+    free(library->book_columns.available);
+    free(library->book_columns.added_dates);
+    memset(&library->book_columns, 0, sizeof(BookColumns));
+}
+
+int book_ident_at(const Library *library, int slot)
+{
+    if (book_columns_enabled(library))
+    {
+        return library->book_columns.idents[slot];
+    }
+    return library->books[slot].ident;
+}
+
+int book_available_at(const Library *library, int slot)
+{
+    if (book_columns_enabled(library))
+    {
+        return atomic_load_explicit(&library->book_columns.available[slot],
+                                    memory_order_relaxed);
+    }
+    const Book *book = &library->books[slot];
+    return book->ident != 0 && book->is_available;
+}
+
+time_t book_added_date_at(const Library *library, int slot)
+{
+    if (book_columns_enabled(library))
+    {
+        return library->book_columns.added_dates[slot];
+    }
+    return library->books[slot].added_date;
+}
+
+// Catalog-wide counts run as a parallel_for over cache-sized chunks. Each
+// chunk's count lands in its own slot of partials (or in a stack slot when
+// there is a single chunk) and the slots are summed afterwards.
+typedef struct
+{
+    const Library *library;
+    time_t from;
+    time_t until;
+    int *partials;
+} CountScan;
+
+static int count_scan(const Library *library,
+                      size_t item_size,
+                      ParallelForBody body,
+                      CountScan *scan)
+{
+    int num_chunks = parallel_for_chunks(library->num_books, item_size);
+    int single = 0;
+    scan->partials = num_chunks > 1
+                         ? (int *)calloc((size_t)num_chunks, sizeof(int))
+                         : &single;
+    if (!scan->partials)
+    {
+        // Without room for partials the scan still runs, on one thread
+        scan->partials = &single;
+        body(scan, 0, 0, library->num_books);
+        return single;
+    }
+    parallel_for(library->num_books, item_size, body, scan);
+    int total = 0;
+    for (int i = 0; i < num_chunks; i++)
+    {
+        total += scan->partials[i];
+    }
+    if (scan->partials != &single)
+    {
+        free(scan->partials);
+    }
+    return total;
+}
+
+static void count_available_flags(void *context, int chunk, int begin, int end)
+{
+    CountScan *scan = (CountScan *)context;
+    // Flips store to the column without the library lock; relaxed byte
+    // loads are plain loads on common hardware
+    const atomic_uchar *flags = scan->library->book_columns.available;
+    int available = 0;
+    for (int i = begin; i < end; i++)
+    {
+        available += atomic_load_explicit(&flags[i], memory_order_relaxed);
+    }
+    scan->partials[chunk] = available;
+}
+
+static void count_available_records(void *context,
+                                    int chunk,
+                                    int begin,
+                                    int end)
+{
+    CountScan *scan = (CountScan *)context;
+    const Book *books = scan->library->books;
+    int available = 0;
+    for (int i = begin; i < end; i++)
+    {
+        available += books[i].ident != 0 && books[i].is_available;
+    }
+    scan->partials[chunk] = available;
+}
+
+int count_available_books(const Library *library)
+{
+    if (!library)
+    {
+        return 0;
+    }
+
+    CountScan scan = {library, 0, 0, NULL};
+    if (book_columns_enabled(library))
+    {
+        return count_scan(
+            library, sizeof(atomic_uchar), count_available_flags, &scan);
+    }
+    return count_scan(library, sizeof(Book), count_available_records, &scan);
+}
+
+static void count_added_columns(void *context, int chunk, int begin, int end)
+{
+    CountScan *scan = (CountScan *)context;
+    const int *idents = scan->library->book_columns.idents;
+    const time_t *dates = scan->library->book_columns.added_dates;
+    int matches = 0;
+    for (int i = begin; i < end; i++)
+    {
+        matches += (idents[i] != 0) & (dates[i] >= scan->from) &
+                   (dates[i] < scan->until);
+    }
+    scan->partials[chunk] = matches;
+}
+
+static void count_added_records(void *context, int chunk, int begin, int end)
+{
+    CountScan *scan = (CountScan *)context;
+    const Book *books = scan->library->books;
+    int matches = 0;
+    for (int i = begin; i < end; i++)
+    {
+        matches += books[i].ident != 0 && books[i].added_date >= scan->from &&
+                   books[i].added_date < scan->until;
+    }
+    scan->partials[chunk] = matches;
+}
+
+int count_books_added_between(const Library *library,
+                              time_t from,
+                              time_t until)
+{
+    if (!library)
+    {
+        return 0;
+    }
+
+    CountScan scan = {library, from, until, NULL};
+    if (book_columns_enabled(library))
+    {
+        // Chunks are sized by the widest column they touch
+        return count_scan(
+            library, sizeof(time_t), count_added_columns, &scan);
+    }
+    return count_scan(library, sizeof(Book), count_added_records, &scan);
+}
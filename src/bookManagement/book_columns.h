@@ -0,0 +1,24 @@
+// include/book_columns.h
+#ifndef BOOK_COLUMNS_H
+#define BOOK_COLUMNS_H
+
+#include "../include/structures.h"
+
+int enable_book_columns(Library *library);
+void disable_book_columns(Library *library);
+int book_columns_enabled(const Library *library);
+int book_columns_reserve(Library *library, int capacity);
+void book_columns_store(Library *library, int slot);
+void book_columns_erase(Library *library, int slot);
+int book_columns_refresh(Library *library);
+
+int book_ident_at(const Library *library, int slot);
+int book_available_at(const Library *library, int slot);
+time_t book_added_date_at(const Library *library, int slot);
+
+int count_available_books(const Library *library);
+int count_books_added_between(const Library *library,
+                              time_t from,
+                              time_t until);
+
+#endif
@@ -0,0 +1,233 @@
+#include "book_import.h"
+#include "book_management.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IMPORT_BUFFER_SIZE (1 << 20)
+#define IMPORT_BATCH_SIZE 16384
+#define IMPORT_FIELDS 3
+
+typedef struct
+{
+    Library *library;
+    BookRecord *batch;
+    char delimiter;
+    int skip_line;
+    int num_records;
+    int added;
+    int malformed;
+} ImportState;
+
+int split_delimited_row(char *line,
+                        char delimiter,
+                        char **fields,
+                        int max_fields)
+{
+    int num_fields = 0;
+    char *cursor = line;
+    while (num_fields < max_fields)
+    {
+        if (*cursor == '"')
+        {
+            char *read = cursor + 1;
+            char *write = cursor;
+            fields[num_fields++] = write;
+            while (*read && !(read[0] == '"' && read[1] != '"'))
+            {
+                if (read[0] == '"')
+                {
+                    read++;
+                }
+                *write++ = *read++;
+            }
+            if (*read == '"')
+            {
+                read++;
+            }
+            *write = '\0';
+            cursor = strchr(read, delimiter);
+        }
+        else
+        {
+            fields[num_fields++] = cursor;
+            cursor = strchr(cursor, delimiter);
+            if (cursor)
+            {
+                *cursor = '\0';
+            }
+        }
+
+        if (!cursor)
+        {
+            break;
+        }
+        cursor++;
+    }
+    return num_fields;
+}
+
+int stream_lines(FILE *file,
+                 int (*handle_line)(void *context, char *line),
+                 int (*end_of_chunk)(void *context),
+                 void *context)
+{
+    char *buffer = (char *)malloc(IMPORT_BUFFER_SIZE + 1);
+    if (!buffer)
+    {
+        fprintf(stderr, "Memory allocation failed for import buffer\n");
+        syslog(LOG_ERR, "Memory allocation failed for import buffer\n");
+        return 0;
+    }
+
+    int ok = 1;
+    size_t used = 0;
+    while (ok)
+    {
+        used += fread(buffer + used, 1, IMPORT_BUFFER_SIZE - used, file);
+        int at_end = used < IMPORT_BUFFER_SIZE;
+        char *cursor = buffer;
+        char *end = buffer + used;
+        *end = '\0';
+
+        while (ok && cursor < end)
+        {
+            char *newline = memchr(cursor, '\n', (size_t)(end - cursor));
+            if (!newline && !at_end)
+            {
+                break;
+            }
+            char *next = newline ? newline + 1 : end;
+            if (newline)
+            {
+                *newline = '\0';
+            }
+            size_t length = (size_t)((newline ? newline : end) - cursor);
+            if (length > 0 && cursor[length - 1] == '\r')
+            {
+                cursor[length - 1] = '\0';
+            }
+            ok = handle_line(context, cursor);
+            cursor = next;
+        }
+
+        // Lines point into the buffer, so hand them over before reuse
+        ok = ok && end_of_chunk(context);
+        if (!ok || at_end)
+        {
+            break;
+        }
+
+        used = (size_t)(end - cursor);
+        if (used == IMPORT_BUFFER_SIZE)
+        {
+            fprintf(stderr, "Line too long while importing\n");
+            syslog(LOG_ERR, "Line too long while importing\n");
+            ok = 0;
+            break;
+        }
+        memmove(buffer, cursor, used);
+    }
+
+    if (ferror(file))
+    {
+        fprintf(stderr, "Failed to read import file\n");
+        syslog(LOG_ERR, "Failed to read import file\n");
+        ok = 0;
+    }
+    free(buffer);
+    return ok;
+}
+
+static int flush_batch(void *context)
+{
+    ImportState *state = (ImportState *)context;
+    if (state->num_records == 0)
+    {
+        return 1;
+    }
+    int added =
+        add_books_bulk(state->library, state->batch, state->num_records);
+    state->num_records = 0;
+    if (added < 0)
+    {
+        return 0;
+    }
+    state->added += added;
+    return 1;
+}
+
+static int import_line(void *context, char *line)
+{
+    ImportState *state = (ImportState *)context;
+    if (state->skip_line)
+    {
+        state->skip_line = 0;
+        return 1;
+    }
+    if (line[0] == '\0')
+    {
+        return 1;
+    }
+
+    char *fields[IMPORT_FIELDS];
+    if (split_delimited_row(line, state->delimiter, fields, IMPORT_FIELDS) <
+        IMPORT_FIELDS)
+    {
+        state->malformed++;
+        return 1;
+    }
+
+    BookRecord *record = &state->batch[state->num_records++];
+    record->title = fields[0];
+    record->author = fields[1];
+    record->isbn = fields[2];
+    record->ident = 0;
+    record->added_date = 0;
+    return state->num_records < IMPORT_BATCH_SIZE || flush_batch(state);
+}
+
+int import_books_from_file(Library *library,
+                           const char *filename,
+                           char delimiter,
+                           int has_header)
+{
+    if (!library || !filename || delimiter == '\0' || delimiter == '"')
+    {
+        fprintf(stderr, "Invalid parameters for importing books\n");
+        syslog(LOG_ERR, "Invalid parameters for importing books\n");
+        return -1;
+    }
+
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open file for reading\n");
+        syslog(LOG_ERR, "Failed to open file for reading\n");
+        return -1;
+    }
+
+    ImportState state = {0};
+    state.library = library;
+    state.delimiter = delimiter;
+    state.skip_line = has_header;
+    state.batch = (BookRecord *)malloc(IMPORT_BATCH_SIZE * sizeof(BookRecord));
+    if (!state.batch)
+    {
+        fprintf(stderr, "Memory allocation failed for book import\n");
+        syslog(LOG_ERR, "Memory allocation failed for book import\n");
+        fclose(file);
+        return -1;
+    }
+
+    int ok = stream_lines(file, import_line, flush_batch, &state);
+    free(state.batch);
+    fclose(file);
+
+    syslog(LOG_INFO,
+           "Imported %d books from %s (%d malformed rows)\n",
+           state.added,
+           filename,
+           state.malformed);
+    return ok ? state.added : -1;
+}
@@ -0,0 +1,35 @@
+// include/book_import.h
+#ifndef BOOK_IMPORT_H
+#define BOOK_IMPORT_H
+
+#include <stdio.h>
+
+#include "../include/structures.h"
+
+// Splits a delimited line into at most max_fields fields in place. Fields
+// may be double-quoted, with "" standing for a literal quote. Returns the
+// number of fields found.
+int split_delimited_row(char *line,
+                        char delimiter,
+                        char **fields,
+                        int max_fields);
+// Reads file through a 1 MiB buffer and calls handle_line for every line,
+// with the line ending removed. Lines point into the buffer, so
+// end_of_chunk is called before it is refilled. Returns 0 when a callback
+// fails, a line does not fit the buffer or the file cannot be read.
+int stream_lines(FILE *file,
+                 int (*handle_line)(void *context, char *line),
+                 int (*end_of_chunk)(void *context),
+                 void *context);
+
+// Streams rows of title, author and ISBN separated by delimiter (',' for
+// CSV, '\t' for TSV) into the library through add_books_bulk. Fields may
+// be double-quoted, with "" standing for a literal quote; a row must fit
+// on one line. Rows with fewer than three fields are skipped. Returns the
+// number of books added, or -1 if the file could not be read.
+int import_books_from_file(Library *library,
+                           const char *filename,
+                           char delimiter,
+                           int has_header);
+
+#endif
@@ -1,28 +1,60 @@
 #include "book_management.h"
+#include "book_availability.h"
+#include "book_columns.h"
+#include "../indexManagement/author_dictionary.h"
+#include "../indexManagement/bitset.h"
+#include "../indexManagement/growth_policy.h"
+#include "../indexManagement/hash_index.h"
+#include "../indexManagement/id_allocator.h"
+#include "../indexManagement/isbn.h"
+#include "../indexManagement/library_lock.h"
+#include "../indexManagement/parallel_for.h"
+#include "../indexManagement/token_index.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-static int next_book_id = 1;
+static IdAllocator book_ids = ID_ALLOCATOR_INIT;
 
 void reset_book_id(void) {
-    next_book_id = 1;
+    id_allocator_reset(&book_ids, 1);
 }
 
-void init_book(Book *book,
-               const char *title,
-               const char *author,
-               const char *isbn)
+int get_next_book_id(void)
 {
-    if (!book)
+    return id_allocator_peek(&book_ids);
+}
+
+void set_next_book_id(int ident)
+{
+    id_allocator_reset(&book_ids, ident);
+}
+
+IdAllocator *book_id_allocator(void)
+{
+    return &book_ids;
+}
+
+static void fill_book(Book *book,
+                      int ident,
+                      const char *title,
+                      const char *author,
+                      const char *isbn,
+                      time_t added_date)
+{
+    // ident 0 takes the next ID; an explicit one keeps the counter past it
+    if (ident <= 0)
     {
-        fprintf(stderr, "Book pointer is NULL\n");
-        syslog(LOG_ERR, "Book pointer is NULL\n");
-        return;
+        ident = id_allocator_next(&book_ids);
     }
-
-    book->ident = next_book_id++;
+    else if (ident < INT_MAX)
+    {
+        id_allocator_raise(&book_ids, ident + 1);
+    }
+    book->ident = ident;
+    // strncpy's zero padding keeps saved records free of stale heap bytes
     strncpy(book->title, title ? title : "", MAX_TITLE_LENGTH - 1);
     strncpy(book->author, author ? author : "", MAX_AUTHOR_LENGTH - 1);
     strncpy(book->isbn, isbn ? isbn : "", MAX_ISBN_LENGTH - 1);
@@ -32,7 +64,23 @@ void init_book(Book *book,
     book->isbn[MAX_ISBN_LENGTH - 1] = '\0';
 
     book->is_available = 1;
-    book->added_date = time(NULL);
+    book->added_date = added_date;
+    book->author_id = NO_AUTHOR_ID;
+}
+
+void init_book(Book *book,
+               const char *title,
+               const char *author,
+               const char *isbn)
+{
+    if (!book)
+    {
+        fprintf(stderr, "Book pointer is NULL\n");
+        syslog(LOG_ERR, "Book pointer is NULL\n");
+        return;
+    }
+
+    fill_book(book, 0, title, author, isbn, time(NULL));
     syslog(LOG_INFO,
            "Created book with ID: %d, Title: %s, Author: %s, ISBN: %s\n",
            book->ident,
@@ -108,37 +156,307 @@ void print_book(const Book *book)
            book->isbn);
 }
 
-int add_book_to_library(Library *library,
-                        const char *title,
-                        const char *author,
-                        const char *isbn)
+static void unindex_book(Library *library, const Book *book)
 {
-    if (!library || !title || !author || !isbn)
+    hash_index_remove(&library->book_index, (uint64_t)book->ident);
+    uint64_t isbn_key = normalize_isbn(book->isbn);
+    if (hash_index_get(&library->isbn_index, isbn_key) == book->ident)
     {
-        fprintf(stderr, "Invalid parameters for adding a book\n");
-        syslog(LOG_ERR, "Invalid parameters for adding a book\n");
-        return 0;
+        hash_index_remove(&library->isbn_index, isbn_key);
+    }
+    token_index_remove_document(&library->text_index, book->ident, book->title);
+    token_index_remove_document(
+        &library->text_index, book->ident, book->author);
+    author_dictionary_remove_book(
+        &library->authors, book->author_id, book->ident);
+}
+
+static int index_book(Library *library, Book *book, int slot, int parts)
+{
+    int indexed = 1;
+    if ((parts & BOOK_INDEX_ID) && hash_index_is_built(&library->book_index))
+    {
+        indexed = hash_index_put(
+            &library->book_index, (uint64_t)book->ident, slot);
+    }
+    uint64_t isbn_key = normalize_isbn(book->isbn);
+    if (indexed && (parts & BOOK_INDEX_ISBN) && isbn_key &&
+        hash_index_is_built(&library->isbn_index) &&
+        hash_index_get(&library->isbn_index, isbn_key) == HASH_INDEX_NOT_FOUND)
+    {
+        indexed = hash_index_put(&library->isbn_index, isbn_key, book->ident);
+    }
+    if (indexed && (parts & BOOK_INDEX_TEXT) &&
+        token_index_is_built(&library->text_index))
+    {
+        indexed = token_index_add_document(
+                      &library->text_index, book->ident, book->title) &&
+                  token_index_add_document(
+                      &library->text_index, book->ident, book->author);
+    }
+    if (indexed && (parts & BOOK_INDEX_AUTHORS) &&
+        author_dictionary_is_built(&library->authors))
+    {
+        indexed = author_dictionary_intern(
+                      &library->authors, book->author, &book->author_id) &&
+                  author_dictionary_add_book(
+                      &library->authors, book->author_id, book->ident);
     }
 
-    if (library->num_books >= library->capacity_books)
+    if (!indexed)
     {
-        int new_capacity = library->capacity_books * 2;
-        Book *new_books =
+        unindex_book(library, book);
+        fprintf(stderr, "Failed to index book with ID: %d\n", book->ident);
+        syslog(LOG_ERR, "Failed to index book with ID: %d\n", book->ident);
+    }
+    return indexed;
+}
+
+int count_books(const Library *library)
+{
+    return library ? library->num_books - library->num_free_books : 0;
+}
+
+static void compact_books_unlocked(Library *library)
+{
+    if (!library || library->num_free_books == 0)
+    {
+        return;
+    }
+
+    int live = 0;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        if (library->books[i].ident == 0)
+        {
+            continue;
+        }
+        if (i != live)
+        {
+            library->books[live] = library->books[i];
+            hash_index_put(&library->book_index,
+                           (uint64_t)library->books[live].ident,
+                           live);
+        }
+        live++;
+    }
+
+    memset(&library->books[live],
+           0,
+           (size_t)(library->num_books - live) * sizeof(Book));
+    syslog(LOG_INFO,
+           "Compacted books: %d slots reclaimed\n",
+           library->num_books - live);
+    library->num_books = live;
+    library->num_free_books = 0;
+    book_columns_refresh(library);
+}
+
+void compact_books(Library *library)
+{
+    library_lock_exclusive(library);
+    compact_books_unlocked(library);
+    library_unlock_exclusive(library);
+}
+
+// A tombstoned slot is zeroed, so it keeps ident 0 and is never available.
+// If the list of free slots cannot grow, the books are compacted instead,
+// which reclaims the slot at once.
+static void push_free_book_slot(Library *library, int slot)
+{
+    memset(&library->books[slot], 0, sizeof(Book));
+    book_columns_store(library, slot);
+    library->num_free_books++;
+    if (library->num_free_books > library->capacity_free_book_slots)
+    {
+        int capacity = library->capacity_free_book_slots > 0
+                           ? library->capacity_free_book_slots * 2
+                           : INITIAL_CAPACITY;
+        int *slots = (int *)realloc(library->free_book_slots,
+                                    (size_t)capacity * sizeof(int));
+        if (!slots)
+        {
+            fprintf(stderr, "Memory allocation failed for free book slots\n");
+            syslog(LOG_ERR, "Memory allocation failed for free book slots\n");
+            compact_books_unlocked(library);
+            return;
+        }
+        library->free_book_slots = slots;
+        library->capacity_free_book_slots = capacity;
+    }
+    library->free_book_slots[library->num_free_books - 1] = slot;
+}
+
+static int pop_free_book_slot(Library *library)
+{
+    if (library->num_free_books <= 0)
+    {
+        return -1;
+    }
+    return library->free_book_slots[--library->num_free_books];
+}
+
+static int resize_books(Library *library, int new_capacity)
+{
+    Book *new_books = NULL;
+    if (new_capacity >= 0 && library->books_mapped)
+    {
+        // Mapped snapshot records move to the heap on first growth
+        new_books = (Book *)malloc((size_t)new_capacity * sizeof(Book));
+        if (new_books)
+        {
+            memcpy(new_books,
+                   library->books,
+                   (size_t)library->num_books * sizeof(Book));
+            library->books_mapped = 0;
+        }
+    }
+    else if (new_capacity >= 0)
+    {
+        new_books =
             realloc(library->books, (size_t)new_capacity * sizeof(Book));
+    }
+    if (!new_books)
+    {
+        fprintf(stderr, "Memory allocation failed while resizing library\n");
+        syslog(LOG_ERR, "Memory allocation failed while resizing library\n");
+        return 0;
+    }
+
+    library->books = new_books;
+    library->capacity_books = new_capacity;
+    return book_columns_reserve(library, new_capacity);
+}
+
+// Growth on demand follows the library's growth policy
+static int reserve_book_slots(Library *library, int needed)
+{
+    if (needed <= library->capacity_books)
+    {
+        return 1;
+    }
+    return resize_books(library,
+                        growth_policy_next_capacity(&library->growth_policy,
+                                                    library->capacity_books,
+                                                    needed,
+                                                    sizeof(Book)));
+}
+
+static int reserve_books_unlocked(Library *library, int capacity)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Reserve Books Library pointer is NULL\n");
+        syslog(LOG_ERR, "Reserve Books Library pointer is NULL\n");
+        return 0;
+    }
+    if (capacity <= library->capacity_books)
+    {
+        return 1;
+    }
+    return resize_books(library,
+                        growth_policy_exact_capacity(
+                            &library->growth_policy, capacity, sizeof(Book)));
+}
 
-        if (!new_books)
+int reserve_books(Library *library, int capacity)
+{
+    library_lock_exclusive(library);
+    int result = reserve_books_unlocked(library, capacity);
+    library_unlock_exclusive(library);
+    return result;
+}
+
+// Stores a new book in a free slot or at the end and indexes it. Returns
+// the slot, or -1 when the book could not be added.
+static int place_book(Library *library,
+                      int ident,
+                      const char *title,
+                      const char *author,
+                      const char *isbn,
+                      time_t added_date)
+{
+    if (ident <= 0 && !(ident = id_allocator_next(&book_ids)))
+    {
+        fprintf(stderr, "Book IDs are exhausted\n");
+        syslog(LOG_ERR, "Book IDs are exhausted\n");
+        return -1;
+    }
+
+    int slot = pop_free_book_slot(library);
+    if (slot < 0)
+    {
+        if (!reserve_book_slots(library, library->num_books + 1))
         {
-            fprintf(stderr,
-                    "Memory allocation failed while resizing library\n");
-            return 0;
+            return -1;
         }
+        slot = library->num_books;
+    }
 
-        library->books = new_books;
-        library->capacity_books = new_capacity;
+    Book *book = &library->books[slot];
+    fill_book(book, ident, title, author, isbn, added_date);
+    int added = index_book(library, book, slot, BOOK_INDEX_ALL);
+    if (added && !track_book_added(library, book))
+    {
+        unindex_book(library, book);
+        added = 0;
+    }
+    if (!added)
+    {
+        if (slot < library->num_books)
+        {
+            push_free_book_slot(library, slot);
+        }
+        return -1;
+    }
+    book_columns_store(library, slot);
+    if (slot == library->num_books)
+    {
+        library->num_books++;
+    }
+    return slot;
+}
+
+static int add_book_to_library_unlocked(Library *library,
+                                        const char *title,
+                                        const char *author,
+                                        const char *isbn)
+{
+    if (!library || !title || !author || !isbn)
+    {
+        fprintf(stderr, "Invalid parameters for adding a book\n");
+        syslog(LOG_ERR, "Invalid parameters for adding a book\n");
+        return 0;
+    }
+
+    Book *duplicate = find_book_by_isbn(library, isbn);
+    if (duplicate && library->isbn_duplicate_policy == ISBN_DUPLICATE_MERGE)
+    {
+        syslog(LOG_INFO,
+               "Merged ISBN %s into existing book with ID: %d\n",
+               isbn,
+               duplicate->ident);
+        return 1;
+    }
+    if (duplicate)
+    {
+        fprintf(stderr, "Book with ISBN %s already exists\n", isbn);
+        syslog(LOG_ERR, "Book with ISBN %s already exists\n", isbn);
+        return 0;
     }
 
-    init_book(&library->books[library->num_books], title, author, isbn);
-    library->num_books++;
+    int slot = place_book(library, 0, title, author, isbn, time(NULL));
+    if (slot < 0)
+    {
+        return 0;
+    }
+    const Book *book = &library->books[slot];
+    syslog(LOG_INFO,
+           "Created book with ID: %d, Title: %s, Author: %s, ISBN: %s\n",
+           book->ident,
+           book->title,
+           book->author,
+           book->isbn);
     syslog(LOG_INFO,
            "Added book to library with Title: %s, Author: %s, ISBN: %s\n",
            title,
@@ -147,6 +465,181 @@ int add_book_to_library(Library *library,
     return 1;
 }
 
+int add_book_to_library(Library *library,
+                        const char *title,
+                        const char *author,
+                        const char *isbn)
+{
+    library_lock_exclusive(library);
+    int result = add_book_to_library_unlocked(library, title, author, isbn);
+    library_unlock_exclusive(library);
+    return result;
+}
+
+int find_book_slot(const Library *library, int ident)
+{
+    if (hash_index_is_built(&library->book_index))
+    {
+        return hash_index_get(&library->book_index, (uint64_t)ident);
+    }
+
+    // Libraries assembled without an index fall back to a linear scan
+    for (int i = 0; ident != 0 && i < library->num_books; i++)
+    {
+        if (library->books[i].ident == ident)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int rebuild_book_indexes(Library *library, int parts)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Library pointer is NULL\n");
+        syslog(LOG_ERR, "Library pointer is NULL\n");
+        return 0;
+    }
+
+    int ready = 1;
+    if (!(parts & BOOK_INDEX_ID))
+    {
+        // Left as the caller built it
+    }
+    else if (hash_index_is_built(&library->book_index))
+    {
+        hash_index_clear(&library->book_index);
+        ready = hash_index_reserve(&library->book_index, library->num_books);
+    }
+    else
+    {
+        ready = hash_index_init(&library->book_index, library->num_books);
+    }
+
+    if (!(parts & BOOK_INDEX_ISBN))
+    {
+        // Left as the caller built it
+    }
+    else if (hash_index_is_built(&library->isbn_index))
+    {
+        hash_index_clear(&library->isbn_index);
+        ready = hash_index_reserve(&library->isbn_index, library->num_books) &&
+                ready;
+    }
+    else
+    {
+        ready = hash_index_init(&library->isbn_index, library->num_books) &&
+                ready;
+    }
+
+    if (!(parts & BOOK_INDEX_TEXT))
+    {
+        // Left as the caller built it
+    }
+    else if (token_index_is_built(&library->text_index))
+    {
+        token_index_clear(&library->text_index);
+    }
+    else
+    {
+        ready = token_index_init(&library->text_index, library->num_books) &&
+                ready;
+    }
+
+    // Names already in the dictionary (e.g. loaded from a file) keep their
+    // IDs; only the per-author book lists are rebuilt.
+    if (!(parts & BOOK_INDEX_AUTHORS))
+    {
+        // Left as the caller built it
+    }
+    else if (author_dictionary_is_built(&library->authors))
+    {
+        author_dictionary_clear_books(&library->authors);
+    }
+    else
+    {
+        ready = author_dictionary_init(&library->authors, 0) && ready;
+    }
+
+    for (int i = 0; ready && i < library->num_books; i++)
+    {
+        if (library->books[i].ident != 0)
+        {
+            ready = index_book(library, &library->books[i], i, parts);
+        }
+    }
+    ready = ready && rebuild_book_availability(library);
+
+    if (!ready)
+    {
+        deinit_book_indexes(library);
+    }
+    return ready;
+}
+
+int rebuild_book_index(Library *library)
+{
+    return rebuild_book_indexes(library, BOOK_INDEX_ALL);
+}
+
+int rebuild_book_lookup_indexes(Library *library)
+{
+    return rebuild_book_indexes(library, BOOK_INDEX_ALL & ~BOOK_INDEX_TEXT);
+}
+
+int rebuild_book_id_index(Library *library)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Library pointer is NULL\n");
+        syslog(LOG_ERR, "Library pointer is NULL\n");
+        return 0;
+    }
+
+    int ready = 1;
+    if (hash_index_is_built(&library->book_index))
+    {
+        hash_index_clear(&library->book_index);
+        ready = hash_index_reserve(&library->book_index, library->num_books);
+    }
+    else
+    {
+        ready = hash_index_init(&library->book_index, library->num_books);
+    }
+    for (int i = 0; ready && i < library->num_books; i++)
+    {
+        if (library->books[i].ident != 0)
+        {
+            ready = hash_index_put(
+                &library->book_index, (uint64_t)library->books[i].ident, i);
+        }
+    }
+    ready = ready && rebuild_book_availability(library);
+
+    if (!ready)
+    {
+        hash_index_deinit(&library->book_index);
+        bitset_deinit(&library->available_books);
+    }
+    return ready;
+}
+
+void deinit_book_indexes(Library *library)
+{
+    if (!library)
+    {
+        return;
+    }
+    hash_index_deinit(&library->book_index);
+    hash_index_deinit(&library->isbn_index);
+    token_index_deinit(&library->text_index);
+    author_dictionary_deinit(&library->authors);
+    bitset_deinit(&library->available_books);
+    library->num_available_books = 0;
+}
+
 Book *find_book_by_id(Library *library, int ident)
 {
     if (!library)
@@ -156,18 +649,166 @@ Book *find_book_by_id(Library *library, int ident)
         return NULL;
     }
 
+    int slot = find_book_slot(library, ident);
+    if (slot < 0)
+    {
+        return NULL;
+    }
+    syslog(LOG_INFO, "Found book with ID: %d\n", ident);
+    return &library->books[slot];
+}
+
+static int find_isbn_slot(const Library *library, uint64_t isbn_key)
+{
+    if (!isbn_key)
+    {
+        return -1;
+    }
+
+    if (hash_index_is_built(&library->isbn_index))
+    {
+        int ident = hash_index_get(&library->isbn_index, isbn_key);
+        return ident == HASH_INDEX_NOT_FOUND ? -1
+                                             : find_book_slot(library, ident);
+    }
+
     for (int i = 0; i < library->num_books; i++)
     {
-        if (library->books[i].ident == ident)
+        if (library->books[i].ident != 0 &&
+            normalize_isbn(library->books[i].isbn) == isbn_key)
         {
-            syslog(LOG_INFO, "Found book with ID: %d\n", ident);
-            return &library->books[i];
+            return i;
         }
     }
-    return NULL;
+    return -1;
 }
 
-void remove_book_from_library(Library *library, int ident)
+Book *find_book_by_isbn(Library *library, const char *isbn)
+{
+    if (!library || !isbn)
+    {
+        fprintf(stderr, "Invalid parameters for finding a book by ISBN\n");
+        syslog(LOG_ERR, "Invalid parameters for finding a book by ISBN\n");
+        return NULL;
+    }
+
+    int slot = find_isbn_slot(library, normalize_isbn(isbn));
+    if (slot < 0)
+    {
+        return NULL;
+    }
+    syslog(LOG_INFO, "Found book with ID: %d\n", library->books[slot].ident);
+    return &library->books[slot];
+}
+
+static int add_books_bulk_unlocked(Library *library,
+                                   const BookRecord *records,
+                                   int count)
+{
+    if (!library || (!records && count > 0) || count < 0)
+    {
+        fprintf(stderr, "Invalid parameters for adding books in bulk\n");
+        syslog(LOG_ERR, "Invalid parameters for adding books in bulk\n");
+        return -1;
+    }
+
+    // Size every structure for the whole batch so the loop never regrows
+    int live = count_books(library);
+    int appended = count - library->num_free_books;
+    int ready = reserve_book_slots(
+        library, library->num_books + (appended > 0 ? appended : 0));
+    if (ready && hash_index_is_built(&library->book_index))
+    {
+        ready = hash_index_reserve(&library->book_index, live + count);
+    }
+    if (ready && hash_index_is_built(&library->isbn_index))
+    {
+        ready = hash_index_reserve(&library->isbn_index, live + count);
+    }
+    if (ready && bitset_is_built(&library->available_books))
+    {
+        ready = bitset_reserve(&library->available_books,
+                               id_allocator_peek(&book_ids) + count);
+    }
+    if (!ready)
+    {
+        return -1;
+    }
+
+    // One reservation covers every new ID of the batch; whatever rejected
+    // rows leave unused goes back at the end
+    IdBlock ids = {0, 0};
+    int fresh = 0;
+    for (int i = 0; i < count; i++)
+    {
+        fresh += records[i].ident == 0;
+    }
+
+    time_t added_date = time(NULL);
+    int added = 0;
+    int merged = 0;
+    int rejected = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const BookRecord *record = &records[i];
+        if (!record->title || !record->author || !record->isbn ||
+            record->ident < 0 ||
+            (record->ident > 0 && find_book_by_id(library, record->ident)))
+        {
+            rejected++;
+            continue;
+        }
+        if (find_isbn_slot(library, normalize_isbn(record->isbn)) >= 0)
+        {
+            if (library->isbn_duplicate_policy == ISBN_DUPLICATE_MERGE)
+            {
+                merged++;
+            }
+            else
+            {
+                rejected++;
+            }
+            continue;
+        }
+        // Explicit IDs earlier in the batch may have landed in the block
+        int ident = record->ident;
+        while (ident == 0 && (ident = id_block_take(&ids, &book_ids, fresh)) &&
+               find_book_slot(library, ident) >= 0)
+        {
+            ident = 0;
+        }
+        if (place_book(library,
+                       ident,
+                       record->title,
+                       record->author,
+                       record->isbn,
+                       record->added_date ? record->added_date
+                                          : added_date) < 0)
+        {
+            rejected++;
+            continue;
+        }
+        added++;
+    }
+    id_block_release(&ids, &book_ids);
+
+    syslog(LOG_INFO,
+           "Bulk added %d books (%d merged, %d rejected)\n",
+           added,
+           merged,
+           rejected);
+    return added;
+}
+
+int add_books_bulk(Library *library, const BookRecord *records, int count)
+{
+    library_lock_exclusive(library);
+    int result = add_books_bulk_unlocked(library, records, count);
+    library_unlock_exclusive(library);
+    return result;
+}
+
+static void remove_book_from_library_unlocked(Library *library, int ident)
 {
     if (!library || !library->books || library->num_books <= 0)
     {
@@ -176,31 +817,60 @@ void remove_book_from_library(Library *library, int ident)
         return;
     }
 
-    int found_index = -1;
-    for (int i = 0; i < library->num_books; i++)
+    if (library->removal_mode == REMOVAL_SHIFT)
     {
-        if (library->books[i].ident == ident)
-        {
-            found_index = i;
-            syslog(LOG_INFO, "Removing book with ID: %d\n", ident);
-            break;
-        }
+        // Shifting would invalidate the free-list left by tombstone mode
+        compact_books_unlocked(library);
     }
 
+    int found_index = find_book_slot(library, ident);
     if (found_index != -1 && found_index < library->num_books)
     {
+        syslog(LOG_INFO, "Removing book with ID: %d\n", ident);
+        track_book_removed(library, &library->books[found_index]);
+        unindex_book(library, &library->books[found_index]);
+
+        if (library->removal_mode == REMOVAL_TOMBSTONE)
+        {
+            push_free_book_slot(library, found_index);
+            if (library->compaction_threshold > 0 &&
+                (long long)library->num_free_books * 100 >=
+                    (long long)library->compaction_threshold *
+                        library->num_books)
+            {
+                compact_books_unlocked(library);
+            }
+            return;
+        }
+
+        int indexed = hash_index_is_built(&library->book_index);
+
         // Shift remaining elements
         for (int i = found_index; i < library->num_books - 1; i++)
         {
             library->books[i] = library->books[i + 1];
+            if (indexed)
+            {
+                hash_index_put(
+                    &library->book_index, (uint64_t)library->books[i].ident, i);
+            }
         }
 
+        book_columns_erase(library, found_index);
+
         // Clear last element
         memset(&library->books[library->num_books - 1], 0, sizeof(Book));
         library->num_books--;
     }
 }
 
+void remove_book_from_library(Library *library, int ident)
+{
+    library_lock_exclusive(library);
+    remove_book_from_library_unlocked(library, ident);
+    library_unlock_exclusive(library);
+}
+
 void list_all_books(const Library *library)
 {
     if (!library)
@@ -210,10 +880,272 @@ void list_all_books(const Library *library)
         return;
     }
 
-    printf("\nLibrary Books (%d):\n", library->num_books);
+    printf("\nLibrary Books (%d):\n", count_books(library));
     for (int i = 0; i < library->num_books; i++)
     {
-        print_book(&library->books[i]);
+        if (library->books[i].ident != 0)
+        {
+            print_book(&library->books[i]);
+        }
     }
     syslog(LOG_INFO, "Listed all books in library\n");
 }
+
+static int book_matches_query(const Book *book, const char *query)
+{
+    char wanted[MAX_TOKEN_LENGTH];
+    char token[MAX_TOKEN_LENGTH];
+    const char *query_cursor = query;
+    int num_terms = 0;
+
+    while (next_token(&query_cursor, wanted, sizeof(wanted)))
+    {
+        int found = 0;
+        const char *fields[] = {book->title, book->author};
+        for (size_t f = 0; f < 2 && !found; f++)
+        {
+            const char *cursor = fields[f];
+            while (!found && next_token(&cursor, token, sizeof(token)))
+            {
+                found = strcmp(token, wanted) == 0;
+            }
+        }
+        if (!found)
+        {
+            return 0;
+        }
+        num_terms++;
+    }
+    return num_terms > 0;
+}
+
+static Book *copy_books_by_id(const Library *library,
+                              const int *ids,
+                              int count,
+                              int *num_results)
+{
+    Book *results = (Book *)malloc((size_t)count * sizeof(Book));
+    if (!results)
+    {
+        fprintf(stderr, "Memory allocation failed for search results\n");
+        syslog(LOG_ERR, "Memory allocation failed for search results\n");
+        return NULL;
+    }
+
+    int found = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int slot = find_book_slot(library, ids[i]);
+        if (slot >= 0)
+        {
+            results[found++] = library->books[slot];
+        }
+    }
+    *num_results = found;
+    return results;
+}
+
+// Fallback scans run as a parallel_for. Each chunk gathers its matches at
+// the start of its own item range of the output, and the runs are then
+// closed up in chunk order, so results stay in slot order.
+typedef struct
+{
+    const Library *library;
+    const char *text;
+    void *out;
+    int *found;
+} BookScan;
+
+// Chunks span books; result_size is the size of one gathered result
+static int close_up_chunks(void *out,
+                           size_t result_size,
+                           const int *found,
+                           int num_books)
+{
+    int chunk_items = parallel_for_chunk_items(sizeof(Book));
+    int num_chunks = parallel_for_chunks(num_books, sizeof(Book));
+    int count = 0;
+    for (int chunk = 0; chunk < num_chunks; chunk++)
+    {
+        memmove((char *)out + (size_t)count * result_size,
+                (char *)out + (size_t)chunk * (size_t)chunk_items * result_size,
+                (size_t)found[chunk] * result_size);
+        count += found[chunk];
+    }
+    return count;
+}
+
+static void match_query_chunk(void *context, int chunk, int begin, int end)
+{
+    BookScan *scan = (BookScan *)context;
+    int *ids = (int *)scan->out + begin;
+    int found = 0;
+    for (int i = begin; i < end; i++)
+    {
+        if (book_matches_query(&scan->library->books[i], scan->text))
+        {
+            ids[found++] = scan->library->books[i].ident;
+        }
+    }
+    scan->found[chunk] = found;
+}
+
+// Collects the IDs of the books matching query into *ids; returns the
+// count, or -1 on allocation failure
+static int scan_books_for_query(const Library *library,
+                                const char *query,
+                                int **ids)
+{
+    int num_chunks = parallel_for_chunks(library->num_books, sizeof(Book));
+    *ids = (int *)malloc((size_t)(library->num_books + 1) * sizeof(int));
+    int *found = (int *)calloc((size_t)num_chunks + 1, sizeof(int));
+    if (!*ids || !found)
+    {
+        free(*ids);
+        free(found);
+        *ids = NULL;
+        return -1;
+    }
+    BookScan scan = {library, query, *ids, found};
+    parallel_for(library->num_books, sizeof(Book), match_query_chunk, &scan);
+    int count = close_up_chunks(*ids, sizeof(int), found, library->num_books);
+    free(found);
+    return count;
+}
+
+static void match_author_chunk(void *context, int chunk, int begin, int end)
+{
+    BookScan *scan = (BookScan *)context;
+    Book *books = (Book *)scan->out + begin;
+    int found = 0;
+    for (int i = begin; i < end; i++)
+    {
+        const Book *book = &scan->library->books[i];
+        if (book->ident != 0 && strcmp(book->author, scan->text) == 0)
+        {
+            books[found++] = *book;
+        }
+    }
+    scan->found[chunk] = found;
+}
+
+static Book *search_books_unlocked(const Library *library,
+                                   const char *query,
+                                   int *num_results)
+{
+    if (num_results)
+    {
+        *num_results = 0;
+    }
+    if (!library || !query || !num_results)
+    {
+        fprintf(stderr, "Invalid parameters for searching books\n");
+        syslog(LOG_ERR, "Invalid parameters for searching books\n");
+        return NULL;
+    }
+
+    int *ids = NULL;
+    int count = 0;
+    if (token_index_is_built(&library->text_index))
+    {
+        count = token_index_query(&library->text_index, query, &ids);
+    }
+    else
+    {
+        // Libraries assembled without an index fall back to a scan
+        count = scan_books_for_query(library, query, &ids);
+    }
+
+    if (count <= 0)
+    {
+        free(ids);
+        syslog(LOG_INFO, "Search for '%s' returned no books\n", query);
+        return NULL;
+    }
+
+    Book *results = copy_books_by_id(library, ids, count, num_results);
+    free(ids);
+    syslog(LOG_INFO,
+           "Search for '%s' returned %d books\n",
+           query,
+           *num_results);
+    return results;
+}
+
+Book *search_books(const Library *library, const char *query, int *num_results)
+{
+    library_lock_shared(library);
+    Book *books = search_books_unlocked(library, query, num_results);
+    library_unlock_shared(library);
+    return books;
+}
+
+static Book *find_books_by_author_unlocked(const Library *library,
+                                           const char *author,
+                                           int *num_results)
+{
+    if (num_results)
+    {
+        *num_results = 0;
+    }
+    if (!library || !author || !num_results)
+    {
+        fprintf(stderr, "Invalid parameters for finding books by author\n");
+        syslog(LOG_ERR, "Invalid parameters for finding books by author\n");
+        return NULL;
+    }
+
+    if (author_dictionary_is_built(&library->authors))
+    {
+        const PostingList *books = author_dictionary_books(
+            &library->authors,
+            author_dictionary_find(&library->authors, author));
+        if (!books || books->count == 0)
+        {
+            return NULL;
+        }
+        return copy_books_by_id(library, books->ids, books->count, num_results);
+    }
+
+    // Libraries assembled without a dictionary fall back to a scan
+    Book *results =
+        (Book *)malloc((size_t)(library->num_books + 1) * sizeof(Book));
+    if (!results)
+    {
+        fprintf(stderr, "Memory allocation failed for search results\n");
+        syslog(LOG_ERR, "Memory allocation failed for search results\n");
+        return NULL;
+    }
+    int *found = (int *)calloc(
+        (size_t)parallel_for_chunks(library->num_books, sizeof(Book)) + 1,
+        sizeof(int));
+    if (!found)
+    {
+        free(results);
+        fprintf(stderr, "Memory allocation failed for search results\n");
+        syslog(LOG_ERR, "Memory allocation failed for search results\n");
+        return NULL;
+    }
+    BookScan scan = {library, author, results, found};
+    parallel_for(library->num_books, sizeof(Book), match_author_chunk, &scan);
+    int count =
+        close_up_chunks(results, sizeof(Book), found, library->num_books);
+    free(found);
+    if (count == 0)
+    {
+        free(results);
+        return NULL;
+    }
+    *num_results = count;
+    return results;
+}
+
+Book *find_books_by_author(const Library *library,
+                           const char *author,
+                           int *num_results)
+{
+    library_lock_shared(library);
+    Book *books = find_books_by_author_unlocked(library, author, num_results);
+    library_unlock_shared(library);
+    return books;
+}
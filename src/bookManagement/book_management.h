@@ -3,8 +3,14 @@
 #define BOOK_MANAGEMENT_H
 
 #include "../include/structures.h"
+#include "../indexManagement/id_allocator.h"
 
 void reset_book_id(void);
+int get_next_book_id(void);
+void set_next_book_id(int ident);
+// The process-wide allocator behind new book IDs, for ingest workers that
+// reserve IdBlocks of their own
+IdAllocator *book_id_allocator(void);
 
 void init_book(Book *book,
                const char *title,
@@ -18,9 +24,53 @@ int add_book_to_library(Library *library,
                         const char *title,
                         const char *author,
                         const char *isbn);
+// Grows the book array to hold at least capacity books, rounded only for
+// huge pages; never shrinks it.
+int reserve_books(Library *library, int capacity);
+// Adds every record under a single capacity reservation and timestamp,
+// applying the ISBN duplicate policy per record. Records with an explicit
+// ID that is already taken are rejected. Returns the number of
+// books added, or -1 on invalid arguments or allocation failure.
+int add_books_bulk(Library *library, const BookRecord *records, int count);
+// The book indexes rebuild_book_indexes can rebuild one by one
+typedef enum
+{
+    BOOK_INDEX_ID = 1,
+    BOOK_INDEX_ISBN = 2,
+    BOOK_INDEX_TEXT = 4,
+    // The per-author book lists; interned names keep their IDs
+    BOOK_INDEX_AUTHORS = 8,
+    BOOK_INDEX_ALL = 15
+} BookIndexParts;
+
+int rebuild_book_index(Library *library);
+// Rebuilds the indexes named in parts and the availability bitmap, and
+// leaves the others as the caller built them (e.g. restored from a file)
+int rebuild_book_indexes(Library *library, int parts);
+// Rebuilds every index but text_index, which is left as the caller built
+// it (see load_library_shards)
+int rebuild_book_lookup_indexes(Library *library);
+// Builds only the ID index and availability bitmap; ISBN, text and author
+// lookups fall back to scans until rebuild_book_index is called
+int rebuild_book_id_index(Library *library);
+void deinit_book_indexes(Library *library);
+int count_books(const Library *library);
+void compact_books(Library *library);
 Book *find_book_by_id(Library *library, int identity);
+// Slot in library->books of the book with the given ID, or -1. Unlike
+// find_book_by_id it logs nothing, for callers resolving many IDs at once.
+int find_book_slot(const Library *library, int ident);
+Book *find_book_by_isbn(Library *library, const char *isbn);
 void remove_book_from_library(Library *library, int identity);
 void list_all_books(const Library *library);
+// Returns the books whose title/author contain every word of the query
+// (case-insensitive), ordered by ID. The array is owned by the caller and
+// must be released with free().
 Book *search_books(const Library *library, const char *query, int *num_results);
+// Returns the books whose author matches exactly, ordered by ID. The array
+// is owned by the caller and must be released with free().
+Book *find_books_by_author(const Library *library,
+                           const char *author,
+                           int *num_results);
 
 #endif
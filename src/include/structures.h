@@ -1,6 +1,9 @@
 #ifndef STRUCTURES_H
 #define STRUCTURES_H
 
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <syslog.h>
 #include <time.h>
 
@@ -12,33 +15,213 @@
 #define MAX_BORROWED_BOOKS 5
 #define INITIAL_CAPACITY 10
 
+// Open-addressing hash table mapping a non-zero key to an int value
+// (typically an array slot). A zeroed HashIndex is "not built".
+typedef struct
+{
+    uint64_t *keys;
+    int *values;
+    int capacity;
+    int count;
+    // keys and values point into a snapshot mapping: they are never freed,
+    // and a resize moves them to the heap
+    int borrowed;
+} HashIndex;
+
+// Growable bitset; a zeroed Bitset is "not built". Words are atomic so
+// that bits sharing a word can be flipped from different threads.
+typedef struct
+{
+    _Atomic uint64_t *words;
+    int num_words;
+} Bitset;
+
+// Sorted, duplicate-free list of document (book) IDs sharing one token
+typedef struct
+{
+    int *ids;
+    int count;
+    int capacity;
+} PostingList;
+
+// Interned author names. Author ID n (n >= 1) is names[n - 1]; ID 0 means
+// "no author". slots is an open-addressing table of IDs keyed by name.
+typedef struct
+{
+    char **names;
+    PostingList *books;
+    int num_names;
+    int capacity;
+    uint32_t *slots;
+    int num_slots;
+} AuthorDictionary;
+
+// Inverted index from case-folded word tokens to posting lists
+typedef struct
+{
+    char **tokens;
+    PostingList *postings;
+    int capacity;
+    int count;
+} TokenIndex;
+
 typedef struct
 {
     int ident;
     char title[MAX_TITLE_LENGTH];
     char author[MAX_AUTHOR_LENGTH];
     char isbn[MAX_ISBN_LENGTH];
-    int is_available;
+    // Claimed with compare-and-swap by borrow_book
+    atomic_int is_available;
     time_t added_date;
+    uint32_t author_id;
 } Book;
 
+// One row handed to add_books_bulk; the strings are only read during the call
+typedef struct
+{
+    const char *title;
+    const char *author;
+    const char *isbn;
+    // Zero hands out the next free ID / stamps the time of the call; set
+    // both when restoring exported books
+    int ident;
+    time_t added_date;
+} BookRecord;
+
 typedef struct
 {
     int ident;
     char name[MAX_NAME_LENGTH];
     char email[MAX_EMAIL_LENGTH];
-    int borrowed_books[MAX_BORROWED_BOOKS];
-    int num_borrowed_books;
+    // IDs of the books on loan, in any slots; 0 marks a free slot
+    atomic_int borrowed_books[MAX_BORROWED_BOOKS];
+    // Loans held or being taken; reserved before a slot is claimed
+    atomic_int num_borrowed_books;
 } Member;
 
+// One operation handed to borrow_books_batch/return_books_batch
+typedef struct
+{
+    int member_id;
+    int book_id;
+} LoanRequest;
+
+// Outcome of one operation in a borrow or return batch
+typedef enum
+{
+    LOAN_OK = 0,
+    LOAN_UNKNOWN_MEMBER,
+    LOAN_UNKNOWN_BOOK,
+    LOAN_BOOK_UNAVAILABLE,
+    LOAN_LIMIT_REACHED,
+    LOAN_NOT_BORROWED
+} LoanResult;
+
+// What add_book_to_library does when the ISBN is already catalogued
+typedef enum
+{
+    ISBN_DUPLICATE_REJECT = 0,
+    ISBN_DUPLICATE_MERGE
+} IsbnDuplicatePolicy;
+
+// Optional struct-of-arrays copy of the hot Book fields, slot-aligned with
+// Library.books, so scans touch a few bytes per book instead of a whole
+// record. A zeroed BookColumns means columnar mode is off.
+typedef struct
+{
+    int *idents;
+    // Flipped under a shared lock, so accessed with relaxed atomics
+    atomic_uchar *available;
+    time_t *added_dates;
+    int capacity;
+} BookColumns;
+
+// How remove_book_from_library/remove_member_from_library free a slot:
+// REMOVAL_SHIFT closes the gap (O(n), order preserved), REMOVAL_TOMBSTONE
+// blanks the slot (ident 0) and puts it on a free-list for reuse (O(1)).
+typedef enum
+{
+    REMOVAL_SHIFT = 0,
+    REMOVAL_TOMBSTONE
+} RemovalMode;
+
+#define DEFAULT_COMPACTION_THRESHOLD 25
+
+#define DEFAULT_GROWTH_FACTOR_PERCENT 200
+#define HUGE_PAGE_SIZE (2U * 1024U * 1024U)
+
+// How the book and member arrays grow when full. A zeroed policy doubles
+// without a cap.
+typedef struct
+{
+    // New capacity as a percentage of the old one; must exceed 100
+    int factor_percent;
+    // Most elements added by one growth step (0 = uncapped)
+    int max_step;
+    // Round allocations of HUGE_PAGE_SIZE or more up to whole huge pages
+    int round_to_huge_pages;
+} GrowthPolicy;
+
+typedef enum
+{
+    // Fixed-size records that map straight onto Book and Member
+    FILE_ENCODING_RECORDS = 0,
+    // Varint and length-prefixed records in compressed blocks; several
+    // times smaller, but always decoded on load
+    FILE_ENCODING_PACKED
+} FileEncoding;
+
+// Reader-writer lock for shared libraries (see library_lock.h)
+typedef struct LibraryLock LibraryLock;
+
 typedef struct
 {
     Book *books;
     int num_books;
     int capacity_books;
+    // Tombstoned book slots, most recently freed last; add_book reuses them
+    // before the array grows
+    int *free_book_slots;
+    int capacity_free_book_slots;
+    int num_free_books;
+    BookColumns book_columns;
+    HashIndex book_index;
+    TokenIndex text_index;
+    AuthorDictionary authors;
+    // Bit N set = book with ID N is on the shelf
+    Bitset available_books;
+    // Atomic because checkouts of different books update it concurrently
+    atomic_int num_available_books;
+    HashIndex isbn_index;
+    IsbnDuplicatePolicy isbn_duplicate_policy;
+    RemovalMode removal_mode;
+    // Percentage of tombstoned slots that triggers compaction (0 = manual)
+    int compaction_threshold;
+    GrowthPolicy growth_policy;
+    // How save_library_to_file lays out books and members
+    FileEncoding file_encoding;
+    // Read-only snapshot mapping that books and/or members may point into;
+    // such arrays are copied to the heap before they are first resized
+    void *snapshot;
+    size_t snapshot_size;
+    int books_mapped;
+    int members_mapped;
+    // Sequence number of the last journal record reflected in this library
+    uint64_t journal_lsn;
+    // Number of saves this library descends from; each save writes the
+    // next generation and stamps the indexes it persists with it
+    uint64_t generation;
     Member *members;
     int num_members;
     int capacity_members;
+    // Tombstoned member slots, kept like free_book_slots
+    int *free_member_slots;
+    int capacity_free_member_slots;
+    int num_free_members;
+    HashIndex member_index;
+    // NULL unless the library is shared between threads
+    LibraryLock *lock;
 } Library;
 
 #endif
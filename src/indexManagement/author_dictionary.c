@@ -0,0 +1,246 @@
+#include "author_dictionary.h"
+#include "token_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AUTHOR_DICTIONARY_MIN_SLOTS 64
+#define AUTHOR_DICTIONARY_MIN_NAMES 16
+
+static uint64_t hash_name(const char *name)
+{
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const unsigned char *c = (const unsigned char *)name; *c; c++)
+    {
+        hash ^= *c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static size_t find_slot(const AuthorDictionary *dictionary,
+                        const uint32_t *slots,
+                        int num_slots,
+                        const char *name)
+{
+    size_t mask = (size_t)num_slots - 1;
+    size_t slot = (size_t)(hash_name(name) & mask);
+    while (slots[slot] &&
+           strcmp(dictionary->names[slots[slot] - 1], name) != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+int author_dictionary_is_built(const AuthorDictionary *dictionary)
+{
+    return dictionary && dictionary->slots != NULL;
+}
+
+int author_dictionary_init(AuthorDictionary *dictionary, int expected_names)
+{
+    if (!dictionary)
+    {
+        fprintf(stderr, "Author Dictionary pointer is NULL\n");
+        syslog(LOG_ERR, "Author Dictionary pointer is NULL\n");
+        return 0;
+    }
+
+    memset(dictionary, 0, sizeof(AuthorDictionary));
+    int num_slots = AUTHOR_DICTIONARY_MIN_SLOTS;
+    while (num_slots < (1 << 30) && num_slots / 2 <= expected_names)
+    {
+        num_slots *= 2;
+    }
+    dictionary->slots = (uint32_t *)calloc((size_t)num_slots, sizeof(uint32_t));
+    if (!dictionary->slots)
+    {
+        fprintf(stderr, "Memory allocation failed for author dictionary\n");
+        syslog(LOG_ERR, "Memory allocation failed for author dictionary\n");
+        return 0;
+    }
+    dictionary->num_slots = num_slots;
+    return 1;
+}
+
+void author_dictionary_deinit(AuthorDictionary *dictionary)
+{
+    if (!author_dictionary_is_built(dictionary))
+    {
+        return;
+    }
+    for (int i = 0; i < dictionary->num_names; i++)
+    {
+        free(dictionary->names[i]);
+        free(dictionary->books[i].ids);
+    }
+    free(dictionary->names);
+    free(dictionary->books);
+    free(dictionary->slots);
+    memset(dictionary, 0, sizeof(AuthorDictionary));
+}
+
+void author_dictionary_clear_books(AuthorDictionary *dictionary)
+{
+    if (!author_dictionary_is_built(dictionary))
+    {
+        return;
+    }
+    for (int i = 0; i < dictionary->num_names; i++)
+    {
+        dictionary->books[i].count = 0;
+    }
+}
+
+static int grow_slots(AuthorDictionary *dictionary)
+{
+    int num_slots = dictionary->num_slots * 2;
+    uint32_t *slots = (uint32_t *)calloc((size_t)num_slots, sizeof(uint32_t));
+    if (!slots)
+    {
+        return 0;
+    }
+    for (int i = 0; i < dictionary->num_names; i++)
+    {
+        size_t slot =
+            find_slot(dictionary, slots, num_slots, dictionary->names[i]);
+        slots[slot] = (uint32_t)i + 1;
+    }
+    free(dictionary->slots);
+    dictionary->slots = slots;
+    dictionary->num_slots = num_slots;
+    return 1;
+}
+
+static int grow_names(AuthorDictionary *dictionary)
+{
+    int capacity = dictionary->capacity ? dictionary->capacity * 2
+                                        : AUTHOR_DICTIONARY_MIN_NAMES;
+    char **names =
+        realloc(dictionary->names, (size_t)capacity * sizeof(char *));
+    if (!names)
+    {
+        return 0;
+    }
+    dictionary->names = names;
+
+    PostingList *books =
+        realloc(dictionary->books, (size_t)capacity * sizeof(PostingList));
+    if (!books)
+    {
+        return 0;
+    }
+    dictionary->books = books;
+    dictionary->capacity = capacity;
+    return 1;
+}
+
+int author_dictionary_intern(AuthorDictionary *dictionary,
+                             const char *name,
+                             uint32_t *author_id)
+{
+    if (!author_dictionary_is_built(dictionary) || !name || !author_id)
+    {
+        return 0;
+    }
+    *author_id = NO_AUTHOR_ID;
+    if (name[0] == '\0')
+    {
+        return 1;
+    }
+
+    size_t slot = find_slot(
+        dictionary, dictionary->slots, dictionary->num_slots, name);
+    if (dictionary->slots[slot])
+    {
+        *author_id = dictionary->slots[slot];
+        return 1;
+    }
+
+    if ((dictionary->num_names + 1) * 2 > dictionary->num_slots)
+    {
+        if (!grow_slots(dictionary))
+        {
+            return 0;
+        }
+        slot = find_slot(
+            dictionary, dictionary->slots, dictionary->num_slots, name);
+    }
+    if (dictionary->num_names >= dictionary->capacity &&
+        !grow_names(dictionary))
+    {
+        return 0;
+    }
+
+    size_t length = strlen(name) + 1;
+    char *copy = (char *)malloc(length);
+    if (!copy)
+    {
+        return 0;
+    }
+    memcpy(copy, name, length);
+
+    int index = dictionary->num_names++;
+    dictionary->names[index] = copy;
+    memset(&dictionary->books[index], 0, sizeof(PostingList));
+    dictionary->slots[slot] = (uint32_t)dictionary->num_names;
+    *author_id = dictionary->slots[slot];
+    return 1;
+}
+
+uint32_t author_dictionary_find(const AuthorDictionary *dictionary,
+                                const char *name)
+{
+    if (!author_dictionary_is_built(dictionary) || !name || name[0] == '\0')
+    {
+        return NO_AUTHOR_ID;
+    }
+    size_t slot = find_slot(
+        dictionary, dictionary->slots, dictionary->num_slots, name);
+    return dictionary->slots[slot];
+}
+
+static int valid_id(const AuthorDictionary *dictionary, uint32_t author_id)
+{
+    return author_dictionary_is_built(dictionary) &&
+           author_id != NO_AUTHOR_ID &&
+           author_id <= (uint32_t)dictionary->num_names;
+}
+
+const char *author_dictionary_name(const AuthorDictionary *dictionary,
+                                   uint32_t author_id)
+{
+    return valid_id(dictionary, author_id)
+               ? dictionary->names[author_id - 1]
+               : NULL;
+}
+
+int author_dictionary_add_book(AuthorDictionary *dictionary,
+                               uint32_t author_id,
+                               int book_id)
+{
+    if (!valid_id(dictionary, author_id))
+    {
+        return author_id == NO_AUTHOR_ID;
+    }
+    return posting_list_insert(&dictionary->books[author_id - 1], book_id);
+}
+
+void author_dictionary_remove_book(AuthorDictionary *dictionary,
+                                   uint32_t author_id,
+                                   int book_id)
+{
+    if (valid_id(dictionary, author_id))
+    {
+        posting_list_remove(&dictionary->books[author_id - 1], book_id);
+    }
+}
+
+const PostingList *author_dictionary_books(const AuthorDictionary *dictionary,
+                                           uint32_t author_id)
+{
+    return valid_id(dictionary, author_id) ? &dictionary->books[author_id - 1]
+                                           : NULL;
+}
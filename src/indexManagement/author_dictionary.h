@@ -0,0 +1,32 @@
+// include/author_dictionary.h
+#ifndef AUTHOR_DICTIONARY_H
+#define AUTHOR_DICTIONARY_H
+
+#include "../include/structures.h"
+
+#define NO_AUTHOR_ID 0U
+
+int author_dictionary_init(AuthorDictionary *dictionary, int expected_names);
+void author_dictionary_deinit(AuthorDictionary *dictionary);
+int author_dictionary_is_built(const AuthorDictionary *dictionary);
+// Empties every author's book list but keeps the names, so IDs stay stable
+void author_dictionary_clear_books(AuthorDictionary *dictionary);
+// Stores the ID of name in *author_id, assigning the next free ID to names
+// seen for the first time. An empty name maps to NO_AUTHOR_ID.
+int author_dictionary_intern(AuthorDictionary *dictionary,
+                             const char *name,
+                             uint32_t *author_id);
+uint32_t author_dictionary_find(const AuthorDictionary *dictionary,
+                                const char *name);
+const char *author_dictionary_name(const AuthorDictionary *dictionary,
+                                   uint32_t author_id);
+int author_dictionary_add_book(AuthorDictionary *dictionary,
+                               uint32_t author_id,
+                               int book_id);
+void author_dictionary_remove_book(AuthorDictionary *dictionary,
+                                   uint32_t author_id,
+                                   int book_id);
+const PostingList *author_dictionary_books(const AuthorDictionary *dictionary,
+                                           uint32_t author_id);
+
+#endif
@@ -0,0 +1,226 @@
+#include "bitset.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BITS_PER_WORD 64
+
+static int popcount64(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    while (word)
+    {
+        word &= word - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+static int lowest_bit(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1U))
+    {
+        word >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// Mask of the bits at positions >= bit within a word
+static uint64_t mask_from(int bit)
+{
+    return ~0ULL << (unsigned int)bit;
+}
+
+// Reads are relaxed: a scan racing a flip sees the word before or after it
+static uint64_t word_at(const Bitset *bitset, int index)
+{
+    return atomic_load_explicit(&bitset->words[index], memory_order_relaxed);
+}
+
+int bitset_is_built(const Bitset *bitset)
+{
+    return bitset && bitset->words != NULL;
+}
+
+int bitset_init(Bitset *bitset, int num_bits)
+{
+    if (!bitset)
+    {
+        return 0;
+    }
+    memset(bitset, 0, sizeof(Bitset));
+    int num_words = num_bits / BITS_PER_WORD + 1;
+    bitset->words =
+        (_Atomic uint64_t *)calloc((size_t)num_words, sizeof(uint64_t));
+    if (!bitset->words)
+    {
+        fprintf(stderr, "Memory allocation failed for bitset\n");
+        syslog(LOG_ERR, "Memory allocation failed for bitset\n");
+        return 0;
+    }
+    bitset->num_words = num_words;
+    return 1;
+}
+
+void bitset_deinit(Bitset *bitset)
+{
+    if (!bitset)
+    {
+        return;
+    }
+    free((void *)bitset->words);
+    memset(bitset, 0, sizeof(Bitset));
+}
+
+int bitset_reserve(Bitset *bitset, int num_bits)
+{
+    if (!bitset_is_built(bitset))
+    {
+        return 0;
+    }
+
+    int needed = num_bits / BITS_PER_WORD + 1;
+    if (needed <= bitset->num_words)
+    {
+        return 1;
+    }
+
+    int num_words = bitset->num_words * 2;
+    if (num_words < needed)
+    {
+        num_words = needed;
+    }
+    _Atomic uint64_t *words = (_Atomic uint64_t *)realloc(
+        (void *)bitset->words, (size_t)num_words * sizeof(uint64_t));
+    if (!words)
+    {
+        fprintf(stderr, "Memory allocation failed while resizing bitset\n");
+        syslog(LOG_ERR, "Memory allocation failed while resizing bitset\n");
+        return 0;
+    }
+    memset((void *)&words[bitset->num_words],
+           0,
+           (size_t)(num_words - bitset->num_words) * sizeof(uint64_t));
+    bitset->words = words;
+    bitset->num_words = num_words;
+    return 1;
+}
+
+void bitset_clear_all(Bitset *bitset)
+{
+    if (bitset_is_built(bitset))
+    {
+        memset((void *)bitset->words,
+               0,
+               (size_t)bitset->num_words * sizeof(uint64_t));
+    }
+}
+
+void bitset_set(Bitset *bitset, int bit)
+{
+    if (bitset_is_built(bitset) && bit >= 0 &&
+        bit / BITS_PER_WORD < bitset->num_words)
+    {
+        atomic_fetch_or_explicit(&bitset->words[bit / BITS_PER_WORD],
+                                 1ULL << (bit % BITS_PER_WORD),
+                                 memory_order_relaxed);
+    }
+}
+
+void bitset_reset(Bitset *bitset, int bit)
+{
+    if (bitset_is_built(bitset) && bit >= 0 &&
+        bit / BITS_PER_WORD < bitset->num_words)
+    {
+        atomic_fetch_and_explicit(&bitset->words[bit / BITS_PER_WORD],
+                                  ~(1ULL << (bit % BITS_PER_WORD)),
+                                  memory_order_relaxed);
+    }
+}
+
+int bitset_test(const Bitset *bitset, int bit)
+{
+    if (!bitset_is_built(bitset) || bit < 0 ||
+        bit / BITS_PER_WORD >= bitset->num_words)
+    {
+        return 0;
+    }
+    return (int)((word_at(bitset, bit / BITS_PER_WORD) >>
+                  (bit % BITS_PER_WORD)) &
+                 1U);
+}
+
+static int clamp_range(const Bitset *bitset, int *from, int *until)
+{
+    int limit = bitset->num_words * BITS_PER_WORD;
+    if (*from < 0)
+    {
+        *from = 0;
+    }
+    if (*until > limit)
+    {
+        *until = limit;
+    }
+    return *from < *until;
+}
+
+int bitset_count_range(const Bitset *bitset, int from, int until)
+{
+    if (!bitset_is_built(bitset) || !clamp_range(bitset, &from, &until))
+    {
+        return 0;
+    }
+
+    int first_word = from / BITS_PER_WORD;
+    int last_word = (until - 1) / BITS_PER_WORD;
+    uint64_t head = mask_from(from % BITS_PER_WORD);
+    int tail_bits = until - last_word * BITS_PER_WORD;
+    uint64_t tail = tail_bits == BITS_PER_WORD ? ~0ULL : ~mask_from(tail_bits);
+
+    if (first_word == last_word)
+    {
+        return popcount64(word_at(bitset, first_word) & head & tail);
+    }
+
+    int count = popcount64(word_at(bitset, first_word) & head);
+    for (int i = first_word + 1; i < last_word; i++)
+    {
+        count += popcount64(word_at(bitset, i));
+    }
+    count += popcount64(word_at(bitset, last_word) & tail);
+    return count;
+}
+
+int bitset_find_next(const Bitset *bitset, int from, int until)
+{
+    if (!bitset_is_built(bitset) || !clamp_range(bitset, &from, &until))
+    {
+        return -1;
+    }
+
+    int word_index = from / BITS_PER_WORD;
+    uint64_t word =
+        word_at(bitset, word_index) & mask_from(from % BITS_PER_WORD);
+    while (!word)
+    {
+        word_index++;
+        if (word_index * BITS_PER_WORD >= until)
+        {
+            return -1;
+        }
+        word = word_at(bitset, word_index);
+    }
+
+    int bit = word_index * BITS_PER_WORD + lowest_bit(word);
+    return bit < until ? bit : -1;
+}
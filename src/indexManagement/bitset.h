@@ -0,0 +1,18 @@
+// include/bitset.h
+#ifndef BITSET_H
+#define BITSET_H
+
+#include "../include/structures.h"
+
+int bitset_init(Bitset *bitset, int num_bits);
+void bitset_deinit(Bitset *bitset);
+int bitset_is_built(const Bitset *bitset);
+int bitset_reserve(Bitset *bitset, int num_bits);
+void bitset_clear_all(Bitset *bitset);
+void bitset_set(Bitset *bitset, int bit);
+void bitset_reset(Bitset *bitset, int bit);
+int bitset_test(const Bitset *bitset, int bit);
+int bitset_count_range(const Bitset *bitset, int from, int until);
+int bitset_find_next(const Bitset *bitset, int from, int until);
+
+#endif
@@ -0,0 +1,214 @@
+#include "block_compress.h"
+#include <stdint.h>
+#include <string.h>
+
+#define MIN_MATCH 4
+#define HASH_BITS 12
+#define MAX_OFFSET 65535
+
+static uint32_t read_u32(const unsigned char *in)
+{
+    uint32_t value = 0;
+    memcpy(&value, in, sizeof(value));
+    return value;
+}
+
+static size_t hash_position(const unsigned char *in)
+{
+    return (size_t)((read_u32(in) * 2654435761U) >> (32 - HASH_BITS));
+}
+
+// Writes the 255-continued remainder of a length whose nibble was 15
+static int put_length(unsigned char **out,
+                      const unsigned char *end,
+                      size_t length)
+{
+    while (length >= 255)
+    {
+        if (*out >= end)
+        {
+            return 0;
+        }
+        *(*out)++ = 255;
+        length -= 255;
+    }
+    if (*out >= end)
+    {
+        return 0;
+    }
+    *(*out)++ = (unsigned char)length;
+    return 1;
+}
+
+static int put_sequence(unsigned char **out,
+                        const unsigned char *end,
+                        const unsigned char *literals,
+                        size_t num_literals,
+                        size_t offset,
+                        size_t match_length)
+{
+    if (*out >= end)
+    {
+        return 0;
+    }
+    unsigned char *token = (*out)++;
+    size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+    *token = (unsigned char)(((num_literals < 15 ? num_literals : 15) << 4) |
+                             (match_code < 15 ? match_code : 15));
+
+    if (num_literals >= 15 && !put_length(out, end, num_literals - 15))
+    {
+        return 0;
+    }
+    if ((size_t)(end - *out) < num_literals)
+    {
+        return 0;
+    }
+    memcpy(*out, literals, num_literals);
+    *out += num_literals;
+
+    if (match_length == 0)
+    {
+        return 1;
+    }
+    if (end - *out < 2)
+    {
+        return 0;
+    }
+    *(*out)++ = (unsigned char)(offset & 0xFFU);
+    *(*out)++ = (unsigned char)(offset >> 8);
+    return match_code < 15 || put_length(out, end, match_code - 15);
+}
+
+size_t block_compress(const unsigned char *input,
+                      size_t length,
+                      unsigned char *output,
+                      size_t capacity)
+{
+    if (!input || !output || length > BLOCK_COMPRESS_MAX_INPUT)
+    {
+        return 0;
+    }
+
+    uint32_t table[1U << HASH_BITS];
+    memset(table, 0, sizeof(table));
+    unsigned char *out = output;
+    const unsigned char *end = output + capacity;
+    size_t anchor = 0;
+    size_t position = 0;
+
+    while (length >= MIN_MATCH && position <= length - MIN_MATCH)
+    {
+        size_t slot = hash_position(input + position);
+        size_t candidate = table[slot];
+        table[slot] = (uint32_t)position;
+        if (candidate >= position || position - candidate > MAX_OFFSET ||
+            read_u32(input + candidate) != read_u32(input + position))
+        {
+            position++;
+            continue;
+        }
+
+        size_t match_length = MIN_MATCH;
+        while (position + match_length < length &&
+               input[candidate + match_length] ==
+                   input[position + match_length])
+        {
+            match_length++;
+        }
+        if (!put_sequence(&out,
+                          end,
+                          input + anchor,
+                          position - anchor,
+                          position - candidate,
+                          match_length))
+        {
+            return 0;
+        }
+        position += match_length;
+        anchor = position;
+    }
+
+    if (!put_sequence(&out, end, input + anchor, length - anchor, 0, 0))
+    {
+        return 0;
+    }
+    return (size_t)(out - output);
+}
+
+static int get_length(const unsigned char **in,
+                      const unsigned char *end,
+                      size_t *length)
+{
+    unsigned char byte = 255;
+    while (byte == 255)
+    {
+        if (*in >= end)
+        {
+            return 0;
+        }
+        byte = *(*in)++;
+        *length += byte;
+    }
+    return 1;
+}
+
+int block_decompress(const unsigned char *input,
+                     size_t length,
+                     unsigned char *output,
+                     size_t output_length)
+{
+    if (!input || !output)
+    {
+        return 0;
+    }
+
+    const unsigned char *in = input;
+    const unsigned char *in_end = input + length;
+    size_t written = 0;
+    while (in < in_end)
+    {
+        unsigned char token = *in++;
+        size_t num_literals = (size_t)(token >> 4);
+        if (num_literals == 15 && !get_length(&in, in_end, &num_literals))
+        {
+            return 0;
+        }
+        if ((size_t)(in_end - in) < num_literals ||
+            output_length - written < num_literals)
+        {
+            return 0;
+        }
+        memcpy(output + written, in, num_literals);
+        in += num_literals;
+        written += num_literals;
+        if (in == in_end)
+        {
+            break;
+        }
+
+        if (in_end - in < 2)
+        {
+            return 0;
+        }
+        size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+        in += 2;
+        size_t match_length = (size_t)(token & 0x0FU);
+        if (match_length == 15 && !get_length(&in, in_end, &match_length))
+        {
+            return 0;
+        }
+        match_length += MIN_MATCH;
+        if (offset == 0 || offset > written ||
+            output_length - written < match_length)
+        {
+            return 0;
+        }
+        // Byte by byte: a match may overlap the bytes it produces
+        for (size_t i = 0; i < match_length; i++, written++)
+        {
+            output[written] = output[written - offset];
+        }
+    }
+    return written == output_length;
+}
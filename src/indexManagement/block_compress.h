@@ -0,0 +1,26 @@
+// include/block_compress.h
+#ifndef BLOCK_COMPRESS_H
+#define BLOCK_COMPRESS_H
+
+#include <stddef.h>
+
+// Byte-oriented LZ77 in the style of LZ4: each sequence is a token (high
+// nibble literal count, low nibble match length - 4, 15 meaning "more
+// bytes follow"), the literals, then a u16 little-endian match offset. The
+// final sequence carries literals only. Fast to decode and good at the
+// repeated authors and prefixes of a catalogue; blocks up to 64 KiB.
+#define BLOCK_COMPRESS_MAX_INPUT 65536
+
+// Returns the compressed size, or 0 if the result would not fit in
+// capacity (store the block uncompressed then)
+size_t block_compress(const unsigned char *input,
+                      size_t length,
+                      unsigned char *output,
+                      size_t capacity);
+// Returns 1 if input decodes to exactly output_length bytes
+int block_decompress(const unsigned char *input,
+                     size_t length,
+                     unsigned char *output,
+                     size_t output_length);
+
+#endif
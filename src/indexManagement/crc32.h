@@ -0,0 +1,12 @@
+// include/crc32.h
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3, as used by zlib). Start with crc = 0 and feed the
+// previous result back in to checksum data in pieces.
+uint32_t crc32_update(uint32_t crc, const void *data, size_t length);
+
+#endif
@@ -0,0 +1,61 @@
+#include "growth_policy.h"
+#include <limits.h>
+
+int growth_policy_is_valid(const GrowthPolicy *policy)
+{
+    return policy && policy->factor_percent > 100 && policy->max_step >= 0;
+}
+
+static int round_capacity(const GrowthPolicy *policy,
+                          long long capacity,
+                          size_t element_size)
+{
+    long long bytes = capacity * (long long)element_size;
+    if (policy && policy->round_to_huge_pages && bytes >= HUGE_PAGE_SIZE)
+    {
+        long long pages = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE;
+        capacity = pages * HUGE_PAGE_SIZE / (long long)element_size;
+    }
+    return capacity > INT_MAX ? -1 : (int)capacity;
+}
+
+int growth_policy_next_capacity(const GrowthPolicy *policy,
+                                int current,
+                                int needed,
+                                size_t element_size)
+{
+    if (needed < 0 || element_size == 0)
+    {
+        return -1;
+    }
+
+    int factor = policy && policy->factor_percent > 100
+                     ? policy->factor_percent
+                     : DEFAULT_GROWTH_FACTOR_PERCENT;
+    long long grown = (long long)current * factor / 100;
+    if (grown <= current)
+    {
+        grown = (long long)current + 1;
+    }
+    if (policy && policy->max_step > 0 &&
+        grown - current > policy->max_step)
+    {
+        grown = (long long)current + policy->max_step;
+    }
+    if (grown < needed)
+    {
+        grown = needed;
+    }
+    return round_capacity(policy, grown, element_size);
+}
+
+int growth_policy_exact_capacity(const GrowthPolicy *policy,
+                                 int needed,
+                                 size_t element_size)
+{
+    if (needed < 0 || element_size == 0)
+    {
+        return -1;
+    }
+    return round_capacity(policy, needed, element_size);
+}
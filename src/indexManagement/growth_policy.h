@@ -0,0 +1,21 @@
+// include/growth_policy.h
+#ifndef GROWTH_POLICY_H
+#define GROWTH_POLICY_H
+
+#include <stddef.h>
+
+#include "../include/structures.h"
+
+int growth_policy_is_valid(const GrowthPolicy *policy);
+// Capacity to grow to from current so that at least needed elements fit.
+// Returns -1 if the result does not fit in an int.
+int growth_policy_next_capacity(const GrowthPolicy *policy,
+                                int current,
+                                int needed,
+                                size_t element_size);
+// Capacity for exactly needed elements, after huge page rounding
+int growth_policy_exact_capacity(const GrowthPolicy *policy,
+                                 int needed,
+                                 size_t element_size);
+
+#endif
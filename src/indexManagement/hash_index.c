@@ -0,0 +1,255 @@
+#include "hash_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tables are kept at most 70% full so linear probe chains stay short.
+#define HASH_INDEX_MIN_CAPACITY 16
+#define HASH_INDEX_LOAD_NUMERATOR 7
+#define HASH_INDEX_LOAD_DENOMINATOR 10
+
+static uint64_t hash_key(uint64_t key)
+{
+    // splitmix64 finalizer: sequential IDs spread evenly over the table
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+static int capacity_for(int expected_entries)
+{
+    long long needed = (long long)expected_entries *
+                       HASH_INDEX_LOAD_DENOMINATOR / HASH_INDEX_LOAD_NUMERATOR;
+    long long capacity = HASH_INDEX_MIN_CAPACITY;
+    while (capacity <= needed)
+    {
+        capacity *= 2;
+    }
+    return capacity > (1LL << 30) ? -1 : (int)capacity;
+}
+
+static size_t slot_of(const HashIndex *index, uint64_t key)
+{
+    return (size_t)(hash_key(key) & (uint64_t)(index->capacity - 1));
+}
+
+static int allocate_table(HashIndex *index, int capacity)
+{
+    index->keys = (uint64_t *)calloc((size_t)capacity, sizeof(uint64_t));
+    index->values = (int *)malloc((size_t)capacity * sizeof(int));
+    if (!index->keys || !index->values)
+    {
+        free(index->keys);
+        free(index->values);
+        index->keys = NULL;
+        index->values = NULL;
+        return 0;
+    }
+    index->capacity = capacity;
+    index->count = 0;
+    return 1;
+}
+
+int hash_index_init(HashIndex *index, int expected_entries)
+{
+    if (!index)
+    {
+        fprintf(stderr, "Hash Index pointer is NULL\n");
+        syslog(LOG_ERR, "Hash Index pointer is NULL\n");
+        return 0;
+    }
+
+    memset(index, 0, sizeof(HashIndex));
+    int capacity = capacity_for(expected_entries);
+    if (capacity < 0 || !allocate_table(index, capacity))
+    {
+        fprintf(stderr, "Memory allocation failed for hash index\n");
+        syslog(LOG_ERR, "Memory allocation failed for hash index\n");
+        return 0;
+    }
+    return 1;
+}
+
+void hash_index_deinit(HashIndex *index)
+{
+    if (!index)
+    {
+        return;
+    }
+    if (!index->borrowed)
+    {
+        free(index->keys);
+        free(index->values);
+    }
+    memset(index, 0, sizeof(HashIndex));
+}
+
+int hash_index_is_built(const HashIndex *index)
+{
+    return index && index->keys != NULL;
+}
+
+void hash_index_clear(HashIndex *index)
+{
+    if (!hash_index_is_built(index))
+    {
+        return;
+    }
+    memset(index->keys, 0, (size_t)index->capacity * sizeof(uint64_t));
+    index->count = 0;
+}
+
+static void insert_unchecked(HashIndex *index, uint64_t key, int value)
+{
+    size_t mask = (size_t)index->capacity - 1;
+    size_t slot = slot_of(index, key);
+    while (index->keys[slot] != 0 && index->keys[slot] != key)
+    {
+        slot = (slot + 1) & mask;
+    }
+    if (index->keys[slot] == 0)
+    {
+        index->keys[slot] = key;
+        index->count++;
+    }
+    index->values[slot] = value;
+}
+
+int hash_index_reserve(HashIndex *index, int expected_entries)
+{
+    if (!index)
+    {
+        return 0;
+    }
+
+    int capacity = capacity_for(expected_entries);
+    if (capacity < 0)
+    {
+        return 0;
+    }
+    if (capacity <= index->capacity)
+    {
+        return 1;
+    }
+
+    HashIndex grown = {0};
+    if (!allocate_table(&grown, capacity))
+    {
+        fprintf(stderr, "Memory allocation failed while resizing index\n");
+        syslog(LOG_ERR, "Memory allocation failed while resizing index\n");
+        return 0;
+    }
+
+    for (int i = 0; i < index->capacity; i++)
+    {
+        if (index->keys[i] != 0)
+        {
+            insert_unchecked(&grown, index->keys[i], index->values[i]);
+        }
+    }
+
+    if (!index->borrowed)
+    {
+        free(index->keys);
+        free(index->values);
+    }
+    *index = grown;
+    return 1;
+}
+
+int hash_index_put(HashIndex *index, uint64_t key, int value)
+{
+    if (!hash_index_is_built(index) || key == 0)
+    {
+        return 0;
+    }
+
+    if (!hash_index_reserve(index, index->count + 1))
+    {
+        return 0;
+    }
+
+    insert_unchecked(index, key, value);
+    return 1;
+}
+
+int hash_index_get(const HashIndex *index, uint64_t key)
+{
+    if (!hash_index_is_built(index) || key == 0)
+    {
+        return HASH_INDEX_NOT_FOUND;
+    }
+
+    size_t mask = (size_t)index->capacity - 1;
+    size_t slot = slot_of(index, key);
+    while (index->keys[slot] != 0)
+    {
+        if (index->keys[slot] == key)
+        {
+            return index->values[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return HASH_INDEX_NOT_FOUND;
+}
+
+int hash_index_remove(HashIndex *index, uint64_t key)
+{
+    if (!hash_index_is_built(index) || key == 0)
+    {
+        return 0;
+    }
+
+    size_t mask = (size_t)index->capacity - 1;
+    size_t slot = slot_of(index, key);
+    while (index->keys[slot] != key)
+    {
+        if (index->keys[slot] == 0)
+        {
+            return 0;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+    while (index->keys[next] != 0)
+    {
+        size_t home = slot_of(index, index->keys[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            index->keys[hole] = index->keys[next];
+            index->values[hole] = index->values[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    index->keys[hole] = 0;
+    index->count--;
+    return 1;
+}
+
+int hash_index_attach(HashIndex *index,
+                      uint64_t *keys,
+                      int *values,
+                      int capacity,
+                      int count)
+{
+    if (!index || !keys || !values || capacity < HASH_INDEX_MIN_CAPACITY ||
+        (capacity & (capacity - 1)) != 0 || count < 0 || count >= capacity)
+    {
+        fprintf(stderr, "Hash index table is malformed\n");
+        syslog(LOG_ERR, "Hash index table is malformed\n");
+        return 0;
+    }
+    index->keys = keys;
+    index->values = values;
+    index->capacity = capacity;
+    index->count = count;
+    index->borrowed = 1;
+    return 1;
+}
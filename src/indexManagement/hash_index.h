@@ -0,0 +1,26 @@
+// include/hash_index.h
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include "../include/structures.h"
+
+#define HASH_INDEX_NOT_FOUND (-1)
+
+int hash_index_init(HashIndex *index, int expected_entries);
+void hash_index_deinit(HashIndex *index);
+int hash_index_is_built(const HashIndex *index);
+void hash_index_clear(HashIndex *index);
+int hash_index_reserve(HashIndex *index, int expected_entries);
+int hash_index_put(HashIndex *index, uint64_t key, int value);
+int hash_index_get(const HashIndex *index, uint64_t key);
+int hash_index_remove(HashIndex *index, uint64_t key);
+// Serves the index from keys and values as laid out by a saved table
+// (capacity a power of two, fewer than capacity keys set) without copying
+// them; the arrays must outlive the index or its first resize
+int hash_index_attach(HashIndex *index,
+                      uint64_t *keys,
+                      int *values,
+                      int capacity,
+                      int count);
+
+#endif
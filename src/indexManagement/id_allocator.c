@@ -0,0 +1,82 @@
+#include "id_allocator.h"
+#include <limits.h>
+
+int id_allocator_next(IdAllocator *allocator)
+{
+    IdBlock block = {0, 0};
+    return id_allocator_reserve(allocator, 1, &block);
+}
+
+int id_allocator_reserve(IdAllocator *allocator, int count, IdBlock *block)
+{
+    if (!allocator || !block || count <= 0)
+    {
+        return 0;
+    }
+    // A compare-and-swap loop rather than fetch_add, so that an exhausted
+    // allocator stays put instead of wrapping
+    int next = atomic_load(&allocator->next);
+    do
+    {
+        if (next <= 0 || next > INT_MAX - count)
+        {
+            return 0;
+        }
+    } while (!atomic_compare_exchange_weak(
+        &allocator->next, &next, next + count));
+    block->next = next;
+    block->end = next + count;
+    return next;
+}
+
+int id_allocator_peek(IdAllocator *allocator)
+{
+    return allocator ? atomic_load(&allocator->next) : 0;
+}
+
+void id_allocator_reset(IdAllocator *allocator, int next)
+{
+    if (allocator && next > 0)
+    {
+        atomic_store(&allocator->next, next);
+    }
+}
+
+void id_allocator_raise(IdAllocator *allocator, int next)
+{
+    if (!allocator)
+    {
+        return;
+    }
+    int current = atomic_load(&allocator->next);
+    while (current < next &&
+           !atomic_compare_exchange_weak(&allocator->next, &current, next))
+    {
+        // current now holds the competing value; retry if still behind
+    }
+}
+
+int id_block_take(IdBlock *block, IdAllocator *allocator, int block_size)
+{
+    if (!block)
+    {
+        return 0;
+    }
+    if (block->next >= block->end &&
+        !id_allocator_reserve(allocator, block_size, block))
+    {
+        return 0;
+    }
+    return block->next++;
+}
+
+void id_block_release(IdBlock *block, IdAllocator *allocator)
+{
+    if (!block || !allocator || block->next >= block->end)
+    {
+        return;
+    }
+    int end = block->end;
+    atomic_compare_exchange_strong(&allocator->next, &end, block->next);
+    block->next = block->end;
+}
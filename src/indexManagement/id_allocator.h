@@ -0,0 +1,40 @@
+// include/id_allocator.h
+#ifndef ID_ALLOCATOR_H
+#define ID_ALLOCATOR_H
+
+#include <stdatomic.h>
+
+// Hands out positive int IDs in increasing order. Every operation is a
+// single atomic read-modify-write, so any number of threads may share one
+// allocator. Define with ID_ALLOCATOR_INIT, which starts at ID 1.
+typedef struct
+{
+    atomic_int next;
+} IdAllocator;
+
+#define ID_ALLOCATOR_INIT {1}
+
+// A range [next, end) reserved for one worker, which then takes IDs from
+// it without touching the shared allocator. A zeroed IdBlock is empty.
+typedef struct
+{
+    int next;
+    int end;
+} IdBlock;
+
+// Both return 0 once the int range is exhausted
+int id_allocator_next(IdAllocator *allocator);
+int id_allocator_reserve(IdAllocator *allocator, int count, IdBlock *block);
+int id_allocator_peek(IdAllocator *allocator);
+// Moves the allocator to next, even backwards (tests, journal replay)
+void id_allocator_reset(IdAllocator *allocator, int next);
+// Moves the allocator forward to next if it is behind, e.g. to a saved
+// high-water mark or past an ID assigned by hand
+void id_allocator_raise(IdAllocator *allocator, int next);
+
+// Next ID of the block, refilling it with block_size IDs when it runs out
+int id_block_take(IdBlock *block, IdAllocator *allocator, int block_size);
+// Gives the unused tail back if nothing was reserved after it
+void id_block_release(IdBlock *block, IdAllocator *allocator);
+
+#endif
@@ -0,0 +1,87 @@
+#include "isbn.h"
+#include <stddef.h>
+
+#define ISBN10_LENGTH 10
+#define ISBN13_LENGTH 13
+
+static uint64_t isbn13_from_digits(const int *digits)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < ISBN13_LENGTH; i++)
+    {
+        value = value * 10U + (uint64_t)digits[i];
+    }
+    return value;
+}
+
+static int isbn13_check_digit(const int *digits)
+{
+    int sum = 0;
+    for (int i = 0; i < ISBN13_LENGTH - 1; i++)
+    {
+        sum += digits[i] * ((i % 2) ? 3 : 1);
+    }
+    return (10 - sum % 10) % 10;
+}
+
+uint64_t normalize_isbn(const char *isbn)
+{
+    if (!isbn)
+    {
+        return 0;
+    }
+
+    int digits[ISBN13_LENGTH];
+    int length = 0;
+    for (const char *c = isbn; *c; c++)
+    {
+        if (*c == '-' || *c == ' ')
+        {
+            continue;
+        }
+        if (length >= ISBN13_LENGTH)
+        {
+            return 0;
+        }
+        if (*c >= '0' && *c <= '9')
+        {
+            digits[length++] = *c - '0';
+        }
+        else if ((*c == 'X' || *c == 'x') && length == ISBN10_LENGTH - 1)
+        {
+            digits[length++] = 10;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    if (length == ISBN10_LENGTH)
+    {
+        int sum = 0;
+        for (int i = 0; i < ISBN10_LENGTH; i++)
+        {
+            sum += digits[i] * (ISBN10_LENGTH - i);
+        }
+        if (sum % 11 != 0)
+        {
+            return 0;
+        }
+
+        int converted[ISBN13_LENGTH] = {9, 7, 8};
+        for (int i = 0; i < ISBN10_LENGTH - 1; i++)
+        {
+            converted[i + 3] = digits[i];
+        }
+        converted[ISBN13_LENGTH - 1] = isbn13_check_digit(converted);
+        return isbn13_from_digits(converted);
+    }
+
+    if (length == ISBN13_LENGTH &&
+        isbn13_check_digit(digits) == digits[ISBN13_LENGTH - 1])
+    {
+        return isbn13_from_digits(digits);
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+// include/isbn.h
+#ifndef ISBN_H
+#define ISBN_H
+
+#include <stdint.h>
+
+// Returns the ISBN-13 value of an ISBN-10/13 string (hyphens and spaces
+// ignored, ISBN-10 converted to its 978 form) or 0 when the string is not
+// a well-formed ISBN with a valid check digit.
+uint64_t normalize_isbn(const char *isbn);
+
+#endif
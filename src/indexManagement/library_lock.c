@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "library_lock.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Exclusive holds a thread tracks without allocating
+#define INLINE_HELD_LOCKS 8
+
+struct LibraryLock
+{
+    pthread_rwlock_t structure;
+};
+
+// The locks this thread holds exclusively, each with how many times over
+typedef struct
+{
+    const LibraryLock *lock;
+    int depth;
+} HeldLock;
+
+static _Thread_local HeldLock inline_held[INLINE_HELD_LOCKS];
+// Replaces inline_held while more locks are held than it fits
+static _Thread_local HeldLock *spilled_held;
+static _Thread_local int spilled_capacity;
+static _Thread_local int num_held;
+
+static HeldLock *held_locks(void)
+{
+    return spilled_held ? spilled_held : inline_held;
+}
+
+static HeldLock *find_held(const LibraryLock *lock)
+{
+    HeldLock *held = held_locks();
+    for (int i = 0; i < num_held; i++)
+    {
+        if (held[i].lock == lock)
+        {
+            return &held[i];
+        }
+    }
+    return NULL;
+}
+
+// Makes room to record one more hold. A hold that went unrecorded could
+// not be taken again without deadlocking, so running out of memory here
+// stops the process rather than handing one out.
+static void reserve_held(void)
+{
+    int capacity = spilled_held ? spilled_capacity : INLINE_HELD_LOCKS;
+    if (num_held < capacity)
+    {
+        return;
+    }
+    HeldLock *grown =
+        (HeldLock *)malloc((size_t)capacity * 2 * sizeof(HeldLock));
+    if (!grown)
+    {
+        fprintf(stderr, "Memory allocation failed for held library locks\n");
+        syslog(LOG_ERR, "Memory allocation failed for held library locks\n");
+        abort();
+    }
+    memcpy(grown, held_locks(), (size_t)num_held * sizeof(HeldLock));
+    free(spilled_held);
+    spilled_held = grown;
+    spilled_capacity = capacity * 2;
+}
+
+int library_lock_create(Library *library)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Library Lock Library pointer is NULL\n");
+        syslog(LOG_ERR, "Library Lock Library pointer is NULL\n");
+        return 0;
+    }
+    if (library->lock)
+    {
+        return 1;
+    }
+
+    LibraryLock *lock = (LibraryLock *)malloc(sizeof(LibraryLock));
+    if (!lock || pthread_rwlock_init(&lock->structure, NULL) != 0)
+    {
+        free(lock);
+        fprintf(stderr, "Failed to create library lock\n");
+        syslog(LOG_ERR, "Failed to create library lock\n");
+        return 0;
+    }
+    library->lock = lock;
+    return 1;
+}
+
+void library_lock_destroy(Library *library)
+{
+    if (!library || !library->lock)
+    {
+        return;
+    }
+    LibraryLock *lock = library->lock;
+    pthread_rwlock_destroy(&lock->structure);
+    free(lock);
+    library->lock = NULL;
+}
+
+void library_lock_exclusive(const Library *library)
+{
+    LibraryLock *lock = library ? library->lock : NULL;
+    if (!lock)
+    {
+        return;
+    }
+    HeldLock *held = find_held(lock);
+    if (held)
+    {
+        held->depth++;
+        return;
+    }
+    reserve_held();
+    pthread_rwlock_wrlock(&lock->structure);
+    held_locks()[num_held].lock = lock;
+    held_locks()[num_held].depth = 1;
+    num_held++;
+}
+
+void library_unlock_exclusive(const Library *library)
+{
+    LibraryLock *lock = library ? library->lock : NULL;
+    if (!lock)
+    {
+        return;
+    }
+    HeldLock *held = find_held(lock);
+    if (held && --held->depth > 0)
+    {
+        return;
+    }
+    if (held)
+    {
+        *held = held_locks()[--num_held];
+    }
+    if (num_held == 0 && spilled_held)
+    {
+        free(spilled_held);
+        spilled_held = NULL;
+    }
+    pthread_rwlock_unlock(&lock->structure);
+}
+
+void library_lock_shared(const Library *library)
+{
+    LibraryLock *lock = library ? library->lock : NULL;
+    if (lock && !find_held(lock))
+    {
+        pthread_rwlock_rdlock(&lock->structure);
+    }
+}
+
+void library_unlock_shared(const Library *library)
+{
+    LibraryLock *lock = library ? library->lock : NULL;
+    if (lock && !find_held(lock))
+    {
+        pthread_rwlock_unlock(&lock->structure);
+    }
+}
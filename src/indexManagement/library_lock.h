@@ -0,0 +1,28 @@
+// include/library_lock.h
+#ifndef LIBRARY_LOCK_H
+#define LIBRARY_LOCK_H
+
+#include "../include/structures.h"
+
+// Locking for libraries shared between threads. Every function is a no-op
+// on a library without a lock (see library_lock_create), so single-threaded
+// callers pay nothing.
+//
+// Structural changes (anything that can move, add or remove records or
+// touch an index) hold the library exclusively. Lookups, scans and
+// checkouts hold it shared; checkouts then claim the book and the loan
+// slot with compare-and-swap, so they never wait on one another (see
+// borrow_book). A thread holding the library exclusively may take it
+// again, exclusively or shared, without blocking; a thread holding it
+// shared must not ask for it exclusively. Reentry holds for every library
+// a thread has exclusively, however many it holds at once.
+
+int library_lock_create(Library *library);
+void library_lock_destroy(Library *library);
+
+void library_lock_exclusive(const Library *library);
+void library_unlock_exclusive(const Library *library);
+void library_lock_shared(const Library *library);
+void library_unlock_shared(const Library *library);
+
+#endif
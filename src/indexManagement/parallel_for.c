@@ -0,0 +1,245 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "parallel_for.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <syslog.h>
+#include <unistd.h>
+
+typedef struct
+{
+    ParallelForBody body;
+    void *context;
+    int count;
+    int chunk_items;
+    int num_chunks;
+    atomic_int next_chunk;
+} ParallelJob;
+
+// One job runs on the pool at a time, its caller holding submit_lock; a
+// caller that finds the lock taken runs its job alone instead of waiting.
+// pool_lock guards the fields below it.
+static pthread_mutex_t submit_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+static pthread_t workers[PARALLEL_FOR_MAX_THREADS];
+static int num_workers;
+static int requested_threads;
+static ParallelJob *current_job;
+static unsigned long job_serial;
+static int workers_busy;
+static int stopping;
+static pthread_once_t fork_handlers_once = PTHREAD_ONCE_INIT;
+
+// Set while this thread runs chunks, so nested calls stay on it
+static _Thread_local int inside_job;
+
+int parallel_for_chunk_items(size_t item_size)
+{
+    size_t items = item_size > 0 ? PARALLEL_FOR_CHUNK_BYTES / item_size : 1;
+    return items > 0 ? (int)items : 1;
+}
+
+int parallel_for_chunks(int count, size_t item_size)
+{
+    int chunk_items = parallel_for_chunk_items(item_size);
+    return count > 0 ? (count - 1) / chunk_items + 1 : 0;
+}
+
+static void run_chunks(ParallelJob *job)
+{
+    inside_job = 1;
+    while (1)
+    {
+        int chunk = atomic_fetch_add(&job->next_chunk, 1);
+        if (chunk >= job->num_chunks)
+        {
+            break;
+        }
+        int begin = chunk * job->chunk_items;
+        int end = job->count - begin > job->chunk_items
+                      ? begin + job->chunk_items
+                      : job->count;
+        job->body(job->context, chunk, begin, end);
+    }
+    inside_job = 0;
+}
+
+static void *work(void *argument)
+{
+    (void)argument;
+    pthread_mutex_lock(&pool_lock);
+    unsigned long seen = job_serial;
+    while (1)
+    {
+        while (!stopping && job_serial == seen)
+        {
+            pthread_cond_wait(&work_ready, &pool_lock);
+        }
+        if (stopping)
+        {
+            pthread_mutex_unlock(&pool_lock);
+            return NULL;
+        }
+        seen = job_serial;
+        // A job may have finished before this worker woke up for it
+        ParallelJob *job = current_job;
+        if (!job)
+        {
+            continue;
+        }
+        workers_busy++;
+        pthread_mutex_unlock(&pool_lock);
+
+        run_chunks(job);
+
+        pthread_mutex_lock(&pool_lock);
+        if (--workers_busy == 0)
+        {
+            pthread_cond_signal(&work_done);
+        }
+    }
+}
+
+// Only the forking thread survives fork(), so the child starts without
+// workers; holding both locks across fork() keeps them consistent
+static void before_fork(void)
+{
+    pthread_mutex_lock(&submit_lock);
+    pthread_mutex_lock(&pool_lock);
+}
+
+static void after_fork_in_parent(void)
+{
+    pthread_mutex_unlock(&pool_lock);
+    pthread_mutex_unlock(&submit_lock);
+}
+
+static void after_fork_in_child(void)
+{
+    num_workers = 0;
+    pthread_mutex_unlock(&pool_lock);
+    pthread_mutex_unlock(&submit_lock);
+}
+
+static void install_fork_handlers(void)
+{
+    pthread_atfork(before_fork, after_fork_in_parent, after_fork_in_child);
+}
+
+static int target_threads(void)
+{
+    long threads = requested_threads;
+    if (threads <= 0)
+    {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1)
+    {
+        return 1;
+    }
+    return threads > PARALLEL_FOR_MAX_THREADS ? PARALLEL_FOR_MAX_THREADS
+                                              : (int)threads;
+}
+
+// Starts workers up to the target, less the caller; called under
+// submit_lock. A pool that cannot grow runs with the workers it has.
+static void start_workers(void)
+{
+    pthread_once(&fork_handlers_once, install_fork_handlers);
+    int wanted = target_threads() - 1;
+    while (num_workers < wanted &&
+           pthread_create(&workers[num_workers], NULL, work, NULL) == 0)
+    {
+        num_workers++;
+    }
+    if (num_workers < wanted)
+    {
+        syslog(LOG_ERR,
+               "Started %d of %d parallel scan workers\n",
+               num_workers,
+               wanted);
+    }
+}
+
+static void stop_workers(void)
+{
+    pthread_mutex_lock(&pool_lock);
+    stopping = 1;
+    pthread_cond_broadcast(&work_ready);
+    pthread_mutex_unlock(&pool_lock);
+    for (int i = 0; i < num_workers; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    num_workers = 0;
+    stopping = 0;
+}
+
+int parallel_for(int count,
+                 size_t item_size,
+                 ParallelForBody body,
+                 void *context)
+{
+    if (!body || count < 0)
+    {
+        fprintf(stderr, "Parallel For Body pointer is NULL\n");
+        syslog(LOG_ERR, "Parallel For Body pointer is NULL\n");
+        return 0;
+    }
+
+    ParallelJob job = {body,
+                       context,
+                       count,
+                       parallel_for_chunk_items(item_size),
+                       parallel_for_chunks(count, item_size),
+                       0};
+    // Queueing behind another caller's job would leave this thread idle
+    // for all of that job; running alone it at least makes progress
+    if (job.num_chunks <= 1 || inside_job ||
+        pthread_mutex_trylock(&submit_lock) != 0)
+    {
+        int nested = inside_job;
+        run_chunks(&job);
+        inside_job = nested;
+        return 1;
+    }
+
+    start_workers();
+    pthread_mutex_lock(&pool_lock);
+    current_job = &job;
+    job_serial++;
+    pthread_cond_broadcast(&work_ready);
+    pthread_mutex_unlock(&pool_lock);
+
+    run_chunks(&job);
+
+    // Every chunk is claimed; wait for the workers still running theirs
+    pthread_mutex_lock(&pool_lock);
+    while (workers_busy > 0)
+    {
+        pthread_cond_wait(&work_done, &pool_lock);
+    }
+    current_job = NULL;
+    pthread_mutex_unlock(&pool_lock);
+    pthread_mutex_unlock(&submit_lock);
+    return 1;
+}
+
+void set_parallel_for_threads(int num_threads)
+{
+    pthread_mutex_lock(&submit_lock);
+    stop_workers();
+    requested_threads = num_threads > 0 ? num_threads : 0;
+    pthread_mutex_unlock(&submit_lock);
+}
+
+int get_parallel_for_threads(void)
+{
+    pthread_mutex_lock(&submit_lock);
+    int threads = target_threads();
+    pthread_mutex_unlock(&submit_lock);
+    return threads;
+}
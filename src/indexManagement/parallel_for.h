@@ -0,0 +1,36 @@
+// include/parallel_for.h
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <stddef.h>
+
+// Bytes of items per chunk: small enough that a chunk stays in a core's
+// cache while it is reduced
+#define PARALLEL_FOR_CHUNK_BYTES (256U * 1024U)
+#define PARALLEL_FOR_MAX_THREADS 64
+
+// Called once per chunk with the chunk's index and its item range
+// [begin, end). Chunks run concurrently and in no particular order, so a
+// body writes only to its own chunk's partial result; the caller merges
+// the partials, in chunk order when order matters.
+typedef void (*ParallelForBody)(void *context, int chunk, int begin, int end);
+
+// Items per chunk, and the number of chunks that count items split into
+int parallel_for_chunk_items(size_t item_size);
+int parallel_for_chunks(int count, size_t item_size);
+// Runs body over every chunk of [0, count) on a shared pool of worker
+// threads and the calling thread, and returns once all chunks are done.
+// Work that fits in one chunk, calls made from inside a body, and calls
+// made while another thread's job holds the pool run on the calling
+// thread alone. Returns 0 on invalid arguments.
+int parallel_for(int count,
+                 size_t item_size,
+                 ParallelForBody body,
+                 void *context);
+// Threads parallel_for uses, the caller included; 0 (the default) means
+// one per online CPU. Changing it stops the current workers, so call it
+// only while no parallel_for is running.
+void set_parallel_for_threads(int num_threads);
+int get_parallel_for_threads(void);
+
+#endif
@@ -0,0 +1,530 @@
+#include "token_index.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOKEN_INDEX_MIN_CAPACITY 64
+#define POSTING_MIN_CAPACITY 4
+// Query terms kept on the stack; longer queries move them to the heap
+#define QUERY_INLINE_TERMS 16
+
+int next_token(const char **cursor, char *token, size_t token_size)
+{
+    if (!cursor || !*cursor || !token || token_size < 2)
+    {
+        return 0;
+    }
+
+    const unsigned char *text = (const unsigned char *)*cursor;
+    while (*text && !isalnum(*text))
+    {
+        text++;
+    }
+
+    size_t length = 0;
+    while (*text && isalnum(*text))
+    {
+        if (length < token_size - 1)
+        {
+            token[length++] = (char)tolower(*text);
+        }
+        text++;
+    }
+    token[length] = '\0';
+    *cursor = (const char *)text;
+    return length > 0;
+}
+
+static uint64_t hash_token(const char *token)
+{
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const unsigned char *c = (const unsigned char *)token; *c; c++)
+    {
+        hash ^= *c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static size_t find_slot(const TokenIndex *index, const char *token)
+{
+    size_t mask = (size_t)index->capacity - 1;
+    size_t slot = (size_t)(hash_token(token) & mask);
+    while (index->tokens[slot] && strcmp(index->tokens[slot], token) != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static int allocate_table(TokenIndex *index, int capacity)
+{
+    index->tokens = (char **)calloc((size_t)capacity, sizeof(char *));
+    index->postings = (PostingList *)calloc((size_t)capacity,
+                                            sizeof(PostingList));
+    if (!index->tokens || !index->postings)
+    {
+        free(index->tokens);
+        free(index->postings);
+        index->tokens = NULL;
+        index->postings = NULL;
+        return 0;
+    }
+    index->capacity = capacity;
+    index->count = 0;
+    return 1;
+}
+
+int token_index_init(TokenIndex *index, int expected_tokens)
+{
+    if (!index)
+    {
+        fprintf(stderr, "Token Index pointer is NULL\n");
+        syslog(LOG_ERR, "Token Index pointer is NULL\n");
+        return 0;
+    }
+
+    memset(index, 0, sizeof(TokenIndex));
+    int capacity = TOKEN_INDEX_MIN_CAPACITY;
+    while (capacity < (1 << 30) && capacity / 2 <= expected_tokens)
+    {
+        capacity *= 2;
+    }
+    if (!allocate_table(index, capacity))
+    {
+        fprintf(stderr, "Memory allocation failed for token index\n");
+        syslog(LOG_ERR, "Memory allocation failed for token index\n");
+        return 0;
+    }
+    return 1;
+}
+
+void token_index_clear(TokenIndex *index)
+{
+    if (!token_index_is_built(index))
+    {
+        return;
+    }
+    for (int i = 0; i < index->capacity; i++)
+    {
+        free(index->tokens[i]);
+        free(index->postings[i].ids);
+    }
+    memset(index->tokens, 0, (size_t)index->capacity * sizeof(char *));
+    memset(index->postings, 0, (size_t)index->capacity * sizeof(PostingList));
+    index->count = 0;
+}
+
+void token_index_deinit(TokenIndex *index)
+{
+    if (!token_index_is_built(index))
+    {
+        return;
+    }
+    token_index_clear(index);
+    free(index->tokens);
+    free(index->postings);
+    memset(index, 0, sizeof(TokenIndex));
+}
+
+int token_index_is_built(const TokenIndex *index)
+{
+    return index && index->tokens != NULL;
+}
+
+static int grow_table(TokenIndex *index)
+{
+    TokenIndex grown = {0};
+    if (!allocate_table(&grown, index->capacity * 2))
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < index->capacity; i++)
+    {
+        if (index->tokens[i])
+        {
+            size_t slot = find_slot(&grown, index->tokens[i]);
+            grown.tokens[slot] = index->tokens[i];
+            grown.postings[slot] = index->postings[i];
+            grown.count++;
+        }
+    }
+
+    free(index->tokens);
+    free(index->postings);
+    *index = grown;
+    return 1;
+}
+
+static int lower_bound(const PostingList *list, int doc_id)
+{
+    int low = 0;
+    int high = list->count;
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (list->ids[mid] < doc_id)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+int posting_list_insert(PostingList *list, int doc_id)
+{
+    // IDs are handed out in increasing order, so appends are the norm
+    int position = list->count;
+    if (list->count > 0 && list->ids[list->count - 1] >= doc_id)
+    {
+        position = lower_bound(list, doc_id);
+        if (position < list->count && list->ids[position] == doc_id)
+        {
+            return 1;
+        }
+    }
+
+    if (list->count >= list->capacity)
+    {
+        int new_capacity = list->capacity ? list->capacity * 2
+                                          : POSTING_MIN_CAPACITY;
+        int *new_ids =
+            realloc(list->ids, (size_t)new_capacity * sizeof(int));
+        if (!new_ids)
+        {
+            return 0;
+        }
+        list->ids = new_ids;
+        list->capacity = new_capacity;
+    }
+
+    memmove(&list->ids[position + 1],
+            &list->ids[position],
+            (size_t)(list->count - position) * sizeof(int));
+    list->ids[position] = doc_id;
+    list->count++;
+    return 1;
+}
+
+void posting_list_remove(PostingList *list, int doc_id)
+{
+    int position = lower_bound(list, doc_id);
+    if (position < list->count && list->ids[position] == doc_id)
+    {
+        memmove(&list->ids[position],
+                &list->ids[position + 1],
+                (size_t)(list->count - position - 1) * sizeof(int));
+        list->count--;
+    }
+}
+
+int token_index_add_document(TokenIndex *index, int doc_id, const char *text)
+{
+    if (!token_index_is_built(index) || !text)
+    {
+        return 0;
+    }
+
+    char token[MAX_TOKEN_LENGTH];
+    const char *cursor = text;
+    while (next_token(&cursor, token, sizeof(token)))
+    {
+        if ((index->count + 1) * 2 > index->capacity && !grow_table(index))
+        {
+            return 0;
+        }
+
+        size_t slot = find_slot(index, token);
+        if (!index->tokens[slot])
+        {
+            size_t length = strlen(token) + 1;
+            index->tokens[slot] = (char *)malloc(length);
+            if (!index->tokens[slot])
+            {
+                return 0;
+            }
+            memcpy(index->tokens[slot], token, length);
+            index->count++;
+        }
+
+        if (!posting_list_insert(&index->postings[slot], doc_id))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int append_postings(PostingList *list, const PostingList *more)
+{
+    if (list->count > 0 && more->count > 0 &&
+        list->ids[list->count - 1] >= more->ids[0])
+    {
+        for (int i = 0; i < more->count; i++)
+        {
+            if (!posting_list_insert(list, more->ids[i]))
+            {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    if (list->count + more->count > list->capacity)
+    {
+        int *new_ids = realloc(
+            list->ids, (size_t)(list->count + more->count) * sizeof(int));
+        if (!new_ids)
+        {
+            return 0;
+        }
+        list->ids = new_ids;
+        list->capacity = list->count + more->count;
+    }
+    memcpy(&list->ids[list->count],
+           more->ids,
+           (size_t)more->count * sizeof(int));
+    list->count += more->count;
+    return 1;
+}
+
+int token_index_merge(TokenIndex *index, TokenIndex *other)
+{
+    if (!token_index_is_built(index) || !token_index_is_built(other))
+    {
+        return 0;
+    }
+
+    int merged = 1;
+    for (int i = 0; merged && i < other->capacity; i++)
+    {
+        if (!other->tokens[i])
+        {
+            continue;
+        }
+        if ((index->count + 1) * 2 > index->capacity && !grow_table(index))
+        {
+            merged = 0;
+            break;
+        }
+
+        size_t slot = find_slot(index, other->tokens[i]);
+        if (!index->tokens[slot])
+        {
+            // New to index: take over the token and its postings as they are
+            index->tokens[slot] = other->tokens[i];
+            index->postings[slot] = other->postings[i];
+            index->count++;
+            other->tokens[i] = NULL;
+            memset(&other->postings[i], 0, sizeof(PostingList));
+            continue;
+        }
+        merged = append_postings(&index->postings[slot], &other->postings[i]);
+    }
+    token_index_deinit(other);
+    return merged;
+}
+
+int token_index_restore(TokenIndex *index,
+                        const char *token,
+                        const int *doc_ids,
+                        int count)
+{
+    size_t length = token ? strlen(token) + 1 : 0;
+    if (!token_index_is_built(index) || length < 2 ||
+        length > MAX_TOKEN_LENGTH || (!doc_ids && count > 0) || count < 0 ||
+        ((index->count + 1) * 2 > index->capacity && !grow_table(index)))
+    {
+        return 0;
+    }
+
+    size_t slot = find_slot(index, token);
+    if (index->tokens[slot])
+    {
+        return 0;
+    }
+    char *copy = (char *)malloc(length);
+    int *ids = (int *)malloc((count ? (size_t)count : 1) * sizeof(int));
+    if (!copy || !ids)
+    {
+        free(copy);
+        free(ids);
+        return 0;
+    }
+    memcpy(copy, token, length);
+    if (count > 0)
+    {
+        memcpy(ids, doc_ids, (size_t)count * sizeof(int));
+    }
+    index->tokens[slot] = copy;
+    index->postings[slot].ids = ids;
+    index->postings[slot].count = count;
+    index->postings[slot].capacity = count ? count : 1;
+    index->count++;
+    return 1;
+}
+
+void token_index_remove_document(TokenIndex *index,
+                                 int doc_id,
+                                 const char *text)
+{
+    if (!token_index_is_built(index) || !text)
+    {
+        return;
+    }
+
+    // Tokens whose posting list empties stay in the table; they are cheap
+    // and likely to be reused by the next book from the same author.
+    char token[MAX_TOKEN_LENGTH];
+    const char *cursor = text;
+    while (next_token(&cursor, token, sizeof(token)))
+    {
+        size_t slot = find_slot(index, token);
+        if (index->tokens[slot])
+        {
+            posting_list_remove(&index->postings[slot], doc_id);
+        }
+    }
+}
+
+const PostingList *token_index_lookup(const TokenIndex *index,
+                                      const char *token)
+{
+    if (!token_index_is_built(index) || !token)
+    {
+        return NULL;
+    }
+    size_t slot = find_slot(index, token);
+    return index->tokens[slot] ? &index->postings[slot] : NULL;
+}
+
+static int contains(const PostingList *list, int doc_id)
+{
+    int position = lower_bound(list, doc_id);
+    return position < list->count && list->ids[position] == doc_id;
+}
+
+// Doubles the term array, moving it off the stack the first time
+static int grow_query_terms(const PostingList ***lists,
+                            int *capacity,
+                            const PostingList **inline_lists)
+{
+    int grown = *capacity * 2;
+    const PostingList **larger =
+        (const PostingList **)malloc((size_t)grown * sizeof(*larger));
+    if (!larger)
+    {
+        return 0;
+    }
+    memcpy(larger, *lists, (size_t)*capacity * sizeof(*larger));
+    if (*lists != inline_lists)
+    {
+        free(*lists);
+    }
+    *lists = larger;
+    *capacity = grown;
+    return 1;
+}
+
+// Documents in every list, found by probing the others for each document
+// of the rarest one
+static int intersect_postings(const PostingList **lists,
+                              int num_lists,
+                              int **doc_ids)
+{
+    int rarest = 0;
+    for (int i = 1; i < num_lists; i++)
+    {
+        if (lists[i]->count < lists[rarest]->count)
+        {
+            rarest = i;
+        }
+    }
+
+    int *result = (int *)malloc((size_t)lists[rarest]->count * sizeof(int));
+    if (!result)
+    {
+        return -1;
+    }
+
+    int count = 0;
+    for (int i = 0; i < lists[rarest]->count; i++)
+    {
+        int doc_id = lists[rarest]->ids[i];
+        int matches = 1;
+        for (int j = 0; j < num_lists && matches; j++)
+        {
+            matches = j == rarest || contains(lists[j], doc_id);
+        }
+        if (matches)
+        {
+            result[count++] = doc_id;
+        }
+    }
+
+    if (count == 0)
+    {
+        free(result);
+        return 0;
+    }
+    *doc_ids = result;
+    return count;
+}
+
+int token_index_query(const TokenIndex *index, const char *query, int **doc_ids)
+{
+    if (!doc_ids)
+    {
+        return -1;
+    }
+    *doc_ids = NULL;
+    if (!token_index_is_built(index) || !query)
+    {
+        return -1;
+    }
+
+    const PostingList *inline_lists[QUERY_INLINE_TERMS];
+    const PostingList **lists = inline_lists;
+    int capacity = QUERY_INLINE_TERMS;
+    int num_lists = 0;
+    // 1 while every term so far has postings, 0 once one has none
+    int status = 1;
+
+    char token[MAX_TOKEN_LENGTH];
+    const char *cursor = query;
+    while (status == 1 && next_token(&cursor, token, sizeof(token)))
+    {
+        const PostingList *list = token_index_lookup(index, token);
+        if (!list || list->count == 0)
+        {
+            status = 0;
+        }
+        else if (num_lists == capacity &&
+                 !grow_query_terms(&lists, &capacity, inline_lists))
+        {
+            status = -1;
+        }
+        else
+        {
+            lists[num_lists++] = list;
+        }
+    }
+    if (status == 1)
+    {
+        status = num_lists > 0 ? intersect_postings(lists, num_lists, doc_ids)
+                               : 0;
+    }
+
+    if (lists != inline_lists)
+    {
+        free(lists);
+    }
+    return status;
+}
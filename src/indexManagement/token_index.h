@@ -0,0 +1,40 @@
+// include/token_index.h
+#ifndef TOKEN_INDEX_H
+#define TOKEN_INDEX_H
+
+#include <stddef.h>
+
+#include "../include/structures.h"
+
+#define MAX_TOKEN_LENGTH 64
+
+int posting_list_insert(PostingList *list, int doc_id);
+void posting_list_remove(PostingList *list, int doc_id);
+
+int next_token(const char **cursor, char *token, size_t token_size);
+
+int token_index_init(TokenIndex *index, int expected_tokens);
+void token_index_deinit(TokenIndex *index);
+int token_index_is_built(const TokenIndex *index);
+void token_index_clear(TokenIndex *index);
+int token_index_add_document(TokenIndex *index, int doc_id, const char *text);
+// Moves every posting of other into index and releases other. Cheapest
+// when other's IDs all follow index's, as with indexes of ID-range shards
+// merged in order.
+int token_index_merge(TokenIndex *index, TokenIndex *other);
+// Adds token with the given ascending, duplicate-free posting list, as
+// read back from a saved index; fails if the token is already present
+int token_index_restore(TokenIndex *index,
+                        const char *token,
+                        const int *doc_ids,
+                        int count);
+void token_index_remove_document(TokenIndex *index,
+                                 int doc_id,
+                                 const char *text);
+const PostingList *token_index_lookup(const TokenIndex *index,
+                                      const char *token);
+int token_index_query(const TokenIndex *index,
+                      const char *query,
+                      int **doc_ids);
+
+#endif
@@ -0,0 +1,310 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "work_stealing.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <unistd.h>
+
+typedef struct
+{
+    WorkTask task;
+    void *context;
+    WorkGroup *group;
+} QueuedTask;
+
+// A ring of tasks, oldest at head. The owner pushes and pops at the tail;
+// thieves take from the head, so they get the biggest, least recently
+// split pieces of work.
+typedef struct
+{
+    pthread_mutex_t lock;
+    QueuedTask *tasks;
+    int capacity;
+    int head;
+    int count;
+} TaskDeque;
+
+typedef struct
+{
+    WorkStealingPool *pool;
+    int index;
+} WorkerSeat;
+
+struct WorkStealingPool
+{
+    // Guards stopping; submitters, finished groups and stop all signal
+    // changed under it
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int stopping;
+    // Tasks sitting in any deque; raised under lock so sleepers see it
+    atomic_int queued;
+    int num_workers;
+    // Deque i belongs to worker i; the last one takes outside submissions
+    int num_deques;
+    TaskDeque deques[WORK_POOL_MAX_THREADS];
+    WorkerSeat seats[WORK_POOL_MAX_THREADS];
+    pthread_t workers[WORK_POOL_MAX_THREADS];
+};
+
+// The pool and deque of the worker running on this thread, if any
+static _Thread_local WorkStealingPool *current_pool;
+static _Thread_local int current_deque;
+
+static int push_task(TaskDeque *deque, const QueuedTask *task)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == deque->capacity)
+    {
+        int capacity = deque->capacity > 0 ? deque->capacity * 2 : 16;
+        QueuedTask *tasks =
+            (QueuedTask *)malloc((size_t)capacity * sizeof(QueuedTask));
+        if (!tasks)
+        {
+            pthread_mutex_unlock(&deque->lock);
+            return 0;
+        }
+        for (int i = 0; i < deque->count; i++)
+        {
+            tasks[i] = deque->tasks[(deque->head + i) % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity = capacity;
+        deque->head = 0;
+    }
+    deque->tasks[(deque->head + deque->count) % deque->capacity] = *task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+    return 1;
+}
+
+static int pop_newest(TaskDeque *deque, QueuedTask *task)
+{
+    pthread_mutex_lock(&deque->lock);
+    int found = deque->count > 0;
+    if (found)
+    {
+        deque->count--;
+        *task = deque->tasks[(deque->head + deque->count) % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static int steal_oldest(TaskDeque *deque, QueuedTask *task)
+{
+    pthread_mutex_lock(&deque->lock);
+    int found = deque->count > 0;
+    if (found)
+    {
+        *task = deque->tasks[deque->head];
+        deque->head = (deque->head + 1) % deque->capacity;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// Own deque first (self < 0 for threads outside the pool), then every
+// other deque starting with the next one, so thieves spread out
+static int take_task(WorkStealingPool *pool, int self, QueuedTask *task)
+{
+    int found = self >= 0 && pop_newest(&pool->deques[self], task);
+    for (int i = 1; !found && i <= pool->num_deques; i++)
+    {
+        int victim = (self + i + pool->num_deques) % pool->num_deques;
+        found = victim != self && steal_oldest(&pool->deques[victim], task);
+    }
+    if (found)
+    {
+        atomic_fetch_sub(&pool->queued, 1);
+    }
+    return found;
+}
+
+static void run_task(WorkStealingPool *pool, const QueuedTask *task)
+{
+    task->task(task->context);
+    if (atomic_fetch_sub(&task->group->pending, 1) == 1)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->changed);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void *work(void *argument)
+{
+    WorkerSeat *seat = (WorkerSeat *)argument;
+    WorkStealingPool *pool = seat->pool;
+    current_pool = pool;
+    current_deque = seat->index;
+    while (1)
+    {
+        QueuedTask task;
+        if (take_task(pool, seat->index, &task))
+        {
+            run_task(pool, &task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stopping && atomic_load(&pool->queued) <= 0)
+        {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        }
+        int stopping = pool->stopping;
+        pthread_mutex_unlock(&pool->lock);
+        if (stopping)
+        {
+            return NULL;
+        }
+    }
+}
+
+static int target_threads(int num_threads)
+{
+    long threads = num_threads;
+    if (threads <= 0)
+    {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1)
+    {
+        return 1;
+    }
+    return threads > WORK_POOL_MAX_THREADS ? WORK_POOL_MAX_THREADS
+                                           : (int)threads;
+}
+
+WorkStealingPool *work_pool_create(int num_threads)
+{
+    WorkStealingPool *pool =
+        (WorkStealingPool *)calloc(1, sizeof(WorkStealingPool));
+    if (!pool)
+    {
+        fprintf(stderr, "Failed to allocate work pool\n");
+        syslog(LOG_ERR, "Failed to allocate work pool\n");
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->changed, NULL);
+    atomic_init(&pool->queued, 0);
+
+    // The waiting caller stands in for one thread and shares the last deque
+    int wanted = target_threads(num_threads) - 1;
+    pool->num_deques = wanted + 1;
+    for (int i = 0; i < pool->num_deques; i++)
+    {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+    }
+    while (pool->num_workers < wanted)
+    {
+        WorkerSeat *seat = &pool->seats[pool->num_workers];
+        seat->pool = pool;
+        seat->index = pool->num_workers;
+        pthread_t *worker = &pool->workers[pool->num_workers];
+        if (pthread_create(worker, NULL, work, seat) != 0)
+        {
+            syslog(LOG_ERR,
+                   "Started %d of %d work pool workers\n",
+                   pool->num_workers,
+                   wanted);
+            break;
+        }
+        pool->num_workers++;
+    }
+    return pool;
+}
+
+void work_pool_destroy(WorkStealingPool *pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->num_workers; i++)
+    {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    for (int i = 0; i < pool->num_deques; i++)
+    {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        free(pool->deques[i].tasks);
+    }
+    pthread_cond_destroy(&pool->changed);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+int work_pool_threads(const WorkStealingPool *pool)
+{
+    return pool ? pool->num_workers + 1 : 0;
+}
+
+int work_pool_submit(WorkStealingPool *pool,
+                     WorkGroup *group,
+                     WorkTask task,
+                     void *context)
+{
+    if (!pool || !group || !task)
+    {
+        fprintf(stderr, "Invalid parameters for submitting a task\n");
+        syslog(LOG_ERR, "Invalid parameters for submitting a task\n");
+        return 0;
+    }
+
+    QueuedTask queued = {task, context, group};
+    atomic_fetch_add(&group->pending, 1);
+    int deque = current_pool == pool ? current_deque : pool->num_deques - 1;
+    if (!push_task(&pool->deques[deque], &queued))
+    {
+        run_task(pool, &queued);
+        return 1;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->queued, 1);
+    pthread_cond_signal(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+    return 1;
+}
+
+void work_group_wait(WorkStealingPool *pool, WorkGroup *group)
+{
+    if (!pool || !group)
+    {
+        fprintf(stderr, "Invalid parameters for waiting on a work group\n");
+        syslog(LOG_ERR, "Invalid parameters for waiting on a work group\n");
+        return;
+    }
+
+    int self = current_pool == pool ? current_deque : -1;
+    while (atomic_load(&group->pending) > 0)
+    {
+        QueuedTask task;
+        if (take_task(pool, self, &task))
+        {
+            run_task(pool, &task);
+            continue;
+        }
+
+        // Whatever is left runs on other threads; sleep until it finishes
+        // or they queue more
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&group->pending) > 0 &&
+               atomic_load(&pool->queued) <= 0)
+        {
+            pthread_cond_wait(&pool->changed, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
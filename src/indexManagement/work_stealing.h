@@ -0,0 +1,45 @@
+// include/work_stealing.h
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <stdatomic.h>
+
+#define WORK_POOL_MAX_THREADS 64
+
+typedef void (*WorkTask)(void *context);
+
+// Counts the tasks submitted under it that have not finished yet; define
+// with WORK_GROUP_INIT and wait for it with work_group_wait
+typedef struct
+{
+    atomic_int pending;
+} WorkGroup;
+
+#define WORK_GROUP_INIT {0}
+
+// A pool of worker threads, each with its own deque of tasks. A worker
+// runs the newest task of its own deque first and, when that is empty,
+// steals the oldest task of another deque, so a task that splits its work
+// and submits the halves keeps its own thread busy while idle threads take
+// the rest. Tasks submitted from outside the pool go to a shared deque
+// every worker steals from.
+typedef struct WorkStealingPool WorkStealingPool;
+
+// num_threads counts the threads that run tasks, a caller waiting in
+// work_group_wait included; 0 means one per online CPU
+WorkStealingPool *work_pool_create(int num_threads);
+// Stops the workers; call only once no group is pending
+void work_pool_destroy(WorkStealingPool *pool);
+int work_pool_threads(const WorkStealingPool *pool);
+// Queues task(context) under group. Tasks may submit further tasks; a task
+// that cannot be queued runs on the calling thread before this returns.
+// Returns 0 on invalid arguments.
+int work_pool_submit(WorkStealingPool *pool,
+                     WorkGroup *group,
+                     WorkTask task,
+                     void *context);
+// Runs and steals tasks on the calling thread until every task of the
+// group, and every task they submitted under it, has finished
+void work_group_wait(WorkStealingPool *pool, WorkGroup *group);
+
+#endif
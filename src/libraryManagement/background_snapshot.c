@@ -0,0 +1,201 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "background_snapshot.h"
+#include "library_management.h"
+#include "../indexManagement/author_dictionary.h"
+#include "../indexManagement/library_lock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+static long long monotonic_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// Grows an image array to hold count elements; a large enough one is kept
+static int reserve_image_array(void **array,
+                               int *capacity,
+                               int count,
+                               size_t element_size)
+{
+    if (count <= *capacity)
+    {
+        return 1;
+    }
+    void *grown = realloc(*array, (size_t)count * element_size);
+    if (!grown)
+    {
+        return 0;
+    }
+    *array = grown;
+    *capacity = count;
+    return 1;
+}
+
+// Called under the library's exclusive lock, which also holds off the
+// lock-free checkouts that run under its shared lock
+static int copy_library_image(Library *image, const Library *library)
+{
+    if (!reserve_image_array((void **)&image->books,
+                             &image->capacity_books,
+                             library->num_books,
+                             sizeof(Book)) ||
+        !reserve_image_array((void **)&image->members,
+                             &image->capacity_members,
+                             library->num_members,
+                             sizeof(Member)))
+    {
+        return 0;
+    }
+    if (library->num_books > 0)
+    {
+        memcpy(image->books,
+               library->books,
+               (size_t)library->num_books * sizeof(Book));
+    }
+    if (library->num_members > 0)
+    {
+        memcpy(image->members,
+               library->members,
+               (size_t)library->num_members * sizeof(Member));
+    }
+    image->num_books = library->num_books;
+    image->num_free_books = library->num_free_books;
+    image->num_members = library->num_members;
+    image->num_free_members = library->num_free_members;
+    image->journal_lsn = library->journal_lsn;
+    image->generation = library->generation;
+    image->file_encoding = library->file_encoding;
+
+    // Interning the names in order gives them the IDs the books carry
+    author_dictionary_deinit(&image->authors);
+    const AuthorDictionary *authors = &library->authors;
+    if (!author_dictionary_is_built(authors))
+    {
+        return 1;
+    }
+    int interned = author_dictionary_init(&image->authors, authors->num_names);
+    for (int i = 0; interned && i < authors->num_names; i++)
+    {
+        uint32_t author_id = 0;
+        interned = author_dictionary_intern(
+            &image->authors, authors->names[i], &author_id);
+    }
+    return interned;
+}
+
+static void *write_image(void *argument)
+{
+    BackgroundSnapshot *snapshot = (BackgroundSnapshot *)argument;
+    snapshot->saved = save_library_to_file(&snapshot->image, snapshot->path);
+    atomic_store(&snapshot->finished, 1);
+    return NULL;
+}
+
+int background_snapshot_start(BackgroundSnapshot *snapshot,
+                              Library *library,
+                              const char *path)
+{
+    if (!snapshot || !library || !path)
+    {
+        fprintf(stderr, "Background Snapshot Library or Path is NULL\n");
+        syslog(LOG_ERR, "Background Snapshot Library or Path is NULL\n");
+        return 0;
+    }
+    if (snapshot->running)
+    {
+        fprintf(stderr, "A background snapshot is already running\n");
+        syslog(LOG_ERR, "A background snapshot is already running\n");
+        return 0;
+    }
+
+    size_t length = strlen(path) + 1;
+    char *path_copy = (char *)malloc(length);
+    if (!path_copy)
+    {
+        fprintf(stderr, "Memory allocation failed for snapshot path\n");
+        syslog(LOG_ERR, "Memory allocation failed for snapshot path\n");
+        return 0;
+    }
+    memcpy(path_copy, path, length);
+    free(snapshot->path);
+    snapshot->path = path_copy;
+
+    long long started_ms = monotonic_ms();
+    atomic_store(&snapshot->finished, 0);
+    library_lock_exclusive(library);
+    int started =
+        copy_library_image(&snapshot->image, library) &&
+        pthread_create(&snapshot->writer, NULL, write_image, snapshot) == 0;
+    if (started)
+    {
+        // The writer saves the next generation
+        library->generation++;
+        snapshot->journal_lsn = library->journal_lsn;
+    }
+    library_unlock_exclusive(library);
+    if (!started)
+    {
+        fprintf(stderr, "Failed to start background snapshot\n");
+        syslog(LOG_ERR, "Failed to start background snapshot\n");
+        return 0;
+    }
+
+    snapshot->running = 1;
+    snapshot->started_ms = started_ms;
+    syslog(LOG_INFO, "Background snapshot of %s started\n", path);
+    return 1;
+}
+
+SnapshotState background_snapshot_poll(BackgroundSnapshot *snapshot, int wait)
+{
+    if (!snapshot || !snapshot->running)
+    {
+        return SNAPSHOT_IDLE;
+    }
+    if (!wait && !atomic_load(&snapshot->finished))
+    {
+        return SNAPSHOT_RUNNING;
+    }
+
+    pthread_join(snapshot->writer, NULL);
+    snapshot->running = 0;
+    snapshot->metrics.duration_ms = monotonic_ms() - snapshot->started_ms;
+    struct stat info;
+    if (!snapshot->saved || stat(snapshot->path, &info) != 0)
+    {
+        snapshot->metrics.bytes_written = 0;
+        snapshot->metrics.failed++;
+        fprintf(stderr, "Background snapshot of %s failed\n", snapshot->path);
+        syslog(LOG_ERR, "Background snapshot of %s failed\n", snapshot->path);
+        return SNAPSHOT_FAILED;
+    }
+
+    snapshot->metrics.bytes_written = (long long)info.st_size;
+    snapshot->metrics.completed++;
+    syslog(LOG_INFO,
+           "Background snapshot of %s wrote %lld bytes in %lld ms\n",
+           snapshot->path,
+           snapshot->metrics.bytes_written,
+           snapshot->metrics.duration_ms);
+    return SNAPSHOT_COMPLETED;
+}
+
+void background_snapshot_deinit(BackgroundSnapshot *snapshot)
+{
+    if (!snapshot)
+    {
+        return;
+    }
+    background_snapshot_poll(snapshot, 1);
+    free(snapshot->image.books);
+    free(snapshot->image.members);
+    author_dictionary_deinit(&snapshot->image.authors);
+    free(snapshot->path);
+    memset(snapshot, 0, sizeof(BackgroundSnapshot));
+}
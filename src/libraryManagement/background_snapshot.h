@@ -0,0 +1,60 @@
+// include/background_snapshot.h
+#ifndef BACKGROUND_SNAPSHOT_H
+#define BACKGROUND_SNAPSHOT_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../include/structures.h"
+
+typedef enum
+{
+    SNAPSHOT_IDLE = 0,
+    SNAPSHOT_RUNNING,
+    SNAPSHOT_COMPLETED,
+    SNAPSHOT_FAILED
+} SnapshotState;
+
+typedef struct
+{
+    // Of the most recent finished snapshot, from the copy to the join
+    long long duration_ms;
+    long long bytes_written;
+    int completed;
+    int failed;
+} SnapshotMetrics;
+
+// A zeroed BackgroundSnapshot is idle
+typedef struct
+{
+    // The books, members and author names as they were when the snapshot
+    // started. Its arrays are kept from one snapshot to the next and only
+    // grow, so regular checkpoints stop allocating once they are sized.
+    Library image;
+    pthread_t writer;
+    int running;
+    // Set by the writer thread once the file is written or has failed
+    atomic_int finished;
+    int saved;
+    char *path;
+    long long started_ms;
+    // library->journal_lsn at the moment the image was taken
+    uint64_t journal_lsn;
+    SnapshotMetrics metrics;
+} BackgroundSnapshot;
+
+// Copies the library's books, members and author names under its
+// exclusive lock and saves the copy with save_library_to_file from a
+// helper thread, so the caller, and any other thread, keeps changing the
+// library while the file is written. ISBN and text indexes are not
+// copied; loading the file rebuilds them. Only one snapshot runs at a time.
+int background_snapshot_start(BackgroundSnapshot *snapshot,
+                              Library *library,
+                              const char *path);
+// Joins a finished writer and updates metrics; with wait set, blocks until
+// the running snapshot is done. COMPLETED and FAILED are reported once.
+SnapshotState background_snapshot_poll(BackgroundSnapshot *snapshot, int wait);
+// Waits for a running snapshot and releases the image and the path
+void background_snapshot_deinit(BackgroundSnapshot *snapshot);
+
+#endif
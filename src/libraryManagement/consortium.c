@@ -0,0 +1,420 @@
+#include "consortium.h"
+#include <ctype.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+
+#include "../bookManagement/book_management.h"
+#include "../indexManagement/id_allocator.h"
+#include "../indexManagement/isbn.h"
+#include "../indexManagement/library_lock.h"
+#include "../indexManagement/work_stealing.h"
+#include "../memberManagement/member_management.h"
+#include "library_management.h"
+
+// Title scans are split in halves until a piece has at most this many
+// books; small enough that one busy branch still feeds every thread
+#define CONSORTIUM_SCAN_BOOKS 4096
+
+struct Consortium
+{
+    Library *branches[MAX_CONSORTIUM_BRANCHES];
+    int num_branches;
+    ConsortiumSharding sharding;
+    WorkStealingPool *pool;
+};
+
+Consortium *create_consortium(int num_branches,
+                              ConsortiumSharding sharding,
+                              int num_threads)
+{
+    if (num_branches < 1 || num_branches > MAX_CONSORTIUM_BRANCHES ||
+        (sharding != CONSORTIUM_SHARD_BY_BRANCH &&
+         sharding != CONSORTIUM_SHARD_BY_HASH))
+    {
+        fprintf(stderr, "Invalid parameters for creating a consortium\n");
+        syslog(LOG_ERR, "Invalid parameters for creating a consortium\n");
+        return NULL;
+    }
+
+    Consortium *consortium = (Consortium *)calloc(1, sizeof(Consortium));
+    if (!consortium)
+    {
+        fprintf(stderr, "Failed to allocate consortium\n");
+        syslog(LOG_ERR, "Failed to allocate consortium\n");
+        return NULL;
+    }
+    consortium->sharding = sharding;
+    consortium->pool = work_pool_create(num_threads);
+    int ready = consortium->pool != NULL;
+    for (int i = 0; ready && i < num_branches; i++)
+    {
+        Library *branch = create_library();
+        if (branch)
+        {
+            consortium->branches[consortium->num_branches++] = branch;
+        }
+        ready = branch && enable_library_concurrency(branch);
+    }
+    if (!ready)
+    {
+        delete_consortium(consortium);
+        return NULL;
+    }
+
+    syslog(LOG_INFO,
+           "Created consortium with %d branches on %d threads\n",
+           num_branches,
+           work_pool_threads(consortium->pool));
+    return consortium;
+}
+
+void delete_consortium(Consortium *consortium)
+{
+    if (!consortium)
+    {
+        return;
+    }
+    // delete_library leaves the Library itself allocated
+    for (int i = 0; i < consortium->num_branches; i++)
+    {
+        deinit_library(consortium->branches[i]);
+        free(consortium->branches[i]);
+    }
+    work_pool_destroy(consortium->pool);
+    free(consortium);
+}
+
+int consortium_branch_count(const Consortium *consortium)
+{
+    return consortium ? consortium->num_branches : 0;
+}
+
+Library *consortium_branch(Consortium *consortium, int branch)
+{
+    if (!consortium || branch < 0 || branch >= consortium->num_branches)
+    {
+        fprintf(stderr, "Invalid consortium branch: %d\n", branch);
+        syslog(LOG_ERR, "Invalid consortium branch: %d\n", branch);
+        return NULL;
+    }
+    return consortium->branches[branch];
+}
+
+// Fibonacci hashing spreads runs of consecutive IDs over every branch
+static int hashed_branch(const Consortium *consortium, int ident)
+{
+    uint64_t mixed = (uint64_t)(uint32_t)ident * 0x9E3779B97F4A7C15ULL;
+    return (int)((mixed >> 32) % (uint64_t)consortium->num_branches);
+}
+
+// Checks the branch a caller named; hashing ignores it
+static int can_place(const Consortium *consortium, int branch)
+{
+    if (!consortium ||
+        (consortium->sharding == CONSORTIUM_SHARD_BY_BRANCH &&
+         (branch < 0 || branch >= consortium->num_branches)))
+    {
+        fprintf(stderr, "Invalid consortium branch: %d\n", branch);
+        syslog(LOG_ERR, "Invalid consortium branch: %d\n", branch);
+        return 0;
+    }
+    return 1;
+}
+
+// The ID is taken before the record is placed, so that it can pick the
+// branch and so that branches adding at once never hand out the same one
+static Library *placement(Consortium *consortium, int branch, int ident)
+{
+    if (consortium->sharding == CONSORTIUM_SHARD_BY_HASH)
+    {
+        branch = hashed_branch(consortium, ident);
+    }
+    return consortium->branches[branch];
+}
+
+int consortium_add_book(Consortium *consortium,
+                        int branch,
+                        const char *title,
+                        const char *author,
+                        const char *isbn)
+{
+    if (!can_place(consortium, branch))
+    {
+        return 0;
+    }
+    int ident = id_allocator_next(book_id_allocator());
+    BookRecord record = {title, author, isbn, ident, 0};
+    if (ident == 0 ||
+        add_books_bulk(placement(consortium, branch, ident), &record, 1) != 1)
+    {
+        return 0;
+    }
+    return ident;
+}
+
+int consortium_add_member(Consortium *consortium,
+                          int branch,
+                          const char *name,
+                          const char *email)
+{
+    if (!can_place(consortium, branch))
+    {
+        return 0;
+    }
+    int ident = id_allocator_next(member_id_allocator());
+    if (ident == 0 ||
+        !add_member_with_id(
+            placement(consortium, branch, ident), ident, name, email))
+    {
+        return 0;
+    }
+    return ident;
+}
+
+// Hashed IDs have one branch to look in; named branches are all probed,
+// each under its own lock only
+static int locate(Consortium *consortium, int ident, int is_book)
+{
+    if (!consortium || ident <= 0)
+    {
+        return -1;
+    }
+    int first = 0;
+    int last = consortium->num_branches - 1;
+    if (consortium->sharding == CONSORTIUM_SHARD_BY_HASH)
+    {
+        first = last = hashed_branch(consortium, ident);
+    }
+    for (int i = first; i <= last; i++)
+    {
+        Library *library = consortium->branches[i];
+        library_lock_shared(library);
+        int found = is_book ? find_book_slot(library, ident) >= 0
+                            : find_member_by_id(library, ident) != NULL;
+        library_unlock_shared(library);
+        if (found)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int consortium_book_branch(Consortium *consortium, int book_id)
+{
+    return locate(consortium, book_id, 1);
+}
+
+int consortium_member_branch(Consortium *consortium, int member_id)
+{
+    return locate(consortium, member_id, 0);
+}
+
+int consortium_borrow_book(Consortium *consortium, int member_id, int book_id)
+{
+    int member_branch = locate(consortium, member_id, 0);
+    int book_branch = locate(consortium, book_id, 1);
+    if (member_branch < 0 || book_branch < 0)
+    {
+        fprintf(stderr, "Borrow Book Member or Book ID not in consortium\n");
+        syslog(LOG_ERR, "Borrow Book Member or Book ID not in consortium\n");
+        return 0;
+    }
+    return borrow_book_between(consortium->branches[member_branch],
+                               member_id,
+                               consortium->branches[book_branch],
+                               book_id);
+}
+
+int consortium_return_book(Consortium *consortium, int member_id, int book_id)
+{
+    int member_branch = locate(consortium, member_id, 0);
+    int book_branch = locate(consortium, book_id, 1);
+    if (member_branch < 0 || book_branch < 0)
+    {
+        fprintf(stderr, "Return Book Member or Book ID not in consortium\n");
+        syslog(LOG_ERR, "Return Book Member or Book ID not in consortium\n");
+        return 0;
+    }
+    return return_book_between(consortium->branches[member_branch],
+                               member_id,
+                               consortium->branches[book_branch],
+                               book_id);
+}
+
+typedef struct
+{
+    Consortium *consortium;
+    const char *query;
+    int by_isbn;
+    WorkGroup group;
+    // Lowest available matching ID found at each branch, INT_MAX for none
+    atomic_int best[MAX_CONSORTIUM_BRANCHES];
+} CopySearch;
+
+// Books [begin, end) of one branch; end < 0 stands for the whole branch
+typedef struct
+{
+    CopySearch *search;
+    int branch;
+    int begin;
+    int end;
+} ScanPiece;
+
+static void offer_copy(CopySearch *search, int branch, int ident)
+{
+    int best = atomic_load(&search->best[branch]);
+    while (ident < best &&
+           !atomic_compare_exchange_weak(&search->best[branch], &best, ident))
+    {
+    }
+}
+
+static int same_title(const char *title, const char *query)
+{
+    while (*title && tolower((unsigned char)*title) ==
+                         tolower((unsigned char)*query))
+    {
+        title++;
+        query++;
+    }
+    return *title == *query;
+}
+
+static void scan_books(CopySearch *search, int branch, int begin, int end)
+{
+    Library *library = search->consortium->branches[branch];
+    library_lock_shared(library);
+    // Removals may have shortened the branch since the piece was cut
+    end = end < library->num_books ? end : library->num_books;
+    for (int i = begin; i < end; i++)
+    {
+        const Book *book = &library->books[i];
+        if (book->ident != 0 && atomic_load(&book->is_available) &&
+            same_title(book->title, search->query))
+        {
+            offer_copy(search, branch, book->ident);
+        }
+    }
+    library_unlock_shared(library);
+}
+
+static void find_by_isbn(CopySearch *search, int branch)
+{
+    Library *library = search->consortium->branches[branch];
+    library_lock_shared(library);
+    const Book *book = find_book_by_isbn(library, search->query);
+    if (book && atomic_load(&book->is_available))
+    {
+        offer_copy(search, branch, book->ident);
+    }
+    library_unlock_shared(library);
+}
+
+// Keeps halving its range, handing each upper half to the pool, and scans
+// what is left. The halves sit on this thread's deque, where idle threads
+// steal the largest first.
+static void search_piece(void *context)
+{
+    ScanPiece *piece = (ScanPiece *)context;
+    CopySearch *search = piece->search;
+    if (search->by_isbn)
+    {
+        find_by_isbn(search, piece->branch);
+        free(piece);
+        return;
+    }
+
+    if (piece->end < 0)
+    {
+        Library *library = search->consortium->branches[piece->branch];
+        library_lock_shared(library);
+        piece->end = library->num_books;
+        library_unlock_shared(library);
+    }
+    while (piece->end - piece->begin > CONSORTIUM_SCAN_BOOKS)
+    {
+        int middle = piece->begin + (piece->end - piece->begin) / 2;
+        ScanPiece *upper = (ScanPiece *)malloc(sizeof(ScanPiece));
+        if (!upper)
+        {
+            break;
+        }
+        *upper = (ScanPiece){search, piece->branch, middle, piece->end};
+        work_pool_submit(
+            search->consortium->pool, &search->group, search_piece, upper);
+        piece->end = middle;
+    }
+    scan_books(search, piece->branch, piece->begin, piece->end);
+    free(piece);
+}
+
+int consortium_find_available_copy(Consortium *consortium,
+                                   const char *query,
+                                   int home_branch,
+                                   ConsortiumCopy *copy)
+{
+    if (!consortium || !query || !copy || home_branch < 0 ||
+        home_branch >= consortium->num_branches)
+    {
+        fprintf(stderr, "Invalid parameters for finding a copy\n");
+        syslog(LOG_ERR, "Invalid parameters for finding a copy\n");
+        return 0;
+    }
+
+    CopySearch search;
+    search.consortium = consortium;
+    search.query = query;
+    search.by_isbn = normalize_isbn(query) != 0;
+    atomic_init(&search.group.pending, 0);
+    for (int i = 0; i < consortium->num_branches; i++)
+    {
+        atomic_init(&search.best[i], INT_MAX);
+    }
+
+    for (int i = 0; i < consortium->num_branches; i++)
+    {
+        ScanPiece *piece = (ScanPiece *)malloc(sizeof(ScanPiece));
+        if (piece)
+        {
+            *piece = (ScanPiece){&search, i, 0, -1};
+            work_pool_submit(
+                consortium->pool, &search.group, search_piece, piece);
+        }
+        else if (search.by_isbn)
+        {
+            find_by_isbn(&search, i);
+        }
+        else
+        {
+            scan_books(&search, i, 0, INT_MAX);
+        }
+    }
+    work_group_wait(consortium->pool, &search.group);
+
+    int found = 0;
+    for (int i = 0; !found && i < consortium->num_branches; i++)
+    {
+        int branch = (home_branch + i) % consortium->num_branches;
+        int ident = atomic_load(&search.best[branch]);
+        if (ident != INT_MAX)
+        {
+            copy->branch = branch;
+            copy->book_id = ident;
+            found = 1;
+        }
+    }
+    if (found)
+    {
+        syslog(LOG_INFO,
+               "Found available copy of %s at branch %d with ID: %d\n",
+               query,
+               copy->branch,
+               copy->book_id);
+    }
+    return found;
+}
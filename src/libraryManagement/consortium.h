@@ -0,0 +1,71 @@
+// include/consortium.h
+#ifndef CONSORTIUM_H
+#define CONSORTIUM_H
+
+#include "../include/structures.h"
+
+#define MAX_CONSORTIUM_BRANCHES 256
+
+// How new books and members are spread over the branches
+typedef enum
+{
+    // The caller names the branch, e.g. the one the book was shelved at
+    CONSORTIUM_SHARD_BY_BRANCH = 0,
+    // A hash of the record's ID picks the branch, evening out the load
+    CONSORTIUM_SHARD_BY_HASH
+} ConsortiumSharding;
+
+// A set of branch libraries sharing one ID space. Each branch is an
+// ordinary Library with its own lock (see enable_library_concurrency), so
+// work at one branch never waits on another; cross-branch loans hold just
+// the two branches involved, and cross-branch searches run one task per
+// branch on the consortium's work-stealing pool (see work_stealing.h).
+typedef struct Consortium Consortium;
+
+typedef struct
+{
+    int branch;
+    int book_id;
+} ConsortiumCopy;
+
+// num_threads is the size of the search pool, the caller included; 0
+// means one per online CPU. Release with delete_consortium.
+Consortium *create_consortium(int num_branches,
+                              ConsortiumSharding sharding,
+                              int num_threads);
+void delete_consortium(Consortium *consortium);
+int consortium_branch_count(const Consortium *consortium);
+// The branch's library, for the book, member and library functions
+Library *consortium_branch(Consortium *consortium, int branch);
+
+// Add a record to the given branch, or to the one its ID hashes to when
+// sharding by hash (branch is then ignored). Return the new ID, or 0.
+int consortium_add_book(Consortium *consortium,
+                        int branch,
+                        const char *title,
+                        const char *author,
+                        const char *isbn);
+int consortium_add_member(Consortium *consortium,
+                          int branch,
+                          const char *name,
+                          const char *email);
+// Branch holding the record with the given ID, or -1
+int consortium_book_branch(Consortium *consortium, int book_id);
+int consortium_member_branch(Consortium *consortium, int member_id);
+
+// Loans between any member and any book of the consortium
+int consortium_borrow_book(Consortium *consortium, int member_id, int book_id);
+int consortium_return_book(Consortium *consortium, int member_id, int book_id);
+
+// Finds an available copy anywhere in the consortium of the book whose ISBN
+// is query or, when query is not a valid ISBN, whose title is query
+// (ignoring case). Every branch is searched at once; title scans of large
+// branches are split so idle threads steal their halves. The copy at the
+// first branch from home_branch on (home_branch itself first) wins, and
+// within a branch the lowest ID. Returns 1 and fills copy if one is found.
+int consortium_find_available_copy(Consortium *consortium,
+                                   const char *query,
+                                   int home_branch,
+                                   ConsortiumCopy *copy);
+
+#endif
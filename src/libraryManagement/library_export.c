@@ -0,0 +1,946 @@
+#include "library_export.h"
+#include "../bookManagement/book_import.h"
+#include "../bookManagement/book_management.h"
+#include "../memberManagement/member_management.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EXPORT_BUFFER_SIZE (1 << 20)
+// Bound on one escaped record; the buffer is flushed when less is left
+#define EXPORT_MAX_RECORD 4096
+#define DUMP_BATCH_SIZE 16384
+#define DUMP_BOOK_FIELDS 6
+#define DUMP_MEMBER_FIELDS 4
+#define JSON_MAX_DEPTH 16
+
+typedef struct
+{
+    FILE *file;
+    char *buffer;
+    size_t used;
+    int failed;
+} DumpWriter;
+
+typedef struct
+{
+    long long ident;
+    long long added;
+    char *title;
+    char *author;
+    char *isbn;
+    char *name;
+    char *email;
+    int borrowed[MAX_BORROWED_BOOKS];
+    int num_borrowed;
+} DumpRow;
+
+typedef struct
+{
+    Library *library;
+    DumpFormat format;
+    int skip_line;
+    BookRecord *batch;
+    int num_records;
+    int next_member_id;
+    int added;
+    int malformed;
+} DumpImport;
+
+static int open_writer(DumpWriter *writer, const char *filename)
+{
+    memset(writer, 0, sizeof(DumpWriter));
+    writer->buffer = (char *)malloc(EXPORT_BUFFER_SIZE);
+    if (!writer->buffer)
+    {
+        fprintf(stderr, "Memory allocation failed for export buffer\n");
+        syslog(LOG_ERR, "Memory allocation failed for export buffer\n");
+        return 0;
+    }
+    writer->file = fopen(filename, "wb");
+    if (!writer->file)
+    {
+        fprintf(stderr, "Failed to open file for writing\n");
+        syslog(LOG_ERR, "Failed to open file for writing\n");
+        free(writer->buffer);
+        return 0;
+    }
+    return 1;
+}
+
+static void flush_writer(DumpWriter *writer)
+{
+    if (writer->used > 0 &&
+        fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used)
+    {
+        writer->failed = 1;
+    }
+    writer->used = 0;
+}
+
+static int close_writer(DumpWriter *writer,
+                        int written,
+                        const char *what,
+                        const char *filename)
+{
+    flush_writer(writer);
+    if (fclose(writer->file) != 0)
+    {
+        writer->failed = 1;
+    }
+    free(writer->buffer);
+    if (writer->failed)
+    {
+        fprintf(stderr, "Failed to write %s to %s\n", what, filename);
+        syslog(LOG_ERR, "Failed to write %s to %s\n", what, filename);
+        return -1;
+    }
+    syslog(LOG_INFO, "Exported %d %s to %s\n", written, what, filename);
+    return written;
+}
+
+static void put_char(DumpWriter *writer, char character)
+{
+    writer->buffer[writer->used++] = character;
+}
+
+static void put_text(DumpWriter *writer, const char *text)
+{
+    size_t length = strlen(text);
+    memcpy(&writer->buffer[writer->used], text, length);
+    writer->used += length;
+}
+
+static void put_int(DumpWriter *writer, long long value)
+{
+    char digits[24];
+    int count = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value
+                                             : (unsigned long long)value;
+    do
+    {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (value < 0)
+    {
+        put_char(writer, '-');
+    }
+    while (count > 0)
+    {
+        put_char(writer, digits[--count]);
+    }
+}
+
+// Fields are read up to their array size, so a record never outgrows
+// EXPORT_MAX_RECORD even if a string lost its terminator
+static void put_json_string(DumpWriter *writer,
+                            const char *text,
+                            size_t max_length)
+{
+    static const char hex[] = "0123456789abcdef";
+    put_char(writer, '"');
+    for (size_t i = 0; i < max_length && text[i]; i++)
+    {
+        unsigned char character = (unsigned char)text[i];
+        switch (character)
+        {
+        case '"':
+        case '\\':
+            put_char(writer, '\\');
+            put_char(writer, (char)character);
+            break;
+        case '\n':
+            put_text(writer, "\\n");
+            break;
+        case '\r':
+            put_text(writer, "\\r");
+            break;
+        case '\t':
+            put_text(writer, "\\t");
+            break;
+        default:
+            if (character < 0x20)
+            {
+                put_text(writer, "\\u00");
+                put_char(writer, hex[character >> 4]);
+                put_char(writer, hex[character & 0x0f]);
+            }
+            else
+            {
+                put_char(writer, (char)character);
+            }
+        }
+    }
+    put_char(writer, '"');
+}
+
+static void put_csv_field(DumpWriter *writer,
+                          const char *text,
+                          size_t max_length)
+{
+    size_t length = 0;
+    int quoted = 0;
+    while (length < max_length && text[length])
+    {
+        char character = text[length++];
+        quoted |= character == ',' || character == '"' || character == '\n' ||
+                  character == '\r';
+    }
+
+    if (!quoted)
+    {
+        memcpy(&writer->buffer[writer->used], text, length);
+        writer->used += length;
+        return;
+    }
+    put_char(writer, '"');
+    for (size_t i = 0; i < length; i++)
+    {
+        if (text[i] == '"')
+        {
+            put_char(writer, '"');
+        }
+        put_char(writer, text[i]);
+    }
+    put_char(writer, '"');
+}
+
+static void put_book(DumpWriter *writer, const Book *book, DumpFormat format)
+{
+    if (format == DUMP_CSV)
+    {
+        put_csv_field(writer, book->title, MAX_TITLE_LENGTH);
+        put_char(writer, ',');
+        put_csv_field(writer, book->author, MAX_AUTHOR_LENGTH);
+        put_char(writer, ',');
+        put_csv_field(writer, book->isbn, MAX_ISBN_LENGTH);
+        put_char(writer, ',');
+        put_int(writer, book->ident);
+        put_char(writer, ',');
+        put_int(writer, book->is_available ? 1 : 0);
+        put_char(writer, ',');
+        put_int(writer, (long long)book->added_date);
+    }
+    else
+    {
+        put_text(writer, "{\"id\":");
+        put_int(writer, book->ident);
+        put_text(writer, ",\"title\":");
+        put_json_string(writer, book->title, MAX_TITLE_LENGTH);
+        put_text(writer, ",\"author\":");
+        put_json_string(writer, book->author, MAX_AUTHOR_LENGTH);
+        put_text(writer, ",\"isbn\":");
+        put_json_string(writer, book->isbn, MAX_ISBN_LENGTH);
+        put_text(writer,
+                 book->is_available ? ",\"available\":true,\"added\":"
+                                    : ",\"available\":false,\"added\":");
+        put_int(writer, (long long)book->added_date);
+        put_char(writer, '}');
+    }
+    put_char(writer, '\n');
+}
+
+// Loans may sit in any slot (see borrow_book); empty slots hold 0
+static void put_loans(DumpWriter *writer, const Member *member, char separator)
+{
+    int num_borrowed = member->num_borrowed_books;
+    int written = 0;
+    for (int i = 0; num_borrowed > 0 && num_borrowed <= MAX_BORROWED_BOOKS &&
+                    i < MAX_BORROWED_BOOKS;
+         i++)
+    {
+        int book_id = member->borrowed_books[i];
+        if (book_id == 0)
+        {
+            continue;
+        }
+        if (written++ > 0)
+        {
+            put_char(writer, separator);
+        }
+        put_int(writer, book_id);
+    }
+}
+
+static void put_member(DumpWriter *writer,
+                       const Member *member,
+                       DumpFormat format)
+{
+
+    if (format == DUMP_CSV)
+    {
+        put_csv_field(writer, member->name, MAX_NAME_LENGTH);
+        put_char(writer, ',');
+        put_csv_field(writer, member->email, MAX_EMAIL_LENGTH);
+        put_char(writer, ',');
+        put_int(writer, member->ident);
+        put_char(writer, ',');
+        put_loans(writer, member, ';');
+    }
+    else
+    {
+        put_text(writer, "{\"id\":");
+        put_int(writer, member->ident);
+        put_text(writer, ",\"name\":");
+        put_json_string(writer, member->name, MAX_NAME_LENGTH);
+        put_text(writer, ",\"email\":");
+        put_json_string(writer, member->email, MAX_EMAIL_LENGTH);
+        put_text(writer, ",\"borrowed\":[");
+        put_loans(writer, member, ',');
+        put_text(writer, "]}");
+    }
+    put_char(writer, '\n');
+}
+
+static int valid_dump_arguments(const Library *library,
+                                const char *filename,
+                                DumpFormat format)
+{
+    if (!library || !filename ||
+        (format != DUMP_JSON_LINES && format != DUMP_CSV))
+    {
+        fprintf(stderr, "Invalid parameters for library dump\n");
+        syslog(LOG_ERR, "Invalid parameters for library dump\n");
+        return 0;
+    }
+    return 1;
+}
+
+int export_library_books(const Library *library,
+                         const char *filename,
+                         DumpFormat format)
+{
+    DumpWriter writer;
+    if (!valid_dump_arguments(library, filename, format) ||
+        !open_writer(&writer, filename))
+    {
+        return -1;
+    }
+
+    if (format == DUMP_CSV)
+    {
+        put_text(&writer, "title,author,isbn,id,available,added\n");
+    }
+    int written = 0;
+    for (int i = 0; i < library->num_books && !writer.failed; i++)
+    {
+        if (library->books[i].ident == 0)
+        {
+            continue;
+        }
+        if (EXPORT_BUFFER_SIZE - writer.used < EXPORT_MAX_RECORD)
+        {
+            flush_writer(&writer);
+        }
+        put_book(&writer, &library->books[i], format);
+        written++;
+    }
+    return close_writer(&writer, written, "books", filename);
+}
+
+int export_library_members(const Library *library,
+                           const char *filename,
+                           DumpFormat format)
+{
+    DumpWriter writer;
+    if (!valid_dump_arguments(library, filename, format) ||
+        !open_writer(&writer, filename))
+    {
+        return -1;
+    }
+
+    if (format == DUMP_CSV)
+    {
+        put_text(&writer, "name,email,id,borrowed\n");
+    }
+    int written = 0;
+    for (int i = 0; i < library->num_members && !writer.failed; i++)
+    {
+        if (library->members[i].ident == 0)
+        {
+            continue;
+        }
+        if (EXPORT_BUFFER_SIZE - writer.used < EXPORT_MAX_RECORD)
+        {
+            flush_writer(&writer);
+        }
+        put_member(&writer, &library->members[i], format);
+        written++;
+    }
+    return close_writer(&writer, written, "members", filename);
+}
+
+static char *skip_space(char *cursor)
+{
+    while (*cursor == ' ' || *cursor == '\t')
+    {
+        cursor++;
+    }
+    return cursor;
+}
+
+static int parse_hex4(const char *text, unsigned int *code)
+{
+    *code = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char digit = text[i];
+        unsigned int value = 0;
+        if (digit >= '0' && digit <= '9')
+        {
+            value = (unsigned int)(digit - '0');
+        }
+        else if (digit >= 'a' && digit <= 'f')
+        {
+            value = (unsigned int)(digit - 'a' + 10);
+        }
+        else if (digit >= 'A' && digit <= 'F')
+        {
+            value = (unsigned int)(digit - 'A' + 10);
+        }
+        else
+        {
+            return 0;
+        }
+        *code = *code * 16 + value;
+    }
+    return 1;
+}
+
+static char *put_utf8(char *out, unsigned int code)
+{
+    if (code < 0x80)
+    {
+        *out++ = (char)code;
+    }
+    else if (code < 0x800)
+    {
+        *out++ = (char)(0xc0 | (code >> 6));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+        *out++ = (char)(0xe0 | (code >> 12));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    }
+    else
+    {
+        *out++ = (char)(0xf0 | (code >> 18));
+        *out++ = (char)(0x80 | ((code >> 12) & 0x3f));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    }
+    return out;
+}
+
+// Unescapes a JSON string in place; escapes never decode to more bytes
+// than they occupy, so the text only moves left
+static int parse_json_string(char **cursor, char **value)
+{
+    char *read = skip_space(*cursor);
+    if (*read != '"')
+    {
+        return 0;
+    }
+    read++;
+    char *write = read;
+    *value = write;
+
+    while (*read != '"')
+    {
+        if (*read == '\0')
+        {
+            return 0;
+        }
+        if (*read != '\\')
+        {
+            *write++ = *read++;
+            continue;
+        }
+
+        read++;
+        unsigned int code = 0;
+        unsigned int low = 0;
+        switch (*read)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            *write++ = *read;
+            break;
+        case 'b':
+            *write++ = '\b';
+            break;
+        case 'f':
+            *write++ = '\f';
+            break;
+        case 'n':
+            *write++ = '\n';
+            break;
+        case 'r':
+            *write++ = '\r';
+            break;
+        case 't':
+            *write++ = '\t';
+            break;
+        case 'u':
+            if (!parse_hex4(read + 1, &code))
+            {
+                return 0;
+            }
+            read += 4;
+            if (code >= 0xd800 && code <= 0xdbff && read[1] == '\\' &&
+                read[2] == 'u' && parse_hex4(read + 3, &low) &&
+                low >= 0xdc00 && low <= 0xdfff)
+            {
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                read += 6;
+            }
+            write = put_utf8(write, code);
+            break;
+        default:
+            return 0;
+        }
+        read++;
+    }
+    *write = '\0';
+    *cursor = read + 1;
+    return 1;
+}
+
+static int parse_json_int(char **cursor, long long *value)
+{
+    char *start = skip_space(*cursor);
+    char *end = NULL;
+    *value = strtoll(start, &end, 10);
+    if (end == start)
+    {
+        return 0;
+    }
+    *cursor = end;
+    return 1;
+}
+
+static int skip_json_value(char **cursor, int depth)
+{
+    char *read = skip_space(*cursor);
+    char *ignored = NULL;
+    if (*read == '"')
+    {
+        return parse_json_string(cursor, &ignored);
+    }
+
+    if (*read == '[' || *read == '{')
+    {
+        char close = *read == '[' ? ']' : '}';
+        read = skip_space(read + 1);
+        if (*read == close)
+        {
+            *cursor = read + 1;
+            return 1;
+        }
+        while (depth < JSON_MAX_DEPTH)
+        {
+            if (close == '}')
+            {
+                if (!parse_json_string(&read, &ignored))
+                {
+                    return 0;
+                }
+                read = skip_space(read);
+                if (*read++ != ':')
+                {
+                    return 0;
+                }
+            }
+            if (!skip_json_value(&read, depth + 1))
+            {
+                return 0;
+            }
+            read = skip_space(read);
+            if (*read == close)
+            {
+                *cursor = read + 1;
+                return 1;
+            }
+            if (*read++ != ',')
+            {
+                return 0;
+            }
+        }
+        return 0;
+    }
+
+    // Numbers, true, false and null
+    char *start = read;
+    while (*read && !strchr(",]} \t", *read))
+    {
+        read++;
+    }
+    *cursor = read;
+    return read > start;
+}
+
+static int parse_json_id_array(char **cursor, DumpRow *row)
+{
+    char *read = skip_space(*cursor);
+    if (*read++ != '[')
+    {
+        return 0;
+    }
+    read = skip_space(read);
+    if (*read == ']')
+    {
+        *cursor = read + 1;
+        return 1;
+    }
+
+    while (row->num_borrowed < MAX_BORROWED_BOOKS)
+    {
+        long long ident = 0;
+        if (!parse_json_int(&read, &ident) || ident <= 0 || ident > INT_MAX)
+        {
+            return 0;
+        }
+        row->borrowed[row->num_borrowed++] = (int)ident;
+        read = skip_space(read);
+        if (*read == ']')
+        {
+            *cursor = read + 1;
+            return 1;
+        }
+        if (*read++ != ',')
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+static int parse_json_row(char *line, DumpRow *row)
+{
+    char *cursor = skip_space(line);
+    if (*cursor++ != '{')
+    {
+        return 0;
+    }
+    cursor = skip_space(cursor);
+    if (*cursor == '}')
+    {
+        return 1;
+    }
+
+    while (1)
+    {
+        char *key = NULL;
+        if (!parse_json_string(&cursor, &key))
+        {
+            return 0;
+        }
+        cursor = skip_space(cursor);
+        if (*cursor++ != ':')
+        {
+            return 0;
+        }
+
+        int parsed = 0;
+        if (strcmp(key, "id") == 0)
+        {
+            parsed = parse_json_int(&cursor, &row->ident);
+        }
+        else if (strcmp(key, "added") == 0)
+        {
+            parsed = parse_json_int(&cursor, &row->added);
+        }
+        else if (strcmp(key, "title") == 0)
+        {
+            parsed = parse_json_string(&cursor, &row->title);
+        }
+        else if (strcmp(key, "author") == 0)
+        {
+            parsed = parse_json_string(&cursor, &row->author);
+        }
+        else if (strcmp(key, "isbn") == 0)
+        {
+            parsed = parse_json_string(&cursor, &row->isbn);
+        }
+        else if (strcmp(key, "name") == 0)
+        {
+            parsed = parse_json_string(&cursor, &row->name);
+        }
+        else if (strcmp(key, "email") == 0)
+        {
+            parsed = parse_json_string(&cursor, &row->email);
+        }
+        else if (strcmp(key, "borrowed") == 0)
+        {
+            parsed = parse_json_id_array(&cursor, row);
+        }
+        else
+        {
+            parsed = skip_json_value(&cursor, 0);
+        }
+        if (!parsed)
+        {
+            return 0;
+        }
+
+        cursor = skip_space(cursor);
+        if (*cursor == '}')
+        {
+            return 1;
+        }
+        if (*cursor++ != ',')
+        {
+            return 0;
+        }
+    }
+}
+
+static long long parse_field_int(const char *text)
+{
+    char *end = NULL;
+    long long value = strtoll(text, &end, 10);
+    return end == text ? 0 : value;
+}
+
+static int parse_csv_book(char *line, DumpRow *row)
+{
+    char *fields[DUMP_BOOK_FIELDS];
+    int num_fields = split_delimited_row(line, ',', fields, DUMP_BOOK_FIELDS);
+    if (num_fields < 3)
+    {
+        return 0;
+    }
+    row->title = fields[0];
+    row->author = fields[1];
+    row->isbn = fields[2];
+    row->ident = num_fields > 3 ? parse_field_int(fields[3]) : 0;
+    row->added = num_fields > 5 ? parse_field_int(fields[5]) : 0;
+    return 1;
+}
+
+static int parse_csv_member(char *line, DumpRow *row)
+{
+    char *fields[DUMP_MEMBER_FIELDS];
+    int num_fields =
+        split_delimited_row(line, ',', fields, DUMP_MEMBER_FIELDS);
+    if (num_fields < 2)
+    {
+        return 0;
+    }
+    row->name = fields[0];
+    row->email = fields[1];
+    row->ident = num_fields > 2 ? parse_field_int(fields[2]) : 0;
+
+    const char *cursor = num_fields > 3 ? fields[3] : "";
+    while (*cursor)
+    {
+        char *end = NULL;
+        long long ident = strtoll(cursor, &end, 10);
+        if (end == cursor || ident <= 0 || ident > INT_MAX ||
+            row->num_borrowed == MAX_BORROWED_BOOKS)
+        {
+            return 0;
+        }
+        row->borrowed[row->num_borrowed++] = (int)ident;
+        cursor = *end == ';' ? end + 1 : end;
+    }
+    return 1;
+}
+
+static int parse_row(DumpImport *state, char *line, DumpRow *row, int books)
+{
+    memset(row, 0, sizeof(DumpRow));
+    int parsed = 0;
+    if (state->format == DUMP_JSON_LINES)
+    {
+        parsed = parse_json_row(line, row);
+    }
+    else
+    {
+        parsed = books ? parse_csv_book(line, row)
+                       : parse_csv_member(line, row);
+    }
+    return parsed && row->ident >= 0 && row->ident <= INT_MAX;
+}
+
+// Skips the CSV header and blank lines
+static int skip_line(DumpImport *state, const char *line)
+{
+    if (state->skip_line)
+    {
+        state->skip_line = 0;
+        return 1;
+    }
+    return line[0] == '\0';
+}
+
+static int flush_books(void *context)
+{
+    DumpImport *state = (DumpImport *)context;
+    if (state->num_records == 0)
+    {
+        return 1;
+    }
+    int added =
+        add_books_bulk(state->library, state->batch, state->num_records);
+    state->num_records = 0;
+    if (added < 0)
+    {
+        return 0;
+    }
+    state->added += added;
+    return 1;
+}
+
+static int import_book_line(void *context, char *line)
+{
+    DumpImport *state = (DumpImport *)context;
+    if (skip_line(state, line))
+    {
+        return 1;
+    }
+
+    DumpRow row;
+    if (!parse_row(state, line, &row, 1) || !row.title || !row.author ||
+        !row.isbn)
+    {
+        state->malformed++;
+        return 1;
+    }
+
+    BookRecord *record = &state->batch[state->num_records++];
+    record->title = row.title;
+    record->author = row.author;
+    record->isbn = row.isbn;
+    record->ident = (int)row.ident;
+    record->added_date = (time_t)row.added;
+    return state->num_records < DUMP_BATCH_SIZE || flush_books(state);
+}
+
+static int import_member_line(void *context, char *line)
+{
+    DumpImport *state = (DumpImport *)context;
+    if (skip_line(state, line))
+    {
+        return 1;
+    }
+
+    DumpRow row;
+    if (!parse_row(state, line, &row, 0) || !row.name || !row.email)
+    {
+        state->malformed++;
+        return 1;
+    }
+
+    // Rows without an ID continue after the highest one seen so far
+    int ident = row.ident > 0 ? (int)row.ident : state->next_member_id;
+    if (find_member_by_id(state->library, ident))
+    {
+        return 1;
+    }
+    set_next_member_id(ident);
+    if (!add_member_to_library(state->library, row.name, row.email))
+    {
+        return 1;
+    }
+    if (ident >= state->next_member_id)
+    {
+        state->next_member_id = ident + 1;
+    }
+    state->added++;
+
+    for (int i = 0; i < row.num_borrowed; i++)
+    {
+        if (!borrow_book(state->library, ident, row.borrowed[i]))
+        {
+            fprintf(stderr,
+                    "Loan of book %d to member %d could not be restored\n",
+                    row.borrowed[i],
+                    ident);
+        }
+    }
+    return 1;
+}
+
+static int nothing_buffered(void *context)
+{
+    (void)context;
+    return 1;
+}
+
+static int import_dump(DumpImport *state, const char *filename, int books)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open file for reading\n");
+        syslog(LOG_ERR, "Failed to open file for reading\n");
+        return -1;
+    }
+
+    int ok = books ? stream_lines(file, import_book_line, flush_books, state)
+                   : stream_lines(file,
+                                  import_member_line,
+                                  nothing_buffered,
+                                  state);
+    fclose(file);
+    syslog(LOG_INFO,
+           "Imported %d %s from %s (%d malformed rows)\n",
+           state->added,
+           books ? "books" : "members",
+           filename,
+           state->malformed);
+    return ok ? state->added : -1;
+}
+
+int import_library_books(Library *library,
+                         const char *filename,
+                         DumpFormat format)
+{
+    if (!valid_dump_arguments(library, filename, format))
+    {
+        return -1;
+    }
+
+    DumpImport state = {0};
+    state.library = library;
+    state.format = format;
+    state.skip_line = format == DUMP_CSV;
+    state.batch = (BookRecord *)malloc(DUMP_BATCH_SIZE * sizeof(BookRecord));
+    if (!state.batch)
+    {
+        fprintf(stderr, "Memory allocation failed for book import\n");
+        syslog(LOG_ERR, "Memory allocation failed for book import\n");
+        return -1;
+    }
+
+    int added = import_dump(&state, filename, 1);
+    free(state.batch);
+    return added;
+}
+
+int import_library_members(Library *library,
+                           const char *filename,
+                           DumpFormat format)
+{
+    if (!valid_dump_arguments(library, filename, format))
+    {
+        return -1;
+    }
+
+    DumpImport state = {0};
+    state.library = library;
+    state.format = format;
+    state.skip_line = format == DUMP_CSV;
+    state.next_member_id = get_next_member_id();
+
+    int added = import_dump(&state, filename, 0);
+    set_next_member_id(state.next_member_id);
+    return added;
+}
@@ -0,0 +1,42 @@
+// include/library_export.h
+#ifndef LIBRARY_EXPORT_H
+#define LIBRARY_EXPORT_H
+
+#include "../include/structures.h"
+
+// Text dumps for other systems, one record per line:
+//   JSON Lines  {"id":1,"title":"...","author":"...","isbn":"...",
+//                "available":true,"added":1700000000}
+//               {"id":1,"name":"...","email":"...","borrowed":[2,5]}
+//   CSV         title,author,isbn,id,available,added
+//               name,email,id,borrowed   (borrowed = "2;5")
+// with a header row. Book CSV starts with the columns
+// import_books_from_file reads, so either importer accepts it.
+typedef enum
+{
+    DUMP_JSON_LINES = 0,
+    DUMP_CSV
+} DumpFormat;
+
+// Exports stream through a 1 MiB buffer and escape in place, so memory use
+// does not depend on the library size. They return the number of records
+// written, or -1 on error.
+int export_library_books(const Library *library,
+                         const char *filename,
+                         DumpFormat format);
+int export_library_members(const Library *library,
+                           const char *filename,
+                           DumpFormat format);
+
+// Imports keep the IDs and added dates found in the dump; records whose ID
+// is already taken are skipped. Loans are restored from the members' borrowed
+// lists, so import books before members. Return the number of records
+// added, or -1 if the file could not be read.
+int import_library_books(Library *library,
+                         const char *filename,
+                         DumpFormat format);
+int import_library_members(Library *library,
+                           const char *filename,
+                           DumpFormat format);
+
+#endif
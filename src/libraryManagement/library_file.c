@@ -0,0 +1,1768 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "library_file.h"
+#include "../bookManagement/book_management.h"
+#include "../indexManagement/author_dictionary.h"
+#include "../indexManagement/block_compress.h"
+#include "../indexManagement/crc32.h"
+#include "../indexManagement/hash_index.h"
+#include "../indexManagement/token_index.h"
+#include "../memberManagement/member_management.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#define BOOK_IDENT_OFFSET 0
+#define BOOK_TITLE_OFFSET 4
+#define BOOK_AUTHOR_OFFSET 104
+#define BOOK_ISBN_OFFSET 204
+#define BOOK_AVAILABLE_OFFSET 224
+#define BOOK_ADDED_DATE_OFFSET 232
+#define BOOK_AUTHOR_ID_OFFSET 240
+
+#define MEMBER_IDENT_OFFSET 0
+#define MEMBER_NAME_OFFSET 4
+#define MEMBER_EMAIL_OFFSET 54
+#define MEMBER_BORROWED_OFFSET 156
+#define MEMBER_NUM_BORROWED_OFFSET 176
+
+#define RECORDS_PER_CHUNK 64
+#define INDEX_ENTRIES_PER_CHUNK 512
+#define TEXT_INDEX_CHUNK 4096
+
+#define BLOCK_HEADER_SIZE 8
+// Larger than any packed book or member
+#define PACKED_RECORD_MAX 512
+
+static void put_u16(unsigned char *out, uint16_t value)
+{
+    out[0] = (unsigned char)(value & 0xFFU);
+    out[1] = (unsigned char)(value >> 8);
+}
+
+static void put_u32(unsigned char *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = (unsigned char)((value >> (8 * i)) & 0xFFU);
+    }
+}
+
+static void put_u64(unsigned char *out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = (unsigned char)((value >> (8 * i)) & 0xFFU);
+    }
+}
+
+static uint16_t get_u16(const unsigned char *in)
+{
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t get_u32(const unsigned char *in)
+{
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--)
+    {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+static uint64_t get_u64(const unsigned char *in)
+{
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+// Copies the string and zero-fills the rest of the field, so records never
+// carry stale bytes from behind the terminator
+static void put_string(unsigned char *out, const char *text, size_t size)
+{
+    const char *end = memchr(text, '\0', size);
+    size_t length = end ? (size_t)(end - text) : size - 1;
+    memcpy(out, text, length);
+    memset(out + length, 0, size - length);
+}
+
+static void get_string(const unsigned char *in, char *text, size_t size)
+{
+    memcpy(text, in, size);
+    text[size - 1] = '\0';
+}
+
+void encode_book_record(const Book *book, unsigned char *record)
+{
+    memset(record, 0, BOOK_RECORD_SIZE);
+    put_u32(record + BOOK_IDENT_OFFSET, (uint32_t)book->ident);
+    put_string(record + BOOK_TITLE_OFFSET, book->title, MAX_TITLE_LENGTH);
+    put_string(record + BOOK_AUTHOR_OFFSET, book->author, MAX_AUTHOR_LENGTH);
+    put_string(record + BOOK_ISBN_OFFSET, book->isbn, MAX_ISBN_LENGTH);
+    put_u32(record + BOOK_AVAILABLE_OFFSET, (uint32_t)book->is_available);
+    put_u64(record + BOOK_ADDED_DATE_OFFSET, (uint64_t)book->added_date);
+    put_u32(record + BOOK_AUTHOR_ID_OFFSET, book->author_id);
+}
+
+void decode_book_record(const unsigned char *record, Book *book)
+{
+    memset(book, 0, sizeof(Book));
+    book->ident = (int)get_u32(record + BOOK_IDENT_OFFSET);
+    get_string(record + BOOK_TITLE_OFFSET, book->title, MAX_TITLE_LENGTH);
+    get_string(record + BOOK_AUTHOR_OFFSET, book->author, MAX_AUTHOR_LENGTH);
+    get_string(record + BOOK_ISBN_OFFSET, book->isbn, MAX_ISBN_LENGTH);
+    book->is_available = (int)get_u32(record + BOOK_AVAILABLE_OFFSET);
+    book->added_date =
+        (time_t)(int64_t)get_u64(record + BOOK_ADDED_DATE_OFFSET);
+    book->author_id = get_u32(record + BOOK_AUTHOR_ID_OFFSET);
+}
+
+void encode_member_record(const Member *member, unsigned char *record)
+{
+    memset(record, 0, MEMBER_RECORD_SIZE);
+    put_u32(record + MEMBER_IDENT_OFFSET, (uint32_t)member->ident);
+    put_string(record + MEMBER_NAME_OFFSET, member->name, MAX_NAME_LENGTH);
+    put_string(record + MEMBER_EMAIL_OFFSET, member->email, MAX_EMAIL_LENGTH);
+    for (int i = 0; i < MAX_BORROWED_BOOKS; i++)
+    {
+        put_u32(record + MEMBER_BORROWED_OFFSET + 4 * i,
+                (uint32_t)member->borrowed_books[i]);
+    }
+    put_u32(record + MEMBER_NUM_BORROWED_OFFSET,
+            (uint32_t)member->num_borrowed_books);
+}
+
+void decode_member_record(const unsigned char *record, Member *member)
+{
+    memset(member, 0, sizeof(Member));
+    member->ident = (int)get_u32(record + MEMBER_IDENT_OFFSET);
+    get_string(record + MEMBER_NAME_OFFSET, member->name, MAX_NAME_LENGTH);
+    get_string(record + MEMBER_EMAIL_OFFSET, member->email, MAX_EMAIL_LENGTH);
+    for (int i = 0; i < MAX_BORROWED_BOOKS; i++)
+    {
+        member->borrowed_books[i] =
+            (int)get_u32(record + MEMBER_BORROWED_OFFSET + 4 * i);
+    }
+    member->num_borrowed_books =
+        (int)get_u32(record + MEMBER_NUM_BORROWED_OFFSET);
+}
+
+typedef struct
+{
+    int64_t previous_ident;
+    int64_t previous_date;
+} PackState;
+
+static size_t put_varint(unsigned char *out, uint64_t value)
+{
+    size_t length = 0;
+    while (value >= 0x80)
+    {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+    return length;
+}
+
+static int get_varint(const unsigned char **in,
+                      const unsigned char *end,
+                      uint64_t *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64 && *in < end; shift += 7)
+    {
+        unsigned char byte = *(*in)++;
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static size_t put_packed_string(unsigned char *out,
+                                const char *text,
+                                size_t size)
+{
+    const char *end = memchr(text, '\0', size);
+    size_t length = end ? (size_t)(end - text) : size - 1;
+    size_t header = put_varint(out, length);
+    memcpy(out + header, text, length);
+    return header + length;
+}
+
+static int get_packed_string(const unsigned char **in,
+                             const unsigned char *end,
+                             char *text,
+                             size_t size)
+{
+    uint64_t length = 0;
+    if (!get_varint(in, end, &length) || length >= size ||
+        length > (uint64_t)(end - *in))
+    {
+        return 0;
+    }
+    memcpy(text, *in, (size_t)length);
+    memset(text + length, 0, size - (size_t)length);
+    *in += length;
+    return 1;
+}
+
+static size_t pack_ident_and_date(unsigned char *out,
+                                  PackState *state,
+                                  int ident,
+                                  int64_t date)
+{
+    size_t length = put_varint(out, zigzag(ident - state->previous_ident));
+    length += put_varint(out + length, zigzag(date - state->previous_date));
+    state->previous_ident = ident;
+    state->previous_date = date;
+    return length;
+}
+
+static size_t pack_book(const Book *book, PackState *state, unsigned char *out)
+{
+    size_t length = pack_ident_and_date(
+        out, state, book->ident, (int64_t)book->added_date);
+    out[length++] = book->is_available ? 1 : 0;
+    length += put_packed_string(out + length, book->title, MAX_TITLE_LENGTH);
+    length += put_packed_string(out + length, book->author, MAX_AUTHOR_LENGTH);
+    length += put_packed_string(out + length, book->isbn, MAX_ISBN_LENGTH);
+    return length;
+}
+
+static size_t pack_member(const Member *member,
+                          PackState *state,
+                          unsigned char *out)
+{
+    size_t length = pack_ident_and_date(out, state, member->ident, 0);
+    length += put_packed_string(out + length, member->name, MAX_NAME_LENGTH);
+    length +=
+        put_packed_string(out + length, member->email, MAX_EMAIL_LENGTH);
+    // Loans may sit in any slot; they are packed to the front
+    int loans[MAX_BORROWED_BOOKS];
+    int num_loans = 0;
+    int num_borrowed = member->num_borrowed_books;
+    for (int i = 0; num_borrowed > 0 && num_borrowed <= MAX_BORROWED_BOOKS &&
+                    i < MAX_BORROWED_BOOKS;
+         i++)
+    {
+        if (member->borrowed_books[i] != 0)
+        {
+            loans[num_loans++] = member->borrowed_books[i];
+        }
+    }
+    out[length++] = (unsigned char)num_loans;
+    for (int i = 0; i < num_loans; i++)
+    {
+        length += put_varint(out + length, (uint32_t)loans[i]);
+    }
+    return length;
+}
+
+static int unpack_ident_and_date(const unsigned char **in,
+                                 const unsigned char *end,
+                                 PackState *state,
+                                 int *ident,
+                                 int64_t *date)
+{
+    uint64_t ident_delta = 0;
+    uint64_t date_delta = 0;
+    if (!get_varint(in, end, &ident_delta) ||
+        !get_varint(in, end, &date_delta))
+    {
+        return 0;
+    }
+    state->previous_ident += unzigzag(ident_delta);
+    state->previous_date += unzigzag(date_delta);
+    if (state->previous_ident <= 0 || state->previous_ident > INT32_MAX)
+    {
+        return 0;
+    }
+    *ident = (int)state->previous_ident;
+    *date = state->previous_date;
+    return 1;
+}
+
+static int unpack_book(const unsigned char **in,
+                       const unsigned char *end,
+                       PackState *state,
+                       void *records,
+                       uint32_t index)
+{
+    Book *book = &((Book *)records)[index];
+    int64_t date = 0;
+    memset(book, 0, sizeof(Book));
+    if (!unpack_ident_and_date(in, end, state, &book->ident, &date) ||
+        *in >= end)
+    {
+        return 0;
+    }
+    book->added_date = (time_t)date;
+    book->is_available = *(*in)++ != 0;
+    book->author_id = NO_AUTHOR_ID;
+    return get_packed_string(in, end, book->title, MAX_TITLE_LENGTH) &&
+           get_packed_string(in, end, book->author, MAX_AUTHOR_LENGTH) &&
+           get_packed_string(in, end, book->isbn, MAX_ISBN_LENGTH);
+}
+
+static int unpack_member(const unsigned char **in,
+                         const unsigned char *end,
+                         PackState *state,
+                         void *records,
+                         uint32_t index)
+{
+    Member *member = &((Member *)records)[index];
+    int64_t date = 0;
+    memset(member, 0, sizeof(Member));
+    if (!unpack_ident_and_date(in, end, state, &member->ident, &date) ||
+        !get_packed_string(in, end, member->name, MAX_NAME_LENGTH) ||
+        !get_packed_string(in, end, member->email, MAX_EMAIL_LENGTH) ||
+        *in >= end)
+    {
+        return 0;
+    }
+    member->num_borrowed_books = *(*in)++;
+    if (member->num_borrowed_books > MAX_BORROWED_BOOKS)
+    {
+        return 0;
+    }
+    for (int i = 0; i < member->num_borrowed_books; i++)
+    {
+        uint64_t book_id = 0;
+        if (!get_varint(in, end, &book_id) || book_id > INT32_MAX)
+        {
+            return 0;
+        }
+        member->borrowed_books[i] = (int)book_id;
+    }
+    return 1;
+}
+
+typedef struct
+{
+    FILE *file;
+    uint64_t position;
+    uint32_t crc;
+    int ok;
+} SectionWriter;
+
+static void write_bytes(SectionWriter *writer, const void *data, size_t length)
+{
+    if (!writer->ok || length == 0)
+    {
+        return;
+    }
+    writer->ok = fwrite(data, 1, length, writer->file) == length;
+    writer->crc = crc32_update(writer->crc, data, length);
+    writer->position += length;
+}
+
+static void begin_section(SectionWriter *writer,
+                          SectionEntry *entry,
+                          SectionType type,
+                          uint32_t record_size)
+{
+    static const unsigned char padding[LIBRARY_FILE_ALIGNMENT] = {0};
+    size_t misalignment = (size_t)(writer->position % LIBRARY_FILE_ALIGNMENT);
+    if (misalignment)
+    {
+        write_bytes(writer, padding, LIBRARY_FILE_ALIGNMENT - misalignment);
+    }
+    memset(entry, 0, sizeof(SectionEntry));
+    entry->type = (uint32_t)type;
+    entry->record_size = record_size;
+    entry->offset = writer->position;
+    writer->crc = 0;
+}
+
+static void end_section(SectionWriter *writer, SectionEntry *entry)
+{
+    entry->crc = writer->crc;
+    entry->length = writer->position - entry->offset;
+}
+
+typedef struct
+{
+    PageSummary *pages;
+    uint32_t num_pages;
+    uint32_t in_page;
+} PageIndex;
+
+static int open_page_index(PageIndex *index, int num_records)
+{
+    size_t capacity = ((size_t)num_records + LIBRARY_FILE_PAGE_RECORDS - 1) /
+                      LIBRARY_FILE_PAGE_RECORDS;
+    index->pages = (PageSummary *)calloc(capacity ? capacity : 1,
+                                         sizeof(PageSummary));
+    index->num_pages = 0;
+    index->in_page = 0;
+    return index->pages != NULL;
+}
+
+static void add_to_page_index(PageIndex *index,
+                              int ident,
+                              int tally,
+                              const unsigned char *record,
+                              size_t record_size)
+{
+    if (index->in_page == 0)
+    {
+        PageSummary *page = &index->pages[index->num_pages++];
+        page->min_ident = UINT32_MAX;
+    }
+    PageSummary *page = &index->pages[index->num_pages - 1];
+    page->min_ident =
+        (uint32_t)ident < page->min_ident ? (uint32_t)ident : page->min_ident;
+    page->max_ident =
+        (uint32_t)ident > page->max_ident ? (uint32_t)ident : page->max_ident;
+    page->tally += (uint32_t)tally;
+    page->crc = crc32_update(page->crc, record, record_size);
+    index->in_page = (index->in_page + 1) % LIBRARY_FILE_PAGE_RECORDS;
+}
+
+static void write_page_index_section(SectionWriter *writer,
+                                     const PageIndex *index,
+                                     SectionType type,
+                                     SectionEntry *entry)
+{
+    begin_section(writer, entry, type, PAGE_SUMMARY_SIZE);
+    for (uint32_t i = 0; i < index->num_pages; i++)
+    {
+        unsigned char record[PAGE_SUMMARY_SIZE];
+        put_u32(record, index->pages[i].min_ident);
+        put_u32(record + 4, index->pages[i].max_ident);
+        put_u32(record + 8, index->pages[i].tally);
+        put_u32(record + 12, index->pages[i].crc);
+        write_bytes(writer, record, sizeof(record));
+        entry->count++;
+    }
+    end_section(writer, entry);
+}
+
+static void write_books_section(SectionWriter *writer,
+                                const Library *library,
+                                SectionEntry *entry,
+                                PageIndex *pages)
+{
+    unsigned char chunk[RECORDS_PER_CHUNK * BOOK_RECORD_SIZE];
+    size_t filled = 0;
+    begin_section(writer, entry, SECTION_BOOKS, BOOK_RECORD_SIZE);
+    for (int i = 0; i < library->num_books; i++)
+    {
+        const Book *book = &library->books[i];
+        if (book->ident == 0)
+        {
+            continue;
+        }
+        unsigned char *record = chunk + filled * BOOK_RECORD_SIZE;
+        encode_book_record(book, record);
+        add_to_page_index(
+            pages, book->ident, book->is_available, record, BOOK_RECORD_SIZE);
+        entry->count++;
+        if (++filled == RECORDS_PER_CHUNK)
+        {
+            write_bytes(writer, chunk, filled * BOOK_RECORD_SIZE);
+            filled = 0;
+        }
+    }
+    write_bytes(writer, chunk, filled * BOOK_RECORD_SIZE);
+    end_section(writer, entry);
+}
+
+static void write_members_section(SectionWriter *writer,
+                                  const Library *library,
+                                  SectionEntry *entry,
+                                  PageIndex *pages)
+{
+    unsigned char chunk[RECORDS_PER_CHUNK * MEMBER_RECORD_SIZE];
+    size_t filled = 0;
+    begin_section(writer, entry, SECTION_MEMBERS, MEMBER_RECORD_SIZE);
+    for (int i = 0; i < library->num_members; i++)
+    {
+        const Member *member = &library->members[i];
+        if (member->ident == 0)
+        {
+            continue;
+        }
+        unsigned char *record = chunk + filled * MEMBER_RECORD_SIZE;
+        encode_member_record(member, record);
+        add_to_page_index(pages,
+                          member->ident,
+                          member->num_borrowed_books,
+                          record,
+                          MEMBER_RECORD_SIZE);
+        entry->count++;
+        if (++filled == RECORDS_PER_CHUNK)
+        {
+            write_bytes(writer, chunk, filled * MEMBER_RECORD_SIZE);
+            filled = 0;
+        }
+    }
+    write_bytes(writer, chunk, filled * MEMBER_RECORD_SIZE);
+    end_section(writer, entry);
+}
+
+typedef struct
+{
+    SectionWriter *writer;
+    unsigned char *raw;
+    unsigned char *stored;
+    size_t used;
+} BlockWriter;
+
+static int open_block_writer(BlockWriter *blocks, SectionWriter *writer)
+{
+    blocks->writer = writer;
+    blocks->used = 0;
+    blocks->raw = (unsigned char *)malloc(BLOCK_COMPRESS_MAX_INPUT);
+    blocks->stored = (unsigned char *)malloc(BLOCK_COMPRESS_MAX_INPUT);
+    if (!blocks->raw || !blocks->stored)
+    {
+        free(blocks->raw);
+        free(blocks->stored);
+        writer->ok = 0;
+        return 0;
+    }
+    return 1;
+}
+
+static void flush_block(BlockWriter *blocks)
+{
+    if (blocks->used == 0)
+    {
+        return;
+    }
+    // Only keep the compressed form when it is strictly smaller, so equal
+    // lengths can mean "stored as is"
+    size_t packed = block_compress(
+        blocks->raw, blocks->used, blocks->stored, blocks->used - 1);
+    unsigned char header[BLOCK_HEADER_SIZE];
+    put_u32(header, (uint32_t)blocks->used);
+    put_u32(header + 4, (uint32_t)(packed ? packed : blocks->used));
+    write_bytes(blocks->writer, header, sizeof(header));
+    write_bytes(blocks->writer,
+                packed ? blocks->stored : blocks->raw,
+                packed ? packed : blocks->used);
+    blocks->used = 0;
+}
+
+static unsigned char *reserve_record(BlockWriter *blocks)
+{
+    if (BLOCK_COMPRESS_MAX_INPUT - blocks->used < PACKED_RECORD_MAX)
+    {
+        flush_block(blocks);
+    }
+    return blocks->raw + blocks->used;
+}
+
+static void close_block_writer(BlockWriter *blocks)
+{
+    flush_block(blocks);
+    free(blocks->raw);
+    free(blocks->stored);
+}
+
+static void write_packed_books_section(SectionWriter *writer,
+                                       const Library *library,
+                                       SectionEntry *entry)
+{
+    BlockWriter blocks;
+    PackState state = {0, 0};
+    begin_section(writer, entry, SECTION_BOOKS_PACKED, 0);
+    if (!open_block_writer(&blocks, writer))
+    {
+        return;
+    }
+    for (int i = 0; i < library->num_books; i++)
+    {
+        if (library->books[i].ident == 0)
+        {
+            continue;
+        }
+        unsigned char *out = reserve_record(&blocks);
+        blocks.used += pack_book(&library->books[i], &state, out);
+        entry->count++;
+    }
+    close_block_writer(&blocks);
+    end_section(writer, entry);
+}
+
+static void write_packed_members_section(SectionWriter *writer,
+                                         const Library *library,
+                                         SectionEntry *entry)
+{
+    BlockWriter blocks;
+    PackState state = {0, 0};
+    begin_section(writer, entry, SECTION_MEMBERS_PACKED, 0);
+    if (!open_block_writer(&blocks, writer))
+    {
+        return;
+    }
+    for (int i = 0; i < library->num_members; i++)
+    {
+        if (library->members[i].ident == 0)
+        {
+            continue;
+        }
+        unsigned char *out = reserve_record(&blocks);
+        blocks.used += pack_member(&library->members[i], &state, out);
+        entry->count++;
+    }
+    close_block_writer(&blocks);
+    end_section(writer, entry);
+}
+
+// Names in ID order, each as a u16 length followed by its bytes, so that a
+// reloaded dictionary hands out the same IDs
+static void write_authors_section(SectionWriter *writer,
+                                  const AuthorDictionary *authors,
+                                  SectionEntry *entry)
+{
+    begin_section(writer, entry, SECTION_AUTHORS, 0);
+    for (uint32_t id = 1; id <= (uint32_t)authors->num_names; id++)
+    {
+        const char *name = author_dictionary_name(authors, id);
+        unsigned char length[2];
+        put_u16(length, (uint16_t)strlen(name));
+        write_bytes(writer, length, sizeof(length));
+        write_bytes(writer, name, strlen(name));
+        entry->count++;
+    }
+    end_section(writer, entry);
+}
+
+static void write_meta_section(SectionWriter *writer,
+                               const Library *library,
+                               SectionEntry *entry)
+{
+    unsigned char record[META_RECORD_SIZE];
+    put_u64(record, library->journal_lsn);
+    begin_section(writer, entry, SECTION_META, META_RECORD_SIZE);
+    write_bytes(writer, record, sizeof(record));
+    entry->count = 1;
+    end_section(writer, entry);
+}
+
+// Never below the IDs actually in the library, in case the allocators were
+// reset after they were handed out
+static void write_id_marks_section(SectionWriter *writer,
+                                   const Library *library,
+                                   SectionEntry *entry)
+{
+    int next_book = id_allocator_peek(book_id_allocator());
+    int next_member = id_allocator_peek(member_id_allocator());
+    for (int i = 0; i < library->num_books; i++)
+    {
+        next_book = library->books[i].ident >= next_book
+                        ? library->books[i].ident + 1
+                        : next_book;
+    }
+    for (int i = 0; i < library->num_members; i++)
+    {
+        next_member = library->members[i].ident >= next_member
+                          ? library->members[i].ident + 1
+                          : next_member;
+    }
+
+    unsigned char record[ID_MARKS_RECORD_SIZE];
+    put_u32(record, (uint32_t)next_book);
+    put_u32(record + 4, (uint32_t)next_member);
+    begin_section(writer, entry, SECTION_ID_MARKS, ID_MARKS_RECORD_SIZE);
+    write_bytes(writer, record, sizeof(record));
+    entry->count = 1;
+    end_section(writer, entry);
+}
+
+static void write_generation_section(SectionWriter *writer,
+                                     uint64_t generation,
+                                     SectionEntry *entry)
+{
+    unsigned char record[GENERATION_RECORD_SIZE];
+    put_u64(record, generation);
+    begin_section(writer, entry, SECTION_GENERATION, GENERATION_RECORD_SIZE);
+    write_bytes(writer, record, sizeof(record));
+    entry->count = 1;
+    end_section(writer, entry);
+}
+
+static void encode_index_stamp(const IndexStamp *stamp, unsigned char *record)
+{
+    memset(record, 0, INDEX_STAMP_SIZE);
+    put_u64(record, stamp->generation);
+    put_u32(record + 8, stamp->source_type);
+    put_u32(record + 12, stamp->source_count);
+    put_u32(record + 16, stamp->source_crc);
+    put_u32(record + 20, stamp->capacity);
+    put_u32(record + 24, stamp->count);
+}
+
+static void begin_index_section(SectionWriter *writer,
+                                SectionEntry *entry,
+                                SectionType type,
+                                const SectionEntry *source,
+                                uint64_t generation,
+                                uint32_t capacity,
+                                uint32_t count)
+{
+    IndexStamp stamp = {
+        generation, source->type, source->count, source->crc, capacity, count};
+    unsigned char record[INDEX_STAMP_SIZE];
+    encode_index_stamp(&stamp, record);
+    begin_section(writer, entry, type, 0);
+    write_bytes(writer, record, sizeof(record));
+    entry->count = count;
+}
+
+static void write_hash_index_section(SectionWriter *writer,
+                                     const HashIndex *index,
+                                     SectionType type,
+                                     const SectionEntry *source,
+                                     uint64_t generation,
+                                     SectionEntry *entry)
+{
+    begin_index_section(writer,
+                        entry,
+                        type,
+                        source,
+                        generation,
+                        (uint32_t)index->capacity,
+                        (uint32_t)index->count);
+    unsigned char chunk[INDEX_ENTRIES_PER_CHUNK * 8];
+    for (int done = 0; done < index->capacity; done += INDEX_ENTRIES_PER_CHUNK)
+    {
+        int batch = index->capacity - done < INDEX_ENTRIES_PER_CHUNK
+                        ? index->capacity - done
+                        : INDEX_ENTRIES_PER_CHUNK;
+        for (int i = 0; i < batch; i++)
+        {
+            put_u64(chunk + i * 8, index->keys[done + i]);
+        }
+        write_bytes(writer, chunk, (size_t)batch * 8);
+    }
+    for (int done = 0; done < index->capacity; done += INDEX_ENTRIES_PER_CHUNK)
+    {
+        int batch = index->capacity - done < INDEX_ENTRIES_PER_CHUNK
+                        ? index->capacity - done
+                        : INDEX_ENTRIES_PER_CHUNK;
+        for (int i = 0; i < batch; i++)
+        {
+            put_u32(chunk + i * 4, (uint32_t)index->values[done + i]);
+        }
+        write_bytes(writer, chunk, (size_t)batch * 4);
+    }
+    end_section(writer, entry);
+}
+
+// Tokens whose posting list emptied are dropped
+static void write_text_index_section(SectionWriter *writer,
+                                     const TokenIndex *index,
+                                     const SectionEntry *source,
+                                     uint64_t generation,
+                                     SectionEntry *entry)
+{
+    uint32_t count = 0;
+    for (int i = 0; i < index->capacity; i++)
+    {
+        count += index->tokens[i] && index->postings[i].count > 0;
+    }
+    begin_index_section(writer,
+                        entry,
+                        SECTION_TEXT_INDEX,
+                        source,
+                        generation,
+                        (uint32_t)index->capacity,
+                        count);
+
+    unsigned char chunk[TEXT_INDEX_CHUNK];
+    size_t filled = 0;
+    for (int i = 0; i < index->capacity; i++)
+    {
+        const PostingList *list = &index->postings[i];
+        if (!index->tokens[i] || list->count == 0)
+        {
+            continue;
+        }
+        if (filled > sizeof(chunk) - (MAX_TOKEN_LENGTH + 20))
+        {
+            write_bytes(writer, chunk, filled);
+            filled = 0;
+        }
+        size_t length = strlen(index->tokens[i]);
+        filled += put_varint(chunk + filled, length);
+        memcpy(chunk + filled, index->tokens[i], length);
+        filled += length;
+        filled += put_varint(chunk + filled, (uint64_t)list->count);
+        int previous = 0;
+        for (int j = 0; j < list->count; j++)
+        {
+            if (filled > sizeof(chunk) - 10)
+            {
+                write_bytes(writer, chunk, filled);
+                filled = 0;
+            }
+            filled += put_varint(chunk + filled,
+                                 (uint64_t)(list->ids[j] - previous));
+            previous = list->ids[j];
+        }
+    }
+    write_bytes(writer, chunk, filled);
+    end_section(writer, entry);
+}
+
+// The in-memory ID indexes map IDs to array slots, which are positions in
+// the file only while no slot is tombstoned; otherwise map them afresh
+static const HashIndex *book_slots_in_file(const Library *library,
+                                           HashIndex *scratch)
+{
+    if (library->num_free_books == 0 &&
+        hash_index_is_built(&library->book_index))
+    {
+        return &library->book_index;
+    }
+    if (!hash_index_init(scratch, count_books(library)))
+    {
+        return NULL;
+    }
+    int position = 0;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        int ident = library->books[i].ident;
+        if (ident != 0 && !hash_index_put(scratch, (uint64_t)ident, position++))
+        {
+            return NULL;
+        }
+    }
+    return scratch;
+}
+
+static const HashIndex *member_slots_in_file(const Library *library,
+                                             HashIndex *scratch)
+{
+    if (library->num_free_members == 0 &&
+        hash_index_is_built(&library->member_index))
+    {
+        return &library->member_index;
+    }
+    if (!hash_index_init(scratch, count_members(library)))
+    {
+        return NULL;
+    }
+    int position = 0;
+    for (int i = 0; i < library->num_members; i++)
+    {
+        int ident = library->members[i].ident;
+        if (ident != 0 && !hash_index_put(scratch, (uint64_t)ident, position++))
+        {
+            return NULL;
+        }
+    }
+    return scratch;
+}
+
+// Writes the ID indexes and whichever of the ISBN and text indexes are
+// built; returns the next free entry
+static SectionEntry *write_index_sections(SectionWriter *writer,
+                                          const Library *library,
+                                          const SectionEntry *books,
+                                          const SectionEntry *members,
+                                          uint64_t generation,
+                                          SectionEntry *entry)
+{
+    HashIndex book_scratch = {0};
+    HashIndex member_scratch = {0};
+    const HashIndex *book_slots = book_slots_in_file(library, &book_scratch);
+    const HashIndex *member_slots =
+        member_slots_in_file(library, &member_scratch);
+    if (book_slots && member_slots)
+    {
+        write_hash_index_section(writer,
+                                 book_slots,
+                                 SECTION_BOOK_ID_INDEX,
+                                 books,
+                                 generation,
+                                 entry);
+        write_hash_index_section(writer,
+                                 member_slots,
+                                 SECTION_MEMBER_ID_INDEX,
+                                 members,
+                                 generation,
+                                 entry + 1);
+    }
+    else
+    {
+        fprintf(stderr, "Memory allocation failed for library file index\n");
+        syslog(LOG_ERR, "Memory allocation failed for library file index\n");
+        writer->ok = 0;
+    }
+    hash_index_deinit(&book_scratch);
+    hash_index_deinit(&member_scratch);
+    entry += 2;
+
+    if (hash_index_is_built(&library->isbn_index))
+    {
+        write_hash_index_section(writer,
+                                 &library->isbn_index,
+                                 SECTION_ISBN_INDEX,
+                                 books,
+                                 generation,
+                                 entry++);
+    }
+    if (token_index_is_built(&library->text_index))
+    {
+        write_text_index_section(
+            writer, &library->text_index, books, generation, entry++);
+    }
+    return entry;
+}
+
+static void encode_table(const LibraryFileTable *table, unsigned char *out)
+{
+    unsigned char *entries = out + LIBRARY_FILE_HEADER_SIZE;
+    for (uint32_t i = 0; i < table->num_sections; i++)
+    {
+        const SectionEntry *entry = &table->sections[i];
+        unsigned char *slot = entries + i * LIBRARY_FILE_ENTRY_SIZE;
+        put_u32(slot, entry->type);
+        put_u32(slot + 4, entry->count);
+        put_u32(slot + 8, entry->record_size);
+        put_u32(slot + 12, entry->crc);
+        put_u64(slot + 16, entry->offset);
+        put_u64(slot + 24, entry->length);
+    }
+
+    memset(out, 0, LIBRARY_FILE_HEADER_SIZE);
+    memcpy(out, LIBRARY_FILE_MAGIC, LIBRARY_FILE_MAGIC_LENGTH);
+    put_u16(out + 8, table->version_major);
+    put_u16(out + 10, table->version_minor);
+    put_u32(out + 12, table->num_sections);
+    put_u32(out + 16, table->flags);
+    put_u32(out + 20,
+            crc32_update(0,
+                         entries,
+                         table->num_sections * LIBRARY_FILE_ENTRY_SIZE));
+    put_u32(out + 24, crc32_update(0, out, 24));
+}
+
+int library_file_write(const Library *library, FILE *file)
+{
+    if (!library || !file)
+    {
+        return 0;
+    }
+
+    int packed = library->file_encoding == FILE_ENCODING_PACKED;
+    int has_authors = author_dictionary_is_built(&library->authors);
+    int num_indexes = packed ? 0
+                             : 2 + hash_index_is_built(&library->isbn_index) +
+                                   token_index_is_built(&library->text_index);
+    uint64_t generation = library->generation + 1;
+    LibraryFileTable table = {0};
+    table.version_major = packed ? LIBRARY_FILE_PACKED_VERSION_MAJOR
+                                 : LIBRARY_FILE_VERSION_MAJOR;
+    table.version_minor = LIBRARY_FILE_VERSION_MINOR;
+    table.num_sections = 5 + (uint32_t)has_authors + (packed ? 0 : 2) +
+                         (uint32_t)num_indexes;
+    size_t table_size = LIBRARY_FILE_HEADER_SIZE +
+                        table.num_sections * LIBRARY_FILE_ENTRY_SIZE;
+    unsigned char head[LIBRARY_FILE_HEADER_SIZE +
+                       LIBRARY_FILE_MAX_SECTIONS * LIBRARY_FILE_ENTRY_SIZE] = {
+        0};
+
+    // Reserve room for the header, then fill it in once offsets are known
+    SectionWriter writer = {file, 0, 0, 1};
+    SectionEntry *entry = table.sections;
+    write_bytes(&writer, head, table_size);
+    if (packed)
+    {
+        write_packed_books_section(&writer, library, entry++);
+        write_packed_members_section(&writer, library, entry++);
+    }
+    else
+    {
+        PageIndex book_pages;
+        PageIndex member_pages;
+        int indexed = open_page_index(&book_pages, library->num_books);
+        indexed = open_page_index(&member_pages, library->num_members) &&
+                  indexed;
+        if (indexed)
+        {
+            SectionEntry *books = entry++;
+            SectionEntry *members = entry++;
+            write_books_section(&writer, library, books, &book_pages);
+            write_members_section(&writer, library, members, &member_pages);
+            write_page_index_section(
+                &writer, &book_pages, SECTION_BOOK_PAGES, entry++);
+            write_page_index_section(
+                &writer, &member_pages, SECTION_MEMBER_PAGES, entry++);
+            entry = write_index_sections(
+                &writer, library, books, members, generation, entry);
+        }
+        else
+        {
+            fprintf(stderr, "Memory allocation failed for page index\n");
+            syslog(LOG_ERR, "Memory allocation failed for page index\n");
+            writer.ok = 0;
+        }
+        free(book_pages.pages);
+        free(member_pages.pages);
+    }
+    write_meta_section(&writer, library, entry++);
+    write_id_marks_section(&writer, library, entry++);
+    write_generation_section(&writer, generation, entry++);
+    if (has_authors)
+    {
+        write_authors_section(&writer, &library->authors, entry++);
+    }
+
+    encode_table(&table, head);
+    return writer.ok && fseek(file, 0, SEEK_SET) == 0 &&
+           fwrite(head, 1, table_size, file) == table_size;
+}
+
+int library_file_read_table(FILE *file, LibraryFileTable *table)
+{
+    if (!file || !table)
+    {
+        return 0;
+    }
+    memset(table, 0, sizeof(LibraryFileTable));
+
+    unsigned char header[LIBRARY_FILE_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, LIBRARY_FILE_MAGIC, LIBRARY_FILE_MAGIC_LENGTH) != 0)
+    {
+        fprintf(stderr, "Not a library file\n");
+        syslog(LOG_ERR, "Not a library file\n");
+        return 0;
+    }
+    if (get_u32(header + 24) != crc32_update(0, header, 24))
+    {
+        fprintf(stderr, "Library file header is corrupt\n");
+        syslog(LOG_ERR, "Library file header is corrupt\n");
+        return 0;
+    }
+
+    table->version_major = get_u16(header + 8);
+    table->version_minor = get_u16(header + 10);
+    table->num_sections = get_u32(header + 12);
+    table->flags = get_u32(header + 16);
+    if (table->version_major < LIBRARY_FILE_VERSION_MAJOR ||
+        table->version_major > LIBRARY_FILE_PACKED_VERSION_MAJOR ||
+        table->num_sections > LIBRARY_FILE_MAX_SECTIONS)
+    {
+        fprintf(stderr,
+                "Unsupported library file version %u.%u\n",
+                table->version_major,
+                table->version_minor);
+        syslog(LOG_ERR,
+               "Unsupported library file version %u.%u\n",
+               table->version_major,
+               table->version_minor);
+        return 0;
+    }
+
+    unsigned char entries[LIBRARY_FILE_MAX_SECTIONS * LIBRARY_FILE_ENTRY_SIZE];
+    size_t entries_size = table->num_sections * LIBRARY_FILE_ENTRY_SIZE;
+    if (fread(entries, 1, entries_size, file) != entries_size ||
+        get_u32(header + 20) != crc32_update(0, entries, entries_size))
+    {
+        fprintf(stderr, "Library file section table is corrupt\n");
+        syslog(LOG_ERR, "Library file section table is corrupt\n");
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < table->num_sections; i++)
+    {
+        const unsigned char *slot = entries + i * LIBRARY_FILE_ENTRY_SIZE;
+        SectionEntry *entry = &table->sections[i];
+        entry->type = get_u32(slot);
+        entry->count = get_u32(slot + 4);
+        entry->record_size = get_u32(slot + 8);
+        entry->crc = get_u32(slot + 12);
+        entry->offset = get_u64(slot + 16);
+        entry->length = get_u64(slot + 24);
+    }
+    return 1;
+}
+
+const SectionEntry *library_file_find_section(const LibraryFileTable *table,
+                                              uint32_t type)
+{
+    for (uint32_t i = 0; table && i < table->num_sections; i++)
+    {
+        if (table->sections[i].type == type)
+        {
+            return &table->sections[i];
+        }
+    }
+    return NULL;
+}
+
+static int seek_section(FILE *file,
+                        const SectionEntry *section,
+                        uint32_t record_size)
+{
+    if (section->record_size != record_size ||
+        section->length != (uint64_t)section->count * record_size ||
+        section->offset > INT64_MAX ||
+        fseeko(file, (off_t)section->offset, SEEK_SET) != 0)
+    {
+        fprintf(stderr,
+                "Library file section %u is malformed\n",
+                section->type);
+        syslog(LOG_ERR,
+               "Library file section %u is malformed\n",
+               section->type);
+        return 0;
+    }
+    return 1;
+}
+
+static int check_section_crc(const SectionEntry *section, uint32_t crc)
+{
+    if (crc != section->crc)
+    {
+        fprintf(stderr, "Library file section %u is corrupt\n", section->type);
+        syslog(LOG_ERR, "Library file section %u is corrupt\n", section->type);
+        return 0;
+    }
+    return 1;
+}
+
+// Decodes blocks as they are read, so only one block is held at a time
+static int read_packed_section(FILE *file,
+                               const SectionEntry *section,
+                               int (*unpack)(const unsigned char **in,
+                                             const unsigned char *end,
+                                             PackState *state,
+                                             void *records,
+                                             uint32_t index),
+                               void *records)
+{
+    if (section->record_size != 0 || section->offset > INT64_MAX ||
+        fseeko(file, (off_t)section->offset, SEEK_SET) != 0)
+    {
+        fprintf(stderr,
+                "Library file section %u is malformed\n",
+                section->type);
+        syslog(LOG_ERR,
+               "Library file section %u is malformed\n",
+               section->type);
+        return 0;
+    }
+
+    unsigned char *raw = (unsigned char *)malloc(BLOCK_COMPRESS_MAX_INPUT);
+    unsigned char *stored = (unsigned char *)malloc(BLOCK_COMPRESS_MAX_INPUT);
+    int ok = raw && stored;
+    PackState state = {0, 0};
+    uint32_t crc = 0;
+    uint32_t done = 0;
+    uint64_t remaining = section->length;
+    while (ok && remaining > 0)
+    {
+        unsigned char header[BLOCK_HEADER_SIZE];
+        ok = remaining >= sizeof(header) &&
+             fread(header, 1, sizeof(header), file) == sizeof(header);
+        uint32_t raw_length = ok ? get_u32(header) : 0;
+        uint32_t stored_length = ok ? get_u32(header + 4) : 0;
+        ok = ok && raw_length <= BLOCK_COMPRESS_MAX_INPUT &&
+             stored_length <= raw_length &&
+             stored_length <= remaining - sizeof(header);
+        if (!ok)
+        {
+            break;
+        }
+        crc = crc32_update(crc, header, sizeof(header));
+        remaining -= sizeof(header) + stored_length;
+
+        unsigned char *target = stored_length < raw_length ? stored : raw;
+        ok = fread(target, 1, stored_length, file) == stored_length;
+        crc = crc32_update(crc, target, stored_length);
+        ok = ok && (target == raw ||
+                    block_decompress(stored, stored_length, raw, raw_length));
+
+        const unsigned char *cursor = raw;
+        const unsigned char *end = raw + raw_length;
+        while (ok && cursor < end)
+        {
+            ok = done < section->count &&
+                 unpack(&cursor, end, &state, records, done);
+            done++;
+        }
+    }
+    free(raw);
+    free(stored);
+    if (!ok || done != section->count)
+    {
+        fprintf(stderr,
+                "Library file section %u is malformed\n",
+                section->type);
+        syslog(LOG_ERR,
+               "Library file section %u is malformed\n",
+               section->type);
+        return 0;
+    }
+    return check_section_crc(section, crc);
+}
+
+int library_file_read_books(FILE *file,
+                            const SectionEntry *section,
+                            Library *library)
+{
+    if (!file || !section || !library ||
+        section->count > (uint32_t)library->capacity_books)
+    {
+        return 0;
+    }
+    if (section->type == SECTION_BOOKS_PACKED)
+    {
+        if (!read_packed_section(file, section, unpack_book, library->books))
+        {
+            return 0;
+        }
+        library->num_books = (int)section->count;
+        return 1;
+    }
+    if (!seek_section(file, section, BOOK_RECORD_SIZE))
+    {
+        return 0;
+    }
+
+    unsigned char chunk[RECORDS_PER_CHUNK * BOOK_RECORD_SIZE];
+    uint32_t crc = 0;
+    for (uint32_t done = 0; done < section->count;)
+    {
+        uint32_t batch = section->count - done;
+        batch = batch < RECORDS_PER_CHUNK ? batch : RECORDS_PER_CHUNK;
+        size_t bytes = (size_t)batch * BOOK_RECORD_SIZE;
+        if (fread(chunk, 1, bytes, file) != bytes)
+        {
+            return 0;
+        }
+        crc = crc32_update(crc, chunk, bytes);
+        for (uint32_t i = 0; i < batch; i++)
+        {
+            decode_book_record(chunk + (size_t)i * BOOK_RECORD_SIZE,
+                               &library->books[done + i]);
+        }
+        done += batch;
+    }
+    if (!check_section_crc(section, crc))
+    {
+        return 0;
+    }
+    library->num_books = (int)section->count;
+    return 1;
+}
+
+int library_file_read_members(FILE *file,
+                              const SectionEntry *section,
+                              Library *library)
+{
+    if (!file || !section || !library ||
+        section->count > (uint32_t)library->capacity_members)
+    {
+        return 0;
+    }
+    if (section->type == SECTION_MEMBERS_PACKED)
+    {
+        if (!read_packed_section(
+                file, section, unpack_member, library->members))
+        {
+            return 0;
+        }
+        library->num_members = (int)section->count;
+        return 1;
+    }
+    if (!seek_section(file, section, MEMBER_RECORD_SIZE))
+    {
+        return 0;
+    }
+
+    unsigned char chunk[RECORDS_PER_CHUNK * MEMBER_RECORD_SIZE];
+    uint32_t crc = 0;
+    for (uint32_t done = 0; done < section->count;)
+    {
+        uint32_t batch = section->count - done;
+        batch = batch < RECORDS_PER_CHUNK ? batch : RECORDS_PER_CHUNK;
+        size_t bytes = (size_t)batch * MEMBER_RECORD_SIZE;
+        if (fread(chunk, 1, bytes, file) != bytes)
+        {
+            return 0;
+        }
+        crc = crc32_update(crc, chunk, bytes);
+        for (uint32_t i = 0; i < batch; i++)
+        {
+            decode_member_record(chunk + (size_t)i * MEMBER_RECORD_SIZE,
+                                 &library->members[done + i]);
+        }
+        done += batch;
+    }
+    if (!check_section_crc(section, crc))
+    {
+        return 0;
+    }
+    library->num_members = (int)section->count;
+    return 1;
+}
+
+int library_file_read_authors(FILE *file,
+                              const SectionEntry *section,
+                              Library *library)
+{
+    if (!file || !section || !library ||
+        !author_dictionary_is_built(&library->authors) ||
+        section->record_size != 0 || section->offset > INT64_MAX ||
+        section->length > (uint64_t)section->count * (2 + MAX_AUTHOR_LENGTH) ||
+        fseeko(file, (off_t)section->offset, SEEK_SET) != 0)
+    {
+        return 0;
+    }
+
+    unsigned char *data = (unsigned char *)malloc((size_t)section->length + 1);
+    if (!data)
+    {
+        return 0;
+    }
+    int ok = fread(data, 1, (size_t)section->length, file) ==
+                 (size_t)section->length &&
+             check_section_crc(
+                 section, crc32_update(0, data, (size_t)section->length));
+
+    char name[MAX_AUTHOR_LENGTH];
+    size_t position = 0;
+    for (uint32_t i = 0; ok && i < section->count; i++)
+    {
+        uint32_t author_id = NO_AUTHOR_ID;
+        size_t length = position + 2 <= section->length
+                            ? get_u16(data + position)
+                            : 0;
+        position += 2;
+        ok = length > 0 && length < MAX_AUTHOR_LENGTH &&
+             position + length <= section->length;
+        if (ok)
+        {
+            memcpy(name, data + position, length);
+            name[length] = '\0';
+            position += length;
+            ok = author_dictionary_intern(
+                     &library->authors, name, &author_id) &&
+                 author_id == i + 1;
+        }
+    }
+    free(data);
+    return ok;
+}
+
+int library_file_read_meta(FILE *file,
+                           const SectionEntry *section,
+                           Library *library)
+{
+    unsigned char record[META_RECORD_SIZE];
+    if (!file || !section || !library || section->count != 1 ||
+        !seek_section(file, section, META_RECORD_SIZE) ||
+        fread(record, 1, sizeof(record), file) != sizeof(record) ||
+        !check_section_crc(section, crc32_update(0, record, sizeof(record))))
+    {
+        return 0;
+    }
+    library->journal_lsn = get_u64(record);
+    return 1;
+}
+
+int library_file_read_id_marks(FILE *file, const SectionEntry *section)
+{
+    unsigned char record[ID_MARKS_RECORD_SIZE];
+    if (!file || !section || section->count != 1 ||
+        !seek_section(file, section, ID_MARKS_RECORD_SIZE) ||
+        fread(record, 1, sizeof(record), file) != sizeof(record) ||
+        !check_section_crc(section, crc32_update(0, record, sizeof(record))))
+    {
+        return 0;
+    }
+    uint32_t next_book = get_u32(record);
+    uint32_t next_member = get_u32(record + 4);
+    if (next_book > INT32_MAX || next_member > INT32_MAX)
+    {
+        return 0;
+    }
+    id_allocator_raise(book_id_allocator(), (int)next_book);
+    id_allocator_raise(member_id_allocator(), (int)next_member);
+    return 1;
+}
+
+int library_file_read_generation(FILE *file,
+                                 const SectionEntry *section,
+                                 Library *library)
+{
+    unsigned char record[GENERATION_RECORD_SIZE];
+    if (!file || !section || !library || section->count != 1 ||
+        !seek_section(file, section, GENERATION_RECORD_SIZE) ||
+        fread(record, 1, sizeof(record), file) != sizeof(record) ||
+        !check_section_crc(section, crc32_update(0, record, sizeof(record))))
+    {
+        return 0;
+    }
+    library->generation = get_u64(record);
+    return 1;
+}
+
+void decode_index_stamp(const unsigned char *record, IndexStamp *stamp)
+{
+    stamp->generation = get_u64(record);
+    stamp->source_type = get_u32(record + 8);
+    stamp->source_count = get_u32(record + 12);
+    stamp->source_crc = get_u32(record + 16);
+    stamp->capacity = get_u32(record + 20);
+    stamp->count = get_u32(record + 24);
+}
+
+int library_file_index_is_current(const LibraryFileTable *table,
+                                  const IndexStamp *stamp,
+                                  uint64_t generation)
+{
+    const SectionEntry *source =
+        library_file_find_section(table, stamp->source_type);
+    return source && generation != 0 && stamp->generation == generation &&
+           stamp->source_count == source->count &&
+           stamp->source_crc == source->crc;
+}
+
+static uint32_t index_source_type(uint32_t type)
+{
+    return type == SECTION_MEMBER_ID_INDEX ? SECTION_MEMBERS : SECTION_BOOKS;
+}
+
+static int index_stamp_is_usable(const LibraryFileTable *table,
+                                 const SectionEntry *section,
+                                 const IndexStamp *stamp,
+                                 uint64_t generation)
+{
+    if (stamp->source_type != index_source_type(section->type) ||
+        !library_file_index_is_current(table, stamp, generation))
+    {
+        syslog(LOG_INFO,
+               "Library file index %u is stale, rebuilding it\n",
+               section->type);
+        return 0;
+    }
+    return section->type == SECTION_TEXT_INDEX ||
+           (stamp->capacity <= (1U << 30) &&
+            section->length ==
+                INDEX_STAMP_SIZE + (uint64_t)stamp->capacity * 12);
+}
+
+// Also checks that the table holds exactly its stamped count of keys, so
+// that at least one slot is empty (hash_index_attach requires count <
+// capacity) and probes for a missing key end
+static int slots_in_range(const HashIndex *index, int num_slots)
+{
+    int keys = 0;
+    for (int i = 0; i < index->capacity; i++)
+    {
+        if (index->keys[i] == 0)
+        {
+            continue;
+        }
+        keys++;
+        if (num_slots > 0 &&
+            (index->values[i] < 0 || index->values[i] >= num_slots))
+        {
+            return 0;
+        }
+    }
+    return keys == index->count;
+}
+
+static int read_hash_index(FILE *file,
+                           const LibraryFileTable *table,
+                           const SectionEntry *section,
+                           uint64_t generation,
+                           int num_slots,
+                           HashIndex *index)
+{
+    unsigned char record[INDEX_STAMP_SIZE];
+    IndexStamp stamp;
+    if (section->record_size != 0 || section->offset > INT64_MAX ||
+        fseeko(file, (off_t)section->offset, SEEK_SET) != 0 ||
+        fread(record, 1, sizeof(record), file) != sizeof(record))
+    {
+        return 0;
+    }
+    decode_index_stamp(record, &stamp);
+    if (!index_stamp_is_usable(table, section, &stamp, generation))
+    {
+        return 0;
+    }
+
+    size_t capacity = stamp.capacity;
+    uint64_t *keys = (uint64_t *)malloc(capacity * sizeof(uint64_t) + 1);
+    int *values = (int *)malloc(capacity * sizeof(int) + 1);
+    int ok = keys && values &&
+             fread(keys, sizeof(uint64_t), capacity, file) == capacity &&
+             fread(values, sizeof(int), capacity, file) == capacity;
+    if (ok)
+    {
+        uint32_t crc = crc32_update(0, record, sizeof(record));
+        crc = crc32_update(crc, keys, capacity * sizeof(uint64_t));
+        crc = crc32_update(crc, values, capacity * sizeof(int));
+        ok = check_section_crc(section, crc);
+    }
+    for (size_t i = 0; ok && i < capacity; i++)
+    {
+        keys[i] = get_u64((const unsigned char *)&keys[i]);
+        values[i] = (int)get_u32((const unsigned char *)&values[i]);
+    }
+    ok = ok && hash_index_attach(index,
+                                 keys,
+                                 values,
+                                 (int)stamp.capacity,
+                                 (int)stamp.count) &&
+         slots_in_range(index, num_slots);
+    if (!ok)
+    {
+        free(keys);
+        free(values);
+        memset(index, 0, sizeof(HashIndex));
+        return 0;
+    }
+    // Decoded onto the heap, so the index owns its arrays after all
+    index->borrowed = 0;
+    return 1;
+}
+
+static int read_text_index(FILE *file,
+                           const LibraryFileTable *table,
+                           const SectionEntry *section,
+                           uint64_t generation,
+                           TokenIndex *index)
+{
+    if (section->record_size != 0 || section->length < INDEX_STAMP_SIZE ||
+        section->length > SIZE_MAX || section->offset > INT64_MAX ||
+        fseeko(file, (off_t)section->offset, SEEK_SET) != 0)
+    {
+        return 0;
+    }
+    unsigned char *data = (unsigned char *)malloc((size_t)section->length);
+    IndexStamp stamp;
+    if (!data ||
+        fread(data, 1, (size_t)section->length, file) !=
+            (size_t)section->length ||
+        !check_section_crc(
+            section, crc32_update(0, data, (size_t)section->length)))
+    {
+        free(data);
+        return 0;
+    }
+    decode_index_stamp(data, &stamp);
+    if (!index_stamp_is_usable(table, section, &stamp, generation) ||
+        stamp.count > INT32_MAX / 2 ||
+        !token_index_init(index, (int)stamp.count))
+    {
+        free(data);
+        return 0;
+    }
+
+    const unsigned char *in = data + INDEX_STAMP_SIZE;
+    const unsigned char *end = data + section->length;
+    int *ids = NULL;
+    uint64_t ids_capacity = 0;
+    int ok = 1;
+    for (uint32_t i = 0; ok && i < stamp.count; i++)
+    {
+        char token[MAX_TOKEN_LENGTH];
+        uint64_t length = 0;
+        uint64_t count = 0;
+        ok = get_varint(&in, end, &length) && length > 0 &&
+             length < MAX_TOKEN_LENGTH && length <= (uint64_t)(end - in);
+        if (ok)
+        {
+            memcpy(token, in, (size_t)length);
+            token[length] = '\0';
+            in += length;
+            // Every ID takes at least a byte
+            ok = get_varint(&in, end, &count) &&
+                 count <= (uint64_t)(end - in);
+        }
+        if (ok && count > ids_capacity)
+        {
+            int *grown = (int *)realloc(ids, (size_t)count * sizeof(int));
+            ok = grown != NULL;
+            ids = grown ? grown : ids;
+            ids_capacity = grown ? count : ids_capacity;
+        }
+        uint64_t ident = 0;
+        for (uint64_t j = 0; ok && j < count; j++)
+        {
+            uint64_t delta = 0;
+            ok = get_varint(&in, end, &delta) && delta > 0 &&
+                 delta <= INT32_MAX - ident;
+            ident += delta;
+            ids[j] = ok ? (int)ident : 0;
+        }
+        ok = ok && token_index_restore(index, token, ids, (int)count);
+    }
+    free(ids);
+    free(data);
+    if (!ok)
+    {
+        fprintf(stderr, "Library file text index is malformed\n");
+        syslog(LOG_ERR, "Library file text index is malformed\n");
+        token_index_deinit(index);
+    }
+    return ok;
+}
+
+int library_file_read_book_indexes(FILE *file,
+                                   const LibraryFileTable *table,
+                                   Library *library)
+{
+    if (!file || !table || !library)
+    {
+        return 0;
+    }
+    const SectionEntry *books = library_file_find_section(table, SECTION_BOOKS);
+    const SectionEntry *ids =
+        library_file_find_section(table, SECTION_BOOK_ID_INDEX);
+    const SectionEntry *isbns =
+        library_file_find_section(table, SECTION_ISBN_INDEX);
+    const SectionEntry *text =
+        library_file_find_section(table, SECTION_TEXT_INDEX);
+    if (!books || books->count > INT32_MAX)
+    {
+        return 0;
+    }
+
+    int restored = 0;
+    HashIndex hash = {0};
+    TokenIndex tokens = {0};
+    if (ids && read_hash_index(file,
+                               table,
+                               ids,
+                               library->generation,
+                               (int)books->count,
+                               &hash))
+    {
+        hash_index_deinit(&library->book_index);
+        library->book_index = hash;
+        restored |= BOOK_INDEX_ID;
+    }
+    if (isbns &&
+        read_hash_index(file, table, isbns, library->generation, 0, &hash))
+    {
+        hash_index_deinit(&library->isbn_index);
+        library->isbn_index = hash;
+        restored |= BOOK_INDEX_ISBN;
+    }
+    if (text &&
+        read_text_index(file, table, text, library->generation, &tokens))
+    {
+        token_index_deinit(&library->text_index);
+        library->text_index = tokens;
+        restored |= BOOK_INDEX_TEXT;
+    }
+    return restored;
+}
+
+int library_file_read_member_index(FILE *file,
+                                   const LibraryFileTable *table,
+                                   Library *library)
+{
+    if (!file || !table || !library)
+    {
+        return 0;
+    }
+    const SectionEntry *members =
+        library_file_find_section(table, SECTION_MEMBERS);
+    const SectionEntry *ids =
+        library_file_find_section(table, SECTION_MEMBER_ID_INDEX);
+    HashIndex hash = {0};
+    if (!members || members->count > INT32_MAX || !ids ||
+        !read_hash_index(file,
+                         table,
+                         ids,
+                         library->generation,
+                         (int)members->count,
+                         &hash))
+    {
+        return 0;
+    }
+    hash_index_deinit(&library->member_index);
+    library->member_index = hash;
+    return 1;
+}
+
+int library_file_attach_hash_index(HashIndex *index,
+                                   unsigned char *data,
+                                   const LibraryFileTable *table,
+                                   const SectionEntry *section,
+                                   uint64_t generation,
+                                   int num_slots)
+{
+    IndexStamp stamp;
+    HashIndex attached = {0};
+    if (!index || !data || !table || !section ||
+        section->length < INDEX_STAMP_SIZE)
+    {
+        return 0;
+    }
+    decode_index_stamp(data, &stamp);
+    uint64_t *keys = (uint64_t *)(void *)(data + INDEX_STAMP_SIZE);
+    int *values = (int *)(void *)(data + INDEX_STAMP_SIZE +
+                                  (size_t)stamp.capacity * sizeof(uint64_t));
+    if (!index_stamp_is_usable(table, section, &stamp, generation) ||
+        !hash_index_attach(
+            &attached, keys, values, (int)stamp.capacity, (int)stamp.count) ||
+        !slots_in_range(&attached, num_slots))
+    {
+        return 0;
+    }
+    hash_index_deinit(index);
+    *index = attached;
+    return 1;
+}
+
+int library_file_read_pages(FILE *file,
+                            const SectionEntry *section,
+                            PageSummary *pages)
+{
+    if (!file || !section || !pages ||
+        !seek_section(file, section, PAGE_SUMMARY_SIZE))
+    {
+        return 0;
+    }
+
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < section->count; i++)
+    {
+        unsigned char record[PAGE_SUMMARY_SIZE];
+        if (fread(record, 1, sizeof(record), file) != sizeof(record))
+        {
+            return 0;
+        }
+        crc = crc32_update(crc, record, sizeof(record));
+        pages[i].min_ident = get_u32(record);
+        pages[i].max_ident = get_u32(record + 4);
+        pages[i].tally = get_u32(record + 8);
+        pages[i].crc = get_u32(record + 12);
+    }
+    return check_section_crc(section, crc);
+}
@@ -0,0 +1,191 @@
+// include/library_file.h
+#ifndef LIBRARY_FILE_H
+#define LIBRARY_FILE_H
+
+#include <stdio.h>
+
+#include "../include/structures.h"
+
+// On-disk layout (all integers little-endian, sections 64-byte aligned):
+//   header   magic[8] "BKLIBDAT", u16 major, u16 minor, u32 num_sections,
+//            u32 flags, u32 table_crc, u32 header_crc, u32 reserved
+//   table    num_sections entries of u32 type, u32 count, u32 record_size,
+//            u32 crc, u64 offset, u64 length
+//   sections payloads at the offsets given by the table (books, members,
+//            meta and, when built, the author dictionary)
+// Readers accept any minor version of their major version and skip section
+// types they do not know.
+//
+// Since minor version 1, record-encoded files also carry a page index for
+// the books and the members: one PageSummary per LIBRARY_FILE_PAGE_RECORDS
+// records, so a reader can fetch a single page of a section and check it
+// on its own (see open_library_lazily). Minor version 2 adds the ID
+// allocators' high-water marks.
+//
+// Minor version 3 adds the save's generation and, in record-encoded
+// files, the lookup indexes themselves: the book ID, ISBN and member ID
+// hash tables (IndexStamp, u64 keys[capacity], u32 values[capacity]) and
+// the text index (IndexStamp, then per token a varint length, its bytes,
+// a varint posting count and the IDs as varint deltas). ID tables map to
+// positions in the file's record sections, so a loader can use them as
+// they are. Each index is stamped with the generation and with the count
+// and CRC of the section it was built from, and is only trusted while all
+// three still match; otherwise it is rebuilt.
+//
+// Packed files (FILE_ENCODING_PACKED) carry SECTION_BOOKS_PACKED and
+// SECTION_MEMBERS_PACKED instead and use major version 2, so that version
+// 1 readers reject them rather than skip every record. A packed section
+// is a run of blocks of u32 raw_length, u32 stored_length and the stored
+// bytes, which are block_compress output unless stored_length equals
+// raw_length. Decompressed blocks hold whole records: IDs and added dates
+// as zigzag varint deltas from the previous record, strings as a varint
+// length and their bytes.
+#define LIBRARY_FILE_MAGIC "BKLIBDAT"
+#define LIBRARY_FILE_MAGIC_LENGTH 8
+#define LIBRARY_FILE_VERSION_MAJOR 1
+#define LIBRARY_FILE_VERSION_MINOR 3
+#define LIBRARY_FILE_PACKED_VERSION_MAJOR 2
+#define LIBRARY_FILE_HEADER_SIZE 32
+#define LIBRARY_FILE_ENTRY_SIZE 32
+#define LIBRARY_FILE_ALIGNMENT 64
+#define LIBRARY_FILE_MAX_SECTIONS 64
+
+typedef enum
+{
+    SECTION_BOOKS = 1,
+    SECTION_MEMBERS = 2,
+    SECTION_AUTHORS = 3,
+    SECTION_META = 4,
+    SECTION_BOOKS_PACKED = 5,
+    SECTION_MEMBERS_PACKED = 6,
+    SECTION_BOOK_PAGES = 7,
+    SECTION_MEMBER_PAGES = 8,
+    SECTION_ID_MARKS = 9,
+    SECTION_GENERATION = 10,
+    SECTION_BOOK_ID_INDEX = 11,
+    SECTION_ISBN_INDEX = 12,
+    SECTION_MEMBER_ID_INDEX = 13,
+    SECTION_TEXT_INDEX = 14
+} SectionType;
+
+// Fixed-width records. Field offsets match the in-memory structs of
+// common LP64 little-endian targets, padding included.
+#define BOOK_RECORD_SIZE 248
+#define MEMBER_RECORD_SIZE 180
+// Library-wide values: u64 journal_lsn
+#define META_RECORD_SIZE 8
+// u32 next book ID, u32 next member ID
+#define ID_MARKS_RECORD_SIZE 8
+// u64 generation
+#define GENERATION_RECORD_SIZE 8
+// u64 generation, u32 source_type, u32 source_count, u32 source_crc,
+// u32 capacity, u32 count, u32 reserved
+#define INDEX_STAMP_SIZE 32
+#define PAGE_SUMMARY_SIZE 16
+#define LIBRARY_FILE_PAGE_RECORDS 256
+
+typedef struct
+{
+    uint32_t type;
+    uint32_t count;
+    uint32_t record_size;
+    uint32_t crc;
+    uint64_t offset;
+    uint64_t length;
+} SectionEntry;
+
+// Smallest and largest ID on the page, a tally (available books for book
+// pages, borrowed books for member pages) and the CRC-32 of its records
+typedef struct
+{
+    uint32_t min_ident;
+    uint32_t max_ident;
+    uint32_t tally;
+    uint32_t crc;
+} PageSummary;
+
+// Heads every persisted index: the generation of the save that wrote it,
+// the type, count and CRC of the section it indexes, and the table's
+// capacity (hash indexes) and number of entries
+typedef struct
+{
+    uint64_t generation;
+    uint32_t source_type;
+    uint32_t source_count;
+    uint32_t source_crc;
+    uint32_t capacity;
+    uint32_t count;
+} IndexStamp;
+
+typedef struct
+{
+    uint16_t version_major;
+    uint16_t version_minor;
+    uint32_t flags;
+    uint32_t num_sections;
+    SectionEntry sections[LIBRARY_FILE_MAX_SECTIONS];
+} LibraryFileTable;
+
+void encode_book_record(const Book *book, unsigned char *record);
+void decode_book_record(const unsigned char *record, Book *book);
+void encode_member_record(const Member *member, unsigned char *record);
+void decode_member_record(const unsigned char *record, Member *member);
+
+int library_file_write(const Library *library, FILE *file);
+// Validates the header and section table checksums
+int library_file_read_table(FILE *file, LibraryFileTable *table);
+const SectionEntry *library_file_find_section(const LibraryFileTable *table,
+                                              uint32_t type);
+// Each reader seeks to its section, so sections load in any order. The
+// library must already have room for section->count records. The book and
+// member readers accept both the record and the packed section types.
+int library_file_read_books(FILE *file,
+                            const SectionEntry *section,
+                            Library *library);
+int library_file_read_members(FILE *file,
+                              const SectionEntry *section,
+                              Library *library);
+int library_file_read_authors(FILE *file,
+                              const SectionEntry *section,
+                              Library *library);
+int library_file_read_meta(FILE *file,
+                           const SectionEntry *section,
+                           Library *library);
+// Raises the process-wide book and member ID allocators to the saved
+// high-water marks, so IDs handed out after a load never reuse saved ones
+// (nor those of books removed before the save)
+int library_file_read_id_marks(FILE *file, const SectionEntry *section);
+int library_file_read_generation(FILE *file,
+                                 const SectionEntry *section,
+                                 Library *library);
+void decode_index_stamp(const unsigned char *record, IndexStamp *stamp);
+// Whether an index with this stamp still describes the table's sections
+// at the given generation
+int library_file_index_is_current(const LibraryFileTable *table,
+                                  const IndexStamp *stamp,
+                                  uint64_t generation);
+// Restore the persisted indexes that are current for library->generation
+// (read the generation section first) in place of the library's own.
+// Missing, stale or damaged ones are skipped, and the book reader returns
+// the BookIndexParts it restored, the member reader whether it did.
+int library_file_read_book_indexes(FILE *file,
+                                   const LibraryFileTable *table,
+                                   Library *library);
+int library_file_read_member_index(FILE *file,
+                                   const LibraryFileTable *table,
+                                   Library *library);
+// Serves a persisted hash index straight from its section at data, inside
+// a native-layout mapping of the file, if it is current. Slot-valued
+// indexes pass their number of slots as num_slots (0 = values are IDs).
+int library_file_attach_hash_index(HashIndex *index,
+                                   unsigned char *data,
+                                   const LibraryFileTable *table,
+                                   const SectionEntry *section,
+                                   uint64_t generation,
+                                   int num_slots);
+// Reads section->count summaries into pages
+int library_file_read_pages(FILE *file,
+                            const SectionEntry *section,
+                            PageSummary *pages);
+
+#endif
@@ -0,0 +1,891 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "library_journal.h"
+#include "background_snapshot.h"
+#include "library_management.h"
+#include "../bookManagement/book_management.h"
+#include "../indexManagement/crc32.h"
+#include "../indexManagement/library_lock.h"
+#include "../memberManagement/member_management.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RECORD_HEADER_SIZE 17
+#define MAX_PAYLOAD_SIZE 512
+#define JOURNAL_BUFFER_MIN_CAPACITY 4096
+
+typedef struct
+{
+    unsigned char data[MAX_PAYLOAD_SIZE];
+    size_t length;
+} Payload;
+
+typedef struct
+{
+    const unsigned char *data;
+    size_t length;
+    size_t position;
+} PayloadReader;
+
+static void put_u32(unsigned char *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static void put_u64(unsigned char *out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const unsigned char *in)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t get_u64(const unsigned char *in)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static void payload_int(Payload *payload, int value)
+{
+    put_u32(&payload->data[payload->length], (uint32_t)value);
+    payload->length += 4;
+}
+
+static void payload_u64(Payload *payload, uint64_t value)
+{
+    put_u64(&payload->data[payload->length], value);
+    payload->length += 8;
+}
+
+static void payload_string(Payload *payload, const char *text)
+{
+    // Every string field is shorter than 256 bytes (see structures.h)
+    size_t length = strlen(text);
+    if (length > 255)
+    {
+        length = 255;
+    }
+    payload->data[payload->length++] = (unsigned char)length;
+    memcpy(&payload->data[payload->length], text, length);
+    payload->length += length;
+}
+
+static int read_int(PayloadReader *reader, int *value)
+{
+    if (reader->length - reader->position < 4)
+    {
+        return 0;
+    }
+    *value = (int)get_u32(&reader->data[reader->position]);
+    reader->position += 4;
+    return 1;
+}
+
+static int read_u64(PayloadReader *reader, uint64_t *value)
+{
+    if (reader->length - reader->position < 8)
+    {
+        return 0;
+    }
+    *value = get_u64(&reader->data[reader->position]);
+    reader->position += 8;
+    return 1;
+}
+
+static int read_string(PayloadReader *reader, char *text, size_t text_size)
+{
+    if (reader->position >= reader->length)
+    {
+        return 0;
+    }
+    size_t length = reader->data[reader->position++];
+    if (reader->length - reader->position < length || length >= text_size)
+    {
+        return 0;
+    }
+    memcpy(text, &reader->data[reader->position], length);
+    text[length] = '\0';
+    reader->position += length;
+    return 1;
+}
+
+static long long monotonic_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static int write_all(int fd, const unsigned char *data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t written = write(fd, data, length);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return 0;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return 1;
+}
+
+static int read_whole_file(int fd, unsigned char **data, size_t *length)
+{
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < 0)
+    {
+        return 0;
+    }
+
+    size_t size = (size_t)info.st_size;
+    unsigned char *buffer = (unsigned char *)malloc(size ? size : 1);
+    if (!buffer)
+    {
+        return 0;
+    }
+
+    size_t total = 0;
+    while (total < size)
+    {
+        ssize_t got = pread(fd, buffer + total, size - total, (off_t)total);
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got <= 0)
+        {
+            break;
+        }
+        total += (size_t)got;
+    }
+    *data = buffer;
+    *length = total;
+    return 1;
+}
+
+static char *copy_path(const char *path)
+{
+    size_t length = strlen(path) + 1;
+    char *copy = (char *)malloc(length);
+    if (copy)
+    {
+        memcpy(copy, path, length);
+    }
+    return copy;
+}
+
+static void write_header(unsigned char *header)
+{
+    memset(header, 0, JOURNAL_HEADER_SIZE);
+    memcpy(header, JOURNAL_MAGIC, 8);
+    put_u32(&header[8], JOURNAL_VERSION);
+}
+
+static uint32_t record_crc(const unsigned char *record, size_t payload_length)
+{
+    // lsn, type and payload are contiguous after length and crc
+    return crc32_update(0, &record[8], 9 + payload_length);
+}
+
+// Makes sure new IDs never collide with replayed or loaded ones
+static void advance_id_counters(Library *library)
+{
+    int next_book = get_next_book_id();
+    for (int i = 0; i < library->num_books; i++)
+    {
+        if (library->books[i].ident >= next_book)
+        {
+            next_book = library->books[i].ident + 1;
+        }
+    }
+    set_next_book_id(next_book);
+
+    int next_member = get_next_member_id();
+    for (int i = 0; i < library->num_members; i++)
+    {
+        if (library->members[i].ident >= next_member)
+        {
+            next_member = library->members[i].ident + 1;
+        }
+    }
+    set_next_member_id(next_member);
+}
+
+static int apply_record(Library *library,
+                        unsigned char type,
+                        const unsigned char *payload,
+                        size_t payload_length)
+{
+    PayloadReader reader = {payload, payload_length, 0};
+    char title[MAX_TITLE_LENGTH];
+    char author[MAX_AUTHOR_LENGTH];
+    char isbn[MAX_ISBN_LENGTH];
+    char name[MAX_NAME_LENGTH];
+    char email[MAX_EMAIL_LENGTH];
+    int ident = 0;
+    int other = 0;
+    uint64_t added_date = 0;
+    BookRecord record = {title, author, isbn, 0, 0};
+
+    switch (type)
+    {
+    case JOURNAL_ADD_BOOK:
+        if (!read_int(&reader, &ident) ||
+            !read_string(&reader, title, sizeof(title)) ||
+            !read_string(&reader, author, sizeof(author)) ||
+            !read_string(&reader, isbn, sizeof(isbn)))
+        {
+            return 0;
+        }
+        // Reissue the ID and date the book had when the record was
+        // written; records without a date get the time of the replay
+        record.ident = ident;
+        if (read_u64(&reader, &added_date))
+        {
+            record.added_date = (time_t)(int64_t)added_date;
+        }
+        return ident > 0 && add_books_bulk(library, &record, 1) == 1;
+
+    case JOURNAL_REMOVE_BOOK:
+        if (!read_int(&reader, &ident))
+        {
+            return 0;
+        }
+        remove_book_from_library(library, ident);
+        return 1;
+
+    case JOURNAL_ADD_MEMBER:
+        if (!read_int(&reader, &ident) ||
+            !read_string(&reader, name, sizeof(name)) ||
+            !read_string(&reader, email, sizeof(email)))
+        {
+            return 0;
+        }
+        return add_member_with_id(library, ident, name, email);
+
+    case JOURNAL_REMOVE_MEMBER:
+        if (!read_int(&reader, &ident))
+        {
+            return 0;
+        }
+        remove_member_from_library(library, ident);
+        return 1;
+
+    case JOURNAL_BORROW_BOOK:
+        return read_int(&reader, &ident) && read_int(&reader, &other) &&
+               borrow_book(library, ident, other);
+
+    case JOURNAL_RETURN_BOOK:
+        return read_int(&reader, &ident) && read_int(&reader, &other) &&
+               return_book(library, ident, other);
+
+    default:
+        return 0;
+    }
+}
+
+// Applies every intact record newer than library->journal_lsn and returns
+// the offset just past the last intact record
+static size_t replay_records(LibraryJournal *journal,
+                             Library *library,
+                             const unsigned char *data,
+                             size_t length)
+{
+    size_t offset = JOURNAL_HEADER_SIZE;
+    while (length - offset >= RECORD_HEADER_SIZE)
+    {
+        const unsigned char *record = &data[offset];
+        size_t payload_length = get_u32(record);
+        if (payload_length > MAX_PAYLOAD_SIZE ||
+            length - offset - RECORD_HEADER_SIZE < payload_length ||
+            get_u32(&record[4]) != record_crc(record, payload_length))
+        {
+            break;
+        }
+
+        uint64_t lsn = get_u64(&record[8]);
+        if (lsn > library->journal_lsn)
+        {
+            if (!apply_record(library,
+                              record[16],
+                              &record[RECORD_HEADER_SIZE],
+                              payload_length))
+            {
+                fprintf(stderr,
+                        "Journal record %llu could not be replayed\n",
+                        (unsigned long long)lsn);
+                syslog(LOG_ERR,
+                       "Journal record %llu could not be replayed\n",
+                       (unsigned long long)lsn);
+            }
+            library->journal_lsn = lsn;
+            journal->replayed_records++;
+            journal->records_since_checkpoint++;
+        }
+        if (lsn >= journal->next_lsn)
+        {
+            journal->next_lsn = lsn + 1;
+        }
+        offset += RECORD_HEADER_SIZE + payload_length;
+    }
+    return offset;
+}
+
+int journal_open(LibraryJournal *journal,
+                 const char *journal_path,
+                 const char *snapshot_path,
+                 Library *library)
+{
+    if (!journal || !journal_path || !library)
+    {
+        fprintf(stderr, "Journal Open Journal or Library pointer is NULL\n");
+        syslog(LOG_ERR, "Journal Open Journal or Library pointer is NULL\n");
+        return 0;
+    }
+
+    memset(journal, 0, sizeof(LibraryJournal));
+    pthread_mutex_init(&journal->lock, NULL);
+    journal->fd = -1;
+    journal->group_commit_records = DEFAULT_GROUP_COMMIT_RECORDS;
+    journal->group_commit_interval_ms = DEFAULT_GROUP_COMMIT_INTERVAL_MS;
+    journal->checkpoint_records = DEFAULT_CHECKPOINT_RECORDS;
+    journal->next_lsn = library->journal_lsn + 1;
+
+    journal->journal_path = copy_path(journal_path);
+    journal->snapshot_path = snapshot_path ? copy_path(snapshot_path) : NULL;
+    if (!journal->journal_path || (snapshot_path && !journal->snapshot_path))
+    {
+        fprintf(stderr, "Memory allocation failed for journal\n");
+        syslog(LOG_ERR, "Memory allocation failed for journal\n");
+        journal_close(journal);
+        return 0;
+    }
+
+    journal->fd = open(journal_path, O_RDWR | O_CREAT, 0644);
+    unsigned char *data = NULL;
+    size_t length = 0;
+    if (journal->fd < 0 || !read_whole_file(journal->fd, &data, &length))
+    {
+        fprintf(stderr, "Failed to open journal file\n");
+        syslog(LOG_ERR, "Failed to open journal file\n");
+        journal_close(journal);
+        return 0;
+    }
+
+    size_t end = JOURNAL_HEADER_SIZE;
+    if (length == 0)
+    {
+        unsigned char header[JOURNAL_HEADER_SIZE];
+        write_header(header);
+        if (!write_all(journal->fd, header, sizeof(header)) ||
+            fsync(journal->fd) != 0)
+        {
+            fprintf(stderr, "Failed to write journal header\n");
+            syslog(LOG_ERR, "Failed to write journal header\n");
+            free(data);
+            journal_close(journal);
+            return 0;
+        }
+    }
+    else
+    {
+        if (length < JOURNAL_HEADER_SIZE ||
+            memcmp(data, JOURNAL_MAGIC, 8) != 0 ||
+            get_u32(&data[8]) != JOURNAL_VERSION)
+        {
+            fprintf(stderr, "Journal file has an unknown format\n");
+            syslog(LOG_ERR, "Journal file has an unknown format\n");
+            free(data);
+            journal_close(journal);
+            return 0;
+        }
+        end = replay_records(journal, library, data, length);
+    }
+    free(data);
+    advance_id_counters(library);
+
+    if (end < length)
+    {
+        // A crash mid-write leaves a torn record; later appends go after
+        // the last intact one
+        fprintf(stderr,
+                "Journal truncated at offset %zu of %zu\n",
+                end,
+                length);
+        syslog(LOG_ERR,
+               "Journal truncated at offset %zu of %zu\n",
+               end,
+               length);
+        if (ftruncate(journal->fd, (off_t)end) != 0 || fsync(journal->fd) != 0)
+        {
+            journal_close(journal);
+            return 0;
+        }
+    }
+    if (lseek(journal->fd, (off_t)end, SEEK_SET) < 0)
+    {
+        journal_close(journal);
+        return 0;
+    }
+
+    syslog(LOG_INFO,
+           "Journal opened, %d records replayed\n",
+           journal->replayed_records);
+    return 1;
+}
+
+// Writes and fsyncs the buffered records; called under journal->lock
+static int flush_records(LibraryJournal *journal)
+{
+    if (journal->fd < 0)
+    {
+        return 0;
+    }
+    if (journal->buffered == 0)
+    {
+        return 1;
+    }
+
+    if (!write_all(journal->fd, journal->buffer, journal->buffered) ||
+        fsync(journal->fd) != 0)
+    {
+        fprintf(stderr, "Failed to write journal records\n");
+        syslog(LOG_ERR, "Failed to write journal records\n");
+        return 0;
+    }
+    journal->buffered = 0;
+    journal->pending_records = 0;
+    return 1;
+}
+
+int journal_sync(LibraryJournal *journal)
+{
+    if (!journal)
+    {
+        return 0;
+    }
+    pthread_mutex_lock(&journal->lock);
+    int synced = flush_records(journal);
+    pthread_mutex_unlock(&journal->lock);
+    return synced;
+}
+
+// Rewrites the journal without the records a snapshot already covers.
+// The rest is copied to a new file that replaces the journal, so a crash
+// leaves either the old or the new journal.
+static int discard_records_through(LibraryJournal *journal, uint64_t lsn)
+{
+    unsigned char *data = NULL;
+    size_t length = 0;
+    if (!flush_records(journal) ||
+        !read_whole_file(journal->fd, &data, &length))
+    {
+        return 0;
+    }
+
+    size_t offset = JOURNAL_HEADER_SIZE;
+    while (length - offset >= RECORD_HEADER_SIZE &&
+           get_u64(&data[offset + 8]) <= lsn)
+    {
+        offset += RECORD_HEADER_SIZE + get_u32(&data[offset]);
+    }
+    if (offset > length)
+    {
+        offset = length;
+    }
+
+    size_t path_length = strlen(journal->journal_path);
+    char *temp_path = (char *)malloc(path_length + sizeof(".tmp"));
+    if (!temp_path)
+    {
+        free(data);
+        return 0;
+    }
+    memcpy(temp_path, journal->journal_path, path_length);
+    memcpy(&temp_path[path_length], ".tmp", sizeof(".tmp"));
+
+    int fd = open(temp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    int rewritten = fd >= 0 && write_all(fd, data, JOURNAL_HEADER_SIZE) &&
+                    write_all(fd, &data[offset], length - offset) &&
+                    fsync(fd) == 0 &&
+                    rename(temp_path, journal->journal_path) == 0;
+    free(data);
+    if (!rewritten)
+    {
+        fprintf(stderr, "Failed to rewrite journal after checkpoint\n");
+        syslog(LOG_ERR, "Failed to rewrite journal after checkpoint\n");
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        remove(temp_path);
+        free(temp_path);
+        return 0;
+    }
+    free(temp_path);
+    close(journal->fd);
+    journal->fd = fd;
+    return 1;
+}
+
+static int finish_background_checkpoint(LibraryJournal *journal, int wait)
+{
+    // A failed snapshot leaves the journal untouched; the next automatic
+    // checkpoint simply tries again
+    if (background_snapshot_poll(&journal->background, wait) ==
+        SNAPSHOT_COMPLETED)
+    {
+        return discard_records_through(journal,
+                                       journal->background.journal_lsn);
+    }
+    return 1;
+}
+
+int journal_close(LibraryJournal *journal)
+{
+    if (!journal)
+    {
+        return 0;
+    }
+
+    int synced = 1;
+    if (journal->fd >= 0)
+    {
+        synced = finish_background_checkpoint(journal, 1) &&
+                 flush_records(journal);
+        if (close(journal->fd) != 0)
+        {
+            synced = 0;
+        }
+    }
+    background_snapshot_deinit(&journal->background);
+    free(journal->buffer);
+    free(journal->journal_path);
+    free(journal->snapshot_path);
+    pthread_mutex_destroy(&journal->lock);
+    memset(journal, 0, sizeof(LibraryJournal));
+    journal->fd = -1;
+    return synced;
+}
+
+// Called under journal->lock
+static int write_checkpoint(LibraryJournal *journal, Library *library)
+{
+    // The snapshot records journal_lsn, so a crash between the rename and
+    // the truncation only makes the next replay skip records it already has
+    if (!finish_background_checkpoint(journal, 1) ||
+        !save_library_to_file(library, journal->snapshot_path))
+    {
+        return 0;
+    }
+    advance_library_generation(library);
+
+    if (ftruncate(journal->fd, JOURNAL_HEADER_SIZE) != 0 ||
+        lseek(journal->fd, JOURNAL_HEADER_SIZE, SEEK_SET) < 0 ||
+        fsync(journal->fd) != 0)
+    {
+        fprintf(stderr, "Failed to truncate journal\n");
+        syslog(LOG_ERR, "Failed to truncate journal\n");
+        return 0;
+    }
+    // Records still waiting for group commit are covered by the snapshot
+    journal->buffered = 0;
+    journal->pending_records = 0;
+    journal->records_since_checkpoint = 0;
+    syslog(LOG_INFO,
+           "Checkpoint written at journal record %llu\n",
+           (unsigned long long)library->journal_lsn);
+    return 1;
+}
+
+int journal_checkpoint(LibraryJournal *journal, Library *library)
+{
+    if (!journal || !library || journal->fd < 0 || !journal->snapshot_path)
+    {
+        fprintf(stderr, "Journal Checkpoint has no journal or snapshot path\n");
+        syslog(LOG_ERR, "Journal Checkpoint has no journal or snapshot path\n");
+        return 0;
+    }
+
+    pthread_mutex_lock(&journal->lock);
+    int written = write_checkpoint(journal, library);
+    pthread_mutex_unlock(&journal->lock);
+    return written;
+}
+
+// Called under journal->lock, right after the operation was applied
+static int append_record(LibraryJournal *journal,
+                         Library *library,
+                         JournalRecordType type,
+                         const Payload *payload)
+{
+    size_t needed = journal->buffered + RECORD_HEADER_SIZE + payload->length;
+    if (needed > journal->capacity)
+    {
+        size_t new_capacity = journal->capacity ? journal->capacity * 2
+                                                : JOURNAL_BUFFER_MIN_CAPACITY;
+        while (new_capacity < needed)
+        {
+            new_capacity *= 2;
+        }
+        unsigned char *new_buffer =
+            (unsigned char *)realloc(journal->buffer, new_capacity);
+        if (!new_buffer)
+        {
+            fprintf(stderr, "Memory allocation failed for journal buffer\n");
+            syslog(LOG_ERR, "Memory allocation failed for journal buffer\n");
+            return 0;
+        }
+        journal->buffer = new_buffer;
+        journal->capacity = new_capacity;
+    }
+
+    unsigned char *record = &journal->buffer[journal->buffered];
+    put_u32(record, (uint32_t)payload->length);
+    put_u64(&record[8], journal->next_lsn);
+    record[16] = (unsigned char)type;
+    memcpy(&record[RECORD_HEADER_SIZE], payload->data, payload->length);
+    put_u32(&record[4], record_crc(record, payload->length));
+    journal->buffered = needed;
+
+    library->journal_lsn = journal->next_lsn++;
+    journal->records_since_checkpoint++;
+    long long now = monotonic_ms();
+    if (journal->pending_records++ == 0)
+    {
+        journal->oldest_pending_ms = now;
+    }
+
+    if (journal->pending_records >= journal->group_commit_records ||
+        now - journal->oldest_pending_ms >= journal->group_commit_interval_ms)
+    {
+        if (!flush_records(journal))
+        {
+            return 0;
+        }
+    }
+    if (!finish_background_checkpoint(journal, 0))
+    {
+        return 0;
+    }
+    if (journal->checkpoint_records > 0 && journal->snapshot_path &&
+        journal->records_since_checkpoint >= journal->checkpoint_records &&
+        !journal->background.running)
+    {
+        journal->records_since_checkpoint = 0;
+        if (!background_snapshot_start(&journal->background,
+                                       library,
+                                       journal->snapshot_path))
+        {
+            return write_checkpoint(journal, library);
+        }
+    }
+    return 1;
+}
+
+static int journal_is_open(const LibraryJournal *journal,
+                           const Library *library)
+{
+    if (!journal || !library || journal->fd < 0)
+    {
+        fprintf(stderr, "Journal or Library pointer is NULL or not open\n");
+        syslog(LOG_ERR, "Journal or Library pointer is NULL or not open\n");
+        return 0;
+    }
+    return 1;
+}
+
+int journal_add_book(LibraryJournal *journal,
+                     Library *library,
+                     const char *title,
+                     const char *author,
+                     const char *isbn)
+{
+    if (!journal_is_open(journal, library))
+    {
+        return 0;
+    }
+
+    // The ID is reserved before the add, so that a concurrent add cannot
+    // take it; a merge into an existing copy changes nothing to journal
+    pthread_mutex_lock(&journal->lock);
+    library_lock_exclusive(library);
+    int merged = library->isbn_duplicate_policy == ISBN_DUPLICATE_MERGE &&
+                 isbn && find_book_by_isbn(library, isbn) != NULL;
+    int ident = merged ? 0 : id_allocator_next(book_id_allocator());
+    BookRecord record = {title, author, isbn, ident, 0};
+    const Book *book = ident != 0 && add_books_bulk(library, &record, 1) == 1
+                           ? find_book_by_id(library, ident)
+                           : NULL;
+    Payload payload = {{0}, 0};
+    if (book)
+    {
+        payload_int(&payload, ident);
+        payload_string(&payload, book->title);
+        payload_string(&payload, book->author);
+        payload_string(&payload, book->isbn);
+        payload_u64(&payload, (uint64_t)(int64_t)book->added_date);
+    }
+    library_unlock_exclusive(library);
+
+    int recorded = merged || (book && append_record(journal,
+                                                    library,
+                                                    JOURNAL_ADD_BOOK,
+                                                    &payload));
+    pthread_mutex_unlock(&journal->lock);
+    if (merged)
+    {
+        syslog(LOG_INFO, "Merged ISBN %s into an existing book\n", isbn);
+    }
+    return recorded;
+}
+
+int journal_remove_book(LibraryJournal *journal, Library *library, int ident)
+{
+    if (!journal_is_open(journal, library))
+    {
+        return 0;
+    }
+
+    Payload payload = {{0}, 0};
+    payload_int(&payload, ident);
+    pthread_mutex_lock(&journal->lock);
+    int removed = find_book_by_id(library, ident) != NULL;
+    if (removed)
+    {
+        remove_book_from_library(library, ident);
+    }
+    int recorded = removed && append_record(journal,
+                                            library,
+                                            JOURNAL_REMOVE_BOOK,
+                                            &payload);
+    pthread_mutex_unlock(&journal->lock);
+    return recorded;
+}
+
+int journal_add_member(LibraryJournal *journal,
+                       Library *library,
+                       const char *name,
+                       const char *email)
+{
+    if (!journal_is_open(journal, library))
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&journal->lock);
+    int ident = id_allocator_next(member_id_allocator());
+    int added = ident != 0 && add_member_with_id(library, ident, name, email);
+    Payload payload = {{0}, 0};
+    library_lock_shared(library);
+    const Member *member = added ? find_member_by_id(library, ident) : NULL;
+    if (member)
+    {
+        payload_int(&payload, ident);
+        payload_string(&payload, member->name);
+        payload_string(&payload, member->email);
+    }
+    library_unlock_shared(library);
+    int recorded = member && append_record(journal,
+                                           library,
+                                           JOURNAL_ADD_MEMBER,
+                                           &payload);
+    pthread_mutex_unlock(&journal->lock);
+    return recorded;
+}
+
+int journal_remove_member(LibraryJournal *journal, Library *library, int ident)
+{
+    if (!journal_is_open(journal, library))
+    {
+        return 0;
+    }
+
+    Payload payload = {{0}, 0};
+    payload_int(&payload, ident);
+    pthread_mutex_lock(&journal->lock);
+    int removed = find_member_by_id(library, ident) != NULL;
+    if (removed)
+    {
+        remove_member_from_library(library, ident);
+    }
+    int recorded = removed && append_record(journal,
+                                            library,
+                                            JOURNAL_REMOVE_MEMBER,
+                                            &payload);
+    pthread_mutex_unlock(&journal->lock);
+    return recorded;
+}
+
+// Borrows and returns of the same book must reach the journal in the order
+// they took effect, or replay would refuse the later one
+static int record_loan(LibraryJournal *journal,
+                       Library *library,
+                       JournalRecordType type,
+                       int member_id,
+                       int book_id)
+{
+    if (!journal_is_open(journal, library))
+    {
+        return 0;
+    }
+
+    Payload payload = {{0}, 0};
+    payload_int(&payload, member_id);
+    payload_int(&payload, book_id);
+    pthread_mutex_lock(&journal->lock);
+    int applied = type == JOURNAL_BORROW_BOOK
+                      ? borrow_book(library, member_id, book_id)
+                      : return_book(library, member_id, book_id);
+    int recorded = applied && append_record(journal, library, type, &payload);
+    pthread_mutex_unlock(&journal->lock);
+    return recorded;
+}
+
+int journal_borrow_book(LibraryJournal *journal,
+                        Library *library,
+                        int member_id,
+                        int book_id)
+{
+    return record_loan(
+        journal, library, JOURNAL_BORROW_BOOK, member_id, book_id);
+}
+
+int journal_return_book(LibraryJournal *journal,
+                        Library *library,
+                        int member_id,
+                        int book_id)
+{
+    return record_loan(
+        journal, library, JOURNAL_RETURN_BOOK, member_id, book_id);
+}
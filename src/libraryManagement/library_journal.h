@@ -0,0 +1,102 @@
+// include/library_journal.h
+#ifndef LIBRARY_JOURNAL_H
+#define LIBRARY_JOURNAL_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "background_snapshot.h"
+#include "../include/structures.h"
+
+// Journal layout (little-endian): a 16-byte header of magic "BKJOURNL",
+// u32 version and u32 reserved, then records of
+//   u32 payload_length, u32 crc, u64 lsn, u8 type, payload
+// where crc covers lsn, type and payload. Strings in payloads are a u8
+// length followed by the bytes.
+#define JOURNAL_MAGIC "BKJOURNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 16
+#define DEFAULT_GROUP_COMMIT_RECORDS 64
+#define DEFAULT_GROUP_COMMIT_INTERVAL_MS 50
+#define DEFAULT_CHECKPOINT_RECORDS 100000
+
+typedef enum
+{
+    JOURNAL_ADD_BOOK = 1,
+    JOURNAL_REMOVE_BOOK = 2,
+    JOURNAL_ADD_MEMBER = 3,
+    JOURNAL_REMOVE_MEMBER = 4,
+    JOURNAL_BORROW_BOOK = 5,
+    JOURNAL_RETURN_BOOK = 6
+} JournalRecordType;
+
+typedef struct
+{
+    // Held from applying an operation to the library until its record is
+    // appended, so records are in the order the operations took effect
+    pthread_mutex_t lock;
+    int fd;
+    char *journal_path;
+    char *snapshot_path;
+    unsigned char *buffer;
+    size_t buffered;
+    size_t capacity;
+    uint64_t next_lsn;
+    // Records are written and fsync'ed together once this many are pending
+    // or the oldest pending one is this old; a crash loses at most that
+    int group_commit_records;
+    int group_commit_interval_ms;
+    int pending_records;
+    long long oldest_pending_ms;
+    // Records between automatic checkpoints (0 = only on request). These
+    // run in the background; once the snapshot is in place the records it
+    // covers are dropped from the journal.
+    int checkpoint_records;
+    int records_since_checkpoint;
+    BackgroundSnapshot background;
+    int replayed_records;
+} LibraryJournal;
+
+// Opens or creates the journal and replays every record newer than
+// library->journal_lsn into library. A torn or corrupt tail left by a
+// crash is cut off. snapshot_path (may be NULL) is where checkpoints go.
+int journal_open(LibraryJournal *journal,
+                 const char *journal_path,
+                 const char *snapshot_path,
+                 Library *library);
+// Flushes pending records, waits for a background checkpoint and closes
+// the journal
+int journal_close(LibraryJournal *journal);
+int journal_sync(LibraryJournal *journal);
+// Writes library to the snapshot path with save_library_to_file and then
+// empties the journal
+int journal_checkpoint(LibraryJournal *journal, Library *library);
+
+// Apply an operation to library and record it. Operations that fail or
+// change nothing are not recorded. The operation is applied before it is
+// recorded: when recording fails, 0 is returned but the change stays in
+// library, and only the next checkpoint makes it durable. Operations on
+// one journal may be called from several threads.
+int journal_add_book(LibraryJournal *journal,
+                     Library *library,
+                     const char *title,
+                     const char *author,
+                     const char *isbn);
+int journal_remove_book(LibraryJournal *journal, Library *library, int ident);
+int journal_add_member(LibraryJournal *journal,
+                       Library *library,
+                       const char *name,
+                       const char *email);
+int journal_remove_member(LibraryJournal *journal,
+                          Library *library,
+                          int ident);
+int journal_borrow_book(LibraryJournal *journal,
+                        Library *library,
+                        int member_id,
+                        int book_id);
+int journal_return_book(LibraryJournal *journal,
+                        Library *library,
+                        int member_id,
+                        int book_id);
+
+#endif
@@ -0,0 +1,353 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "library_lazy.h"
+#include "../indexManagement/crc32.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define LAZY_BOOKS 0
+#define LAZY_MEMBERS 1
+
+static const uint32_t record_sizes[2] = {BOOK_RECORD_SIZE, MEMBER_RECORD_SIZE};
+
+static uint32_t page_count(uint32_t num_records)
+{
+    return (num_records + LIBRARY_FILE_PAGE_RECORDS - 1) /
+           LIBRARY_FILE_PAGE_RECORDS;
+}
+
+static uint32_t records_on_page(const LazySection *section, uint32_t page)
+{
+    uint32_t remaining = section->section.count -
+                         page * LIBRARY_FILE_PAGE_RECORDS;
+    return remaining < LIBRARY_FILE_PAGE_RECORDS ? remaining
+                                                 : LIBRARY_FILE_PAGE_RECORDS;
+}
+
+static size_t struct_size(int which)
+{
+    return which == LAZY_BOOKS ? sizeof(Book) : sizeof(Member);
+}
+
+static int open_section(LazyLibrary *library,
+                        const LibraryFileTable *table,
+                        int which,
+                        uint32_t records_type,
+                        uint32_t pages_type)
+{
+    const SectionEntry *records =
+        library_file_find_section(table, records_type);
+    const SectionEntry *pages = library_file_find_section(table, pages_type);
+    LazySection *section = &library->sections[which];
+    if (library_file_find_section(table, SECTION_BOOKS_PACKED) ||
+        library_file_find_section(table, SECTION_MEMBERS_PACKED))
+    {
+        fprintf(stderr, "Packed library files cannot be opened lazily\n");
+        syslog(LOG_ERR, "Packed library files cannot be opened lazily\n");
+        return 0;
+    }
+    if (!records)
+    {
+        return 1;
+    }
+    if (!pages || records->record_size != record_sizes[which] ||
+        records->length != (uint64_t)records->count * record_sizes[which] ||
+        pages->count != page_count(records->count))
+    {
+        fprintf(stderr, "Library file has no usable page index\n");
+        syslog(LOG_ERR, "Library file has no usable page index\n");
+        return 0;
+    }
+
+    section->section = *records;
+    section->num_pages = pages->count;
+    section->pages =
+        (PageSummary *)malloc((pages->count ? pages->count : 1) *
+                              sizeof(PageSummary));
+    if (!section->pages)
+    {
+        fprintf(stderr, "Memory allocation failed for page index\n");
+        syslog(LOG_ERR, "Memory allocation failed for page index\n");
+        return 0;
+    }
+    return library_file_read_pages(library->file, pages, section->pages);
+}
+
+LazyLibrary *open_library_lazily(const char *filename, int cache_pages)
+{
+    if (!filename || cache_pages < 0)
+    {
+        fprintf(stderr, "Open Library Lazily Filename or Cache is invalid\n");
+        syslog(LOG_ERR, "Open Library Lazily Filename or Cache is invalid\n");
+        return NULL;
+    }
+
+    LazyLibrary *library = (LazyLibrary *)calloc(1, sizeof(LazyLibrary));
+    if (!library)
+    {
+        fprintf(stderr, "Memory allocation failed for lazy library\n");
+        syslog(LOG_ERR, "Memory allocation failed for lazy library\n");
+        return NULL;
+    }
+    library->cache_pages = cache_pages ? cache_pages : LAZY_DEFAULT_CACHE_PAGES;
+    library->file = fopen(filename, "rb");
+    if (!library->file)
+    {
+        fprintf(stderr, "Failed to open file for reading\n");
+        syslog(LOG_ERR, "Failed to open file for reading\n");
+        close_lazy_library(library);
+        return NULL;
+    }
+
+    LibraryFileTable table;
+    Library meta = {0};
+    const SectionEntry *meta_section = NULL;
+    library->cache =
+        (LazyPage *)calloc((size_t)library->cache_pages, sizeof(LazyPage));
+    library->scratch = (unsigned char *)malloc(
+        (size_t)LIBRARY_FILE_PAGE_RECORDS * BOOK_RECORD_SIZE);
+    if (!library->cache || !library->scratch ||
+        !library_file_read_table(library->file, &table) ||
+        !open_section(
+            library, &table, LAZY_BOOKS, SECTION_BOOKS, SECTION_BOOK_PAGES) ||
+        !open_section(library,
+                      &table,
+                      LAZY_MEMBERS,
+                      SECTION_MEMBERS,
+                      SECTION_MEMBER_PAGES) ||
+        ((meta_section = library_file_find_section(&table, SECTION_META)) &&
+         !library_file_read_meta(library->file, meta_section, &meta)))
+    {
+        fprintf(stderr, "Failed to open %s lazily\n", filename);
+        syslog(LOG_ERR, "Failed to open %s lazily\n", filename);
+        close_lazy_library(library);
+        return NULL;
+    }
+    for (int i = 0; i < library->cache_pages; i++)
+    {
+        library->cache[i].section = -1;
+    }
+    library->journal_lsn = meta.journal_lsn;
+    syslog(LOG_INFO, "Opened %s lazily\n", filename);
+    return library;
+}
+
+void close_lazy_library(LazyLibrary *library)
+{
+    if (!library)
+    {
+        return;
+    }
+    if (library->file)
+    {
+        fclose(library->file);
+    }
+    for (int i = 0; library->cache && i < library->cache_pages; i++)
+    {
+        free(library->cache[i].records);
+    }
+    free(library->cache);
+    free(library->scratch);
+    free(library->sections[LAZY_BOOKS].pages);
+    free(library->sections[LAZY_MEMBERS].pages);
+    free(library);
+}
+
+// Second-chance clock: skip frames used since the hand last passed them
+static LazyPage *claim_frame(LazyLibrary *library)
+{
+    while (1)
+    {
+        LazyPage *frame = &library->cache[library->clock_hand];
+        library->clock_hand = (library->clock_hand + 1) % library->cache_pages;
+        if (frame->section < 0 || !frame->referenced)
+        {
+            return frame;
+        }
+        frame->referenced = 0;
+    }
+}
+
+static int read_page(LazyLibrary *library,
+                     int which,
+                     uint32_t page,
+                     LazyPage *frame)
+{
+    const LazySection *section = &library->sections[which];
+    uint32_t record_size = record_sizes[which];
+    uint32_t first = page * LIBRARY_FILE_PAGE_RECORDS;
+    uint32_t count = records_on_page(section, page);
+    size_t length = (size_t)count * record_size;
+    uint64_t offset = section->section.offset + (uint64_t)first * record_size;
+
+    if (!frame->records)
+    {
+        frame->records = malloc((size_t)LIBRARY_FILE_PAGE_RECORDS *
+                                (sizeof(Book) > sizeof(Member)
+                                     ? sizeof(Book)
+                                     : sizeof(Member)));
+    }
+    frame->section = -1;
+    if (!frame->records || offset > INT64_MAX ||
+        pread(fileno(library->file), library->scratch, length, (off_t)offset) !=
+            (ssize_t)length)
+    {
+        fprintf(stderr, "Failed to read library page %u\n", page);
+        syslog(LOG_ERR, "Failed to read library page %u\n", page);
+        return 0;
+    }
+    if (crc32_update(0, library->scratch, length) != section->pages[page].crc)
+    {
+        fprintf(stderr, "Library page %u is corrupt\n", page);
+        syslog(LOG_ERR, "Library page %u is corrupt\n", page);
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const unsigned char *record = library->scratch + i * record_size;
+        if (which == LAZY_BOOKS)
+        {
+            decode_book_record(record, &((Book *)frame->records)[i]);
+        }
+        else
+        {
+            decode_member_record(record, &((Member *)frame->records)[i]);
+        }
+    }
+    frame->section = which;
+    frame->page = page;
+    library->page_reads++;
+    return 1;
+}
+
+static void *fetch_page(LazyLibrary *library, int which, uint32_t page)
+{
+    for (int i = 0; i < library->cache_pages; i++)
+    {
+        LazyPage *frame = &library->cache[i];
+        if (frame->section == which && frame->page == page)
+        {
+            frame->referenced = 1;
+            library->cache_hits++;
+            return frame->records;
+        }
+    }
+
+    LazyPage *frame = claim_frame(library);
+    if (!read_page(library, which, page, frame))
+    {
+        return NULL;
+    }
+    frame->referenced = 1;
+    return frame->records;
+}
+
+static const void *record_at(LazyLibrary *library, int which, int index)
+{
+    if (!library || index < 0 ||
+        (uint32_t)index >= library->sections[which].section.count)
+    {
+        return NULL;
+    }
+    const unsigned char *records = (const unsigned char *)fetch_page(
+        library, which, (uint32_t)index / LIBRARY_FILE_PAGE_RECORDS);
+    uint32_t slot = (uint32_t)index % LIBRARY_FILE_PAGE_RECORDS;
+    return records ? records + slot * struct_size(which) : NULL;
+}
+
+// IDs are normally ascending through the file, so usually one page spans
+// the ID; imported IDs can leave a few overlapping pages to try
+static const void *find_by_id(LazyLibrary *library, int which, int identity)
+{
+    if (!library || identity <= 0)
+    {
+        return NULL;
+    }
+    const LazySection *section = &library->sections[which];
+    for (uint32_t page = 0; page < section->num_pages; page++)
+    {
+        if ((uint32_t)identity < section->pages[page].min_ident ||
+            (uint32_t)identity > section->pages[page].max_ident)
+        {
+            continue;
+        }
+        const unsigned char *records =
+            (const unsigned char *)fetch_page(library, which, page);
+        if (!records)
+        {
+            return NULL;
+        }
+        for (uint32_t i = 0; i < records_on_page(section, page); i++)
+        {
+            const void *record = records + i * struct_size(which);
+            int ident = which == LAZY_BOOKS ? ((const Book *)record)->ident
+                                            : ((const Member *)record)->ident;
+            if (ident == identity)
+            {
+                return record;
+            }
+        }
+    }
+    return NULL;
+}
+
+int lazy_count_books(const LazyLibrary *library)
+{
+    return library ? (int)library->sections[LAZY_BOOKS].section.count : 0;
+}
+
+int lazy_count_members(const LazyLibrary *library)
+{
+    return library ? (int)library->sections[LAZY_MEMBERS].section.count : 0;
+}
+
+int lazy_available_books(const LazyLibrary *library)
+{
+    int available = 0;
+    for (uint32_t i = 0; library && i < library->sections[LAZY_BOOKS].num_pages;
+         i++)
+    {
+        available += (int)library->sections[LAZY_BOOKS].pages[i].tally;
+    }
+    return available;
+}
+
+void print_lazy_library_statistics(const LazyLibrary *library)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Print Library Statistics Library pointer is NULL\n");
+        syslog(LOG_ERR, "Print Library Statistics Library pointer is NULL\n");
+        return;
+    }
+    int available_books = lazy_available_books(library);
+    printf("\nLibrary Statistics:\n");
+    printf("Total Books: %d\n", lazy_count_books(library));
+    printf("Total Members: %d\n", lazy_count_members(library));
+    printf("Available Books: %d\n", available_books);
+    printf("Borrowed Books: %d\n", lazy_count_books(library) - available_books);
+    printf("-----------------\n");
+}
+
+const Book *lazy_find_book_by_id(LazyLibrary *library, int identity)
+{
+    return (const Book *)find_by_id(library, LAZY_BOOKS, identity);
+}
+
+const Member *lazy_find_member_by_id(LazyLibrary *library, int identity)
+{
+    return (const Member *)find_by_id(library, LAZY_MEMBERS, identity);
+}
+
+const Book *lazy_book_at(LazyLibrary *library, int index)
+{
+    return (const Book *)record_at(library, LAZY_BOOKS, index);
+}
+
+const Member *lazy_member_at(LazyLibrary *library, int index)
+{
+    return (const Member *)record_at(library, LAZY_MEMBERS, index);
+}
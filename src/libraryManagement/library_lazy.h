@@ -0,0 +1,67 @@
+// include/library_lazy.h
+#ifndef LIBRARY_LAZY_H
+#define LIBRARY_LAZY_H
+
+#include <stdio.h>
+
+#include "../include/structures.h"
+#include "library_file.h"
+
+#define LAZY_DEFAULT_CACHE_PAGES 64
+
+typedef struct
+{
+    SectionEntry section;
+    PageSummary *pages;
+    uint32_t num_pages;
+} LazySection;
+
+typedef struct
+{
+    // Index into the library's sections, or -1 while the frame is free
+    int section;
+    uint32_t page;
+    int referenced;
+    void *records;
+} LazyPage;
+
+// A read-only view of a library file that keeps only the section table
+// and the page indexes in memory. Book and member records are read one
+// page (LIBRARY_FILE_PAGE_RECORDS records) at a time into a cache of
+// cache_pages frames, evicting with the clock algorithm, and each page is
+// checked against its CRC as it is read.
+typedef struct
+{
+    FILE *file;
+    LazySection sections[2];
+    LazyPage *cache;
+    int cache_pages;
+    int clock_hand;
+    unsigned char *scratch;
+    uint64_t journal_lsn;
+    long long page_reads;
+    long long cache_hits;
+} LazyLibrary;
+
+// Needs a record-encoded file with a page index (minor version 1 or
+// later); packed files and older files must be loaded in full. A
+// cache_pages of 0 selects LAZY_DEFAULT_CACHE_PAGES.
+LazyLibrary *open_library_lazily(const char *filename, int cache_pages);
+void close_lazy_library(LazyLibrary *library);
+
+int lazy_count_books(const LazyLibrary *library);
+int lazy_count_members(const LazyLibrary *library);
+// Answered from the page index without reading any record
+int lazy_available_books(const LazyLibrary *library);
+void print_lazy_library_statistics(const LazyLibrary *library);
+
+// Returned records live in the page cache and stay valid until the next
+// call that reads a page. They return NULL if the record does not exist
+// or its page could not be read.
+const Book *lazy_find_book_by_id(LazyLibrary *library, int identity);
+const Member *lazy_find_member_by_id(LazyLibrary *library, int identity);
+// Records in file order, for scans
+const Book *lazy_book_at(LazyLibrary *library, int index);
+const Member *lazy_member_at(LazyLibrary *library, int index);
+
+#endif
@@ -1,8 +1,22 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "library_management.h"
+#include "library_file.h"
+#include "library_snapshot.h"
+#include "../bookManagement/book_availability.h"
+#include "../bookManagement/book_columns.h"
 #include "../bookManagement/book_management.h"
+#include "../indexManagement/author_dictionary.h"
+#include "../indexManagement/bitset.h"
+#include "../indexManagement/growth_policy.h"
+#include "../indexManagement/hash_index.h"
+#include "../indexManagement/library_lock.h"
+#include "../indexManagement/token_index.h"
 #include "../memberManagement/member_management.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 
 void init_library(Library *library)
@@ -13,14 +27,28 @@ void init_library(Library *library)
         syslog(LOG_ERR, "Init Library pointer is NULL\n");
         return;
     }
+    memset(library, 0, sizeof(Library));
     library->books = (Book *)malloc(INITIAL_CAPACITY * sizeof(Book));
     library->members = (Member *)malloc(INITIAL_CAPACITY * sizeof(Member));
+    int indexed = hash_index_init(&library->book_index, INITIAL_CAPACITY);
+    indexed = token_index_init(&library->text_index, INITIAL_CAPACITY) &&
+              indexed;
+    indexed = hash_index_init(&library->isbn_index, INITIAL_CAPACITY) &&
+              indexed;
+    indexed = author_dictionary_init(&library->authors, INITIAL_CAPACITY) &&
+              indexed;
+    indexed = bitset_init(&library->available_books, INITIAL_CAPACITY) &&
+              indexed;
+    indexed = hash_index_init(&library->member_index, INITIAL_CAPACITY) &&
+              indexed;
 
-    if (!library->books || !library->members)
+    if (!library->books || !library->members || !indexed)
     {
         syslog(LOG_ERR, "Memory allocation failed for library contents\n");
         free(library->books);
         free(library->members);
+        deinit_book_indexes(library);
+        hash_index_deinit(&library->member_index);
         library->books = NULL;
         library->members = NULL;
         return;
@@ -28,8 +56,18 @@ void init_library(Library *library)
 
     library->num_books = 0;
     library->capacity_books = INITIAL_CAPACITY;
+    library->free_book_slots = NULL;
+    library->capacity_free_book_slots = 0;
+    library->num_free_books = 0;
     library->num_members = 0;
     library->capacity_members = INITIAL_CAPACITY;
+    library->free_member_slots = NULL;
+    library->capacity_free_member_slots = 0;
+    library->num_free_members = 0;
+    library->isbn_duplicate_policy = ISBN_DUPLICATE_REJECT;
+    library->removal_mode = REMOVAL_SHIFT;
+    library->compaction_threshold = DEFAULT_COMPACTION_THRESHOLD;
+    library->growth_policy.factor_percent = DEFAULT_GROWTH_FACTOR_PERCENT;
 }
 
 void deinit_library(Library *library)
@@ -51,8 +89,15 @@ void deinit_library(Library *library)
         deinit_member(&library->members[i]);
     }
 
+    unmap_library_snapshot(library);
     free(library->books);
     free(library->members);
+    free(library->free_book_slots);
+    free(library->free_member_slots);
+    disable_book_columns(library);
+    deinit_book_indexes(library);
+    hash_index_deinit(&library->member_index);
+    library_lock_destroy(library);
 
     library->books = NULL;
     library->members = NULL;
@@ -60,6 +105,12 @@ void deinit_library(Library *library)
     library->num_members = 0;
     library->capacity_books = 0;
     library->capacity_members = 0;
+    library->free_book_slots = NULL;
+    library->capacity_free_book_slots = 0;
+    library->num_free_books = 0;
+    library->free_member_slots = NULL;
+    library->capacity_free_member_slots = 0;
+    library->num_free_members = 0;
 }
 
 Library *create_library(void)
@@ -96,6 +147,91 @@ void delete_library(Library *library)
    // free(library);
 }
 
+static int library_reserve_unlocked(Library *library,
+                                   int num_books,
+                                   int num_members)
+{
+    if (!library || num_books < 0 || num_members < 0)
+    {
+        fprintf(stderr, "Invalid parameters for reserving library capacity\n");
+        syslog(LOG_ERR, "Invalid parameters for reserving library capacity\n");
+        return 0;
+    }
+
+    int reserved = reserve_books(library, num_books) &&
+                   reserve_members(library, num_members);
+    if (reserved && hash_index_is_built(&library->book_index))
+    {
+        reserved = hash_index_reserve(&library->book_index, num_books);
+    }
+    if (reserved && hash_index_is_built(&library->isbn_index))
+    {
+        reserved = hash_index_reserve(&library->isbn_index, num_books);
+    }
+    if (reserved && hash_index_is_built(&library->member_index))
+    {
+        reserved = hash_index_reserve(&library->member_index, num_members);
+    }
+    if (reserved)
+    {
+        syslog(LOG_INFO,
+               "Reserved capacity for %d books and %d members\n",
+               library->capacity_books,
+               library->capacity_members);
+    }
+    return reserved;
+}
+
+int library_reserve(Library *library, int num_books, int num_members)
+{
+    library_lock_exclusive(library);
+    int reserved = library_reserve_unlocked(library, num_books, num_members);
+    library_unlock_exclusive(library);
+    return reserved;
+}
+
+int enable_library_concurrency(Library *library)
+{
+    if (!library_lock_create(library))
+    {
+        return 0;
+    }
+    syslog(LOG_INFO, "Enabled concurrent access to library\n");
+    return 1;
+}
+
+void disable_library_concurrency(Library *library)
+{
+    library_lock_destroy(library);
+}
+
+int set_library_growth_policy(Library *library, const GrowthPolicy *policy)
+{
+    if (!library || !growth_policy_is_valid(policy))
+    {
+        fprintf(stderr, "Invalid library growth policy\n");
+        syslog(LOG_ERR, "Invalid library growth policy\n");
+        return 0;
+    }
+    library->growth_policy = *policy;
+    return 1;
+}
+
+void compact_library(Library *library)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Compact Library pointer is NULL\n");
+        syslog(LOG_ERR, "Compact Library pointer is NULL\n");
+        return;
+    }
+    compact_books(library);
+    compact_members(library);
+}
+
+// Tombstoned slots are skipped by writing each run of live records at once.
+// The file is written beside the target and renamed over it, so a library
+// mapped from the target keeps reading the old file until it is released.
 int save_library_to_file(const Library *library, const char *filename)
 {
     if (!library || !filename)
@@ -107,26 +243,55 @@ int save_library_to_file(const Library *library, const char *filename)
         return 0;
     }
 
-    FILE *file = fopen(filename, "wb");
+    size_t length = strlen(filename);
+    char *temp_path = (char *)malloc(length + sizeof(".tmp"));
+    if (!temp_path)
+    {
+        fprintf(stderr, "Memory allocation failed for save path\n");
+        syslog(LOG_ERR, "Memory allocation failed for save path\n");
+        return 0;
+    }
+    memcpy(temp_path, filename, length);
+    memcpy(&temp_path[length], ".tmp", sizeof(".tmp"));
+
+    FILE *file = fopen(temp_path, "wb");
     if (!file)
     {
         fprintf(stderr, "Failed to open file for writing\n");
         syslog(LOG_ERR, "Failed to open file for writing\n");
+        free(temp_path);
         return 0;
     }
 
-    fwrite(&library->num_books, sizeof(int), 1, file);
-    fwrite(&library->num_members, sizeof(int), 1, file);
-    fwrite(library->books, sizeof(Book), (size_t)library->num_books, file);
-    fwrite(library->members,
-           sizeof(Member),
-           (size_t)library->num_members,
-           file);
-
-    fclose(file);
+    library_lock_exclusive(library);
+    int written = library_file_write(library, file);
+    library_unlock_exclusive(library);
+    written = written && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (fclose(file) != 0 || !written || rename(temp_path, filename) != 0)
+    {
+        fprintf(stderr, "Failed to write library file\n");
+        syslog(LOG_ERR, "Failed to write library file\n");
+        remove(temp_path);
+        free(temp_path);
+        return 0;
+    }
+    free(temp_path);
     return 1;
 }
 
+void advance_library_generation(Library *library)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Advance Generation Library pointer is NULL\n");
+        syslog(LOG_ERR, "Advance Generation Library pointer is NULL\n");
+        return;
+    }
+    library_lock_exclusive(library);
+    library->generation++;
+    library_unlock_exclusive(library);
+}
+
 Library *load_library_from_file(const char *filename)
 {
     if (!filename)
@@ -153,66 +318,75 @@ Library *load_library_from_file(const char *filename)
         return NULL;
     }
 
-    int num_books = -1;
-    int num_members = -1;
+    LibraryFileTable table;
+    if (!library_file_read_table(file, &table))
+    {
+        delete_library(library);
+        fclose(file);
+        return NULL;
+    }
 
-    if (fread(&num_books, sizeof(int), 1, file) != 1 ||
-        fread(&num_members, sizeof(int), 1, file) != 1)
+    // Persisted indexes replace the empty ones before anything is sized
+    const SectionEntry *generation =
+        library_file_find_section(&table, SECTION_GENERATION);
+    int restored_books = 0;
+    int restored_members = 0;
+    if (generation && library_file_read_generation(file, generation, library))
     {
-        fprintf(stderr, "Failed to read number of books and members\n");
-        syslog(LOG_ERR, "Failed to read number of books and members\n");
+        restored_books = library_file_read_book_indexes(file, &table, library);
+        restored_members =
+            library_file_read_member_index(file, &table, library);
+    }
+
+    // The section table gives the exact counts, so allocate once
+    const SectionEntry *books =
+        library_file_find_section(&table, SECTION_BOOKS);
+    const SectionEntry *members =
+        library_file_find_section(&table, SECTION_MEMBERS);
+    books = books ? books
+                  : library_file_find_section(&table, SECTION_BOOKS_PACKED);
+    members = members
+                  ? members
+                  : library_file_find_section(&table, SECTION_MEMBERS_PACKED);
+    const SectionEntry *authors =
+        library_file_find_section(&table, SECTION_AUTHORS);
+    const SectionEntry *meta = library_file_find_section(&table, SECTION_META);
+    const SectionEntry *id_marks =
+        library_file_find_section(&table, SECTION_ID_MARKS);
+    uint32_t num_books = books ? books->count : 0;
+    uint32_t num_members = members ? members->count : 0;
+    if (num_books > INT32_MAX || num_members > INT32_MAX ||
+        !library_reserve(library, (int)num_books, (int)num_members))
+    {
+        fprintf(stderr, "Failed to allocate memory for library contents\n");
+        syslog(LOG_ERR, "Failed to allocate memory for library contents\n");
         delete_library(library);
         fclose(file);
         return NULL;
     }
 
-    // Ensure capacity for loaded data
-    while (library->capacity_books < num_books)
-    {
-        library->capacity_books *= 2;
-        Book *new_books =
-            realloc(library->books,
-                    (size_t)library->capacity_books * sizeof(Book));
-        if (!new_books)
-        {
-            fprintf(stderr, "Failed to allocate memory for books\n");
-            syslog(LOG_ERR, "Failed to allocate memory for books\n");
-            delete_library(library);
-            fclose(file);
-            return NULL;
-        }
-        library->books = new_books;
-    }
-
-    while (library->capacity_members < num_members)
-    {
-        library->capacity_members *= 2;
-        Member *new_members =
-            realloc(library->members,
-                    (size_t)library->capacity_members * sizeof(Member));
-        if (!new_members)
-        {
-            fprintf(stderr, "Failed to allocate memory for members\n");
-            syslog(LOG_ERR, "Failed to allocate memory for members\n");
-            delete_library(library);
-            fclose(file);
-            return NULL;
-        }
-        library->members = new_members;
-    }
-
-    if (fread(library->books, sizeof(Book), (size_t)num_books, file) !=
-            (size_t)num_books ||
-        fread(library->members, sizeof(Member), (size_t)num_members, file) !=
-            (size_t)num_members)
+    if ((books && !library_file_read_books(file, books, library)) ||
+        (members && !library_file_read_members(file, members, library)) ||
+        (authors && !library_file_read_authors(file, authors, library)) ||
+        (meta && !library_file_read_meta(file, meta, library)) ||
+        (id_marks && !library_file_read_id_marks(file, id_marks)))
     {
+        fprintf(stderr, "Failed to read library file sections\n");
+        syslog(LOG_ERR, "Failed to read library file sections\n");
         delete_library(library);
         fclose(file);
         return NULL;
     }
 
-    library->num_books = num_books;
-    library->num_members = num_members;
+    if (!rebuild_book_indexes(library, BOOK_INDEX_ALL & ~restored_books) ||
+        (!restored_members && !rebuild_member_index(library)))
+    {
+        fprintf(stderr, "Failed to build library indexes\n");
+        syslog(LOG_ERR, "Failed to build library indexes\n");
+        delete_library(library);
+        fclose(file);
+        return NULL;
+    }
 
     fclose(file);
     return library;
@@ -227,19 +401,12 @@ void print_library_statistics(const Library *library)
         return;
     }
     printf("\nLibrary Statistics:\n");
-    printf("Total Books: %d\n", library->num_books);
-    printf("Total Members: %d\n", library->num_members);
+    printf("Total Books: %d\n", count_books(library));
+    printf("Total Members: %d\n", count_members(library));
 
-    int available_books = 0;
-    for (int i = 0; i < library->num_books; i++)
-    {
-        if (library->books[i].is_available)
-        {
-            available_books++;
-        }
-    }
+    int available_books = available_book_total(library);
 
     printf("Available Books: %d\n", available_books);
-    printf("Borrowed Books: %d\n", library->num_books - available_books);
+    printf("Borrowed Books: %d\n", count_books(library) - available_books);
     printf("-----------------\n");
 }
@@ -7,7 +7,28 @@ void init_library(Library *library);
 void deinit_library(Library *library);
 Library *create_library(void);
 void delete_library(Library *library);
+// Pre-sizes the book and member arrays and their ID indexes for the given
+// totals so that known volumes can be loaded without regrowing
+int library_reserve(Library *library, int num_books, int num_members);
+// Makes the library safe to share between threads (see library_lock.h).
+// Book, member and library functions that change the library lock it
+// themselves; pointers returned by lookups such as find_book_by_id stay
+// valid only while the caller holds library_lock_shared. Choose policies,
+// modes and columns before enabling, and disable only once the other
+// threads are done.
+int enable_library_concurrency(Library *library);
+void disable_library_concurrency(Library *library);
+int set_library_growth_policy(Library *library, const GrowthPolicy *policy);
+void compact_library(Library *library);
+// Writes "<filename>.tmp", fsyncs it and renames it over filename, so
+// readers, including libraries mapped from filename, see either the old
+// file or the complete new one. The file is stamped with generation
+// library->generation + 1.
 int save_library_to_file(const Library *library, const char *filename);
+// Moves library on to the generation its last save wrote, so that the next
+// save writes a newer one; call after a successful save_library_to_file or
+// save_library_shards of a library that stays in use
+void advance_library_generation(Library *library);
 Library *load_library_from_file(const char *filename);
 void print_library_statistics(const Library *library);
 
@@ -0,0 +1,384 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "library_shards.h"
+#include "library_file.h"
+#include "library_management.h"
+#include "../bookManagement/book_management.h"
+#include "../indexManagement/token_index.h"
+#include "../memberManagement/member_management.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    FILE *file;
+    LibraryFileTable table;
+    const SectionEntry *books;
+    const SectionEntry *members;
+    // Borrows its slice of the merged arrays; owns only its text index
+    Library view;
+    int decoded;
+} Shard;
+
+typedef struct
+{
+    Shard *shards;
+    int num_shards;
+    int next_shard;
+    pthread_mutex_t lock;
+} ShardLoad;
+
+static char *shard_path(const char *prefix, int shard)
+{
+    size_t length = strlen(prefix) + 16;
+    char *path = (char *)malloc(length);
+    if (!path)
+    {
+        fprintf(stderr, "Memory allocation failed for shard path\n");
+        syslog(LOG_ERR, "Memory allocation failed for shard path\n");
+        return NULL;
+    }
+    snprintf(path, length, "%s.%d", prefix, shard);
+    return path;
+}
+
+// Width of each shard's ID slice, so that (ident - 1) / span < num_shards
+static int shard_span(int highest_ident, int num_shards)
+{
+    int span = highest_ident / num_shards +
+               (highest_ident % num_shards ? 1 : 0);
+    return span > 0 ? span : 1;
+}
+
+int save_library_shards(const Library *library,
+                        const char *prefix,
+                        int num_shards)
+{
+    if (!library || !prefix || num_shards < 1 ||
+        num_shards > MAX_LIBRARY_SHARDS)
+    {
+        fprintf(stderr, "Save Library Shards Library or Shards is invalid\n");
+        syslog(LOG_ERR, "Save Library Shards Library or Shards is invalid\n");
+        return 0;
+    }
+
+    int highest_book = 0;
+    int highest_member = 0;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        highest_book = library->books[i].ident > highest_book
+                           ? library->books[i].ident
+                           : highest_book;
+    }
+    for (int i = 0; i < library->num_members; i++)
+    {
+        highest_member = library->members[i].ident > highest_member
+                             ? library->members[i].ident
+                             : highest_member;
+    }
+    int book_span = shard_span(highest_book, num_shards);
+    int member_span = shard_span(highest_member, num_shards);
+
+    // Size the scratch arrays for the largest shard
+    int book_counts[MAX_LIBRARY_SHARDS] = {0};
+    int member_counts[MAX_LIBRARY_SHARDS] = {0};
+    int most_books = 1;
+    int most_members = 1;
+    for (int i = 0; i < library->num_books; i++)
+    {
+        if (library->books[i].ident != 0)
+        {
+            int shard = (library->books[i].ident - 1) / book_span;
+            most_books = ++book_counts[shard] > most_books ? book_counts[shard]
+                                                           : most_books;
+        }
+    }
+    for (int i = 0; i < library->num_members; i++)
+    {
+        if (library->members[i].ident != 0)
+        {
+            int shard = (library->members[i].ident - 1) / member_span;
+            most_members = ++member_counts[shard] > most_members
+                               ? member_counts[shard]
+                               : most_members;
+        }
+    }
+
+    Library view = {0};
+    view.books = (Book *)malloc((size_t)most_books * sizeof(Book));
+    view.members = (Member *)malloc((size_t)most_members * sizeof(Member));
+    view.journal_lsn = library->journal_lsn;
+    view.generation = library->generation;
+    view.file_encoding = library->file_encoding;
+    int saved = view.books && view.members;
+    if (!saved)
+    {
+        fprintf(stderr, "Memory allocation failed for library shard\n");
+        syslog(LOG_ERR, "Memory allocation failed for library shard\n");
+    }
+
+    for (int shard = 0; saved && shard < num_shards; shard++)
+    {
+        view.num_books = 0;
+        view.num_members = 0;
+        for (int i = 0; i < library->num_books; i++)
+        {
+            int ident = library->books[i].ident;
+            if (ident != 0 && (ident - 1) / book_span == shard)
+            {
+                view.books[view.num_books++] = library->books[i];
+            }
+        }
+        for (int i = 0; i < library->num_members; i++)
+        {
+            int ident = library->members[i].ident;
+            if (ident != 0 && (ident - 1) / member_span == shard)
+            {
+                view.members[view.num_members++] = library->members[i];
+            }
+        }
+        view.capacity_books = view.num_books;
+        view.capacity_members = view.num_members;
+
+        char *path = shard_path(prefix, shard);
+        saved = path && save_library_to_file(&view, path);
+        free(path);
+    }
+
+    free(view.books);
+    free(view.members);
+    if (saved)
+    {
+        syslog(LOG_INFO,
+               "Library saved to %d shards %s.*\n",
+               num_shards,
+               prefix);
+    }
+    return saved;
+}
+
+static int open_shard(Shard *shard, const char *prefix, int index)
+{
+    char *path = shard_path(prefix, index);
+    shard->file = path ? fopen(path, "rb") : NULL;
+    if (!shard->file)
+    {
+        fprintf(stderr, "Failed to open shard %s\n", path ? path : prefix);
+        syslog(LOG_ERR, "Failed to open shard %s\n", path ? path : prefix);
+        free(path);
+        return 0;
+    }
+    free(path);
+
+    if (!library_file_read_table(shard->file, &shard->table))
+    {
+        return 0;
+    }
+    const LibraryFileTable *table = &shard->table;
+    shard->books = library_file_find_section(table, SECTION_BOOKS);
+    shard->books = shard->books ? shard->books
+                                : library_file_find_section(
+                                      table, SECTION_BOOKS_PACKED);
+    shard->members = library_file_find_section(table, SECTION_MEMBERS);
+    shard->members = shard->members ? shard->members
+                                    : library_file_find_section(
+                                          table, SECTION_MEMBERS_PACKED);
+    const SectionEntry *meta = library_file_find_section(table, SECTION_META);
+    const SectionEntry *id_marks =
+        library_file_find_section(table, SECTION_ID_MARKS);
+    const SectionEntry *generation =
+        library_file_find_section(table, SECTION_GENERATION);
+    return (!meta ||
+            library_file_read_meta(shard->file, meta, &shard->view)) &&
+           (!id_marks || library_file_read_id_marks(shard->file, id_marks)) &&
+           (!generation || library_file_read_generation(
+                               shard->file, generation, &shard->view));
+}
+
+static int decode_shard(Shard *shard)
+{
+    Library *view = &shard->view;
+    if ((shard->books &&
+         !library_file_read_books(shard->file, shard->books, view)) ||
+        (shard->members &&
+         !library_file_read_members(shard->file, shard->members, view)) ||
+        !token_index_init(&view->text_index, view->num_books))
+    {
+        return 0;
+    }
+    for (int i = 0; i < view->num_books; i++)
+    {
+        const Book *book = &view->books[i];
+        if (book->ident != 0 &&
+            (!token_index_add_document(
+                 &view->text_index, book->ident, book->title) ||
+             !token_index_add_document(
+                 &view->text_index, book->ident, book->author)))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void *load_shards(void *argument)
+{
+    ShardLoad *load = (ShardLoad *)argument;
+    while (1)
+    {
+        pthread_mutex_lock(&load->lock);
+        int shard = load->next_shard++;
+        pthread_mutex_unlock(&load->lock);
+        if (shard >= load->num_shards)
+        {
+            return NULL;
+        }
+        load->shards[shard].decoded = decode_shard(&load->shards[shard]);
+    }
+}
+
+// Runs load_shards on num_threads - 1 new threads and the caller's
+static void run_shard_load(ShardLoad *load, int num_threads)
+{
+    pthread_t threads[MAX_LIBRARY_SHARDS];
+    int started = 0;
+    while (started < num_threads - 1 &&
+           pthread_create(&threads[started], NULL, load_shards, load) == 0)
+    {
+        started++;
+    }
+    load_shards(load);
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+// Lays the shards' records out back to back in the library's arrays
+static int place_shards(Library *library, Shard *shards, int num_shards)
+{
+    uint64_t total_books = 0;
+    uint64_t total_members = 0;
+    for (int i = 0; i < num_shards; i++)
+    {
+        total_books += shards[i].books ? shards[i].books->count : 0;
+        total_members += shards[i].members ? shards[i].members->count : 0;
+        if (shards[i].view.journal_lsn != shards[0].view.journal_lsn ||
+            shards[i].view.generation != shards[0].view.generation)
+        {
+            fprintf(stderr, "Library shards come from different saves\n");
+            syslog(LOG_ERR, "Library shards come from different saves\n");
+            return 0;
+        }
+    }
+    if (total_books > INT32_MAX || total_members > INT32_MAX ||
+        !library_reserve(library, (int)total_books, (int)total_members))
+    {
+        fprintf(stderr, "Failed to allocate memory for library contents\n");
+        syslog(LOG_ERR, "Failed to allocate memory for library contents\n");
+        return 0;
+    }
+
+    int book_offset = 0;
+    int member_offset = 0;
+    for (int i = 0; i < num_shards; i++)
+    {
+        Library *view = &shards[i].view;
+        view->books = library->books + book_offset;
+        view->capacity_books = shards[i].books ? (int)shards[i].books->count
+                                               : 0;
+        view->members = library->members + member_offset;
+        view->capacity_members =
+            shards[i].members ? (int)shards[i].members->count : 0;
+        book_offset += view->capacity_books;
+        member_offset += view->capacity_members;
+    }
+    library->num_books = book_offset;
+    library->num_members = member_offset;
+    library->journal_lsn = shards[0].view.journal_lsn;
+    library->generation = shards[0].view.generation;
+    return 1;
+}
+
+static int merge_shard_indexes(Library *library, Shard *shards, int num_shards)
+{
+    // Shards hold ascending ID ranges, so merging in order mostly appends
+    token_index_deinit(&library->text_index);
+    library->text_index = shards[0].view.text_index;
+    memset(&shards[0].view.text_index, 0, sizeof(TokenIndex));
+    int merged = 1;
+    for (int i = 1; i < num_shards; i++)
+    {
+        merged = token_index_merge(&library->text_index,
+                                   &shards[i].view.text_index) &&
+                 merged;
+    }
+    return merged && rebuild_book_lookup_indexes(library) &&
+           rebuild_member_index(library);
+}
+
+Library *load_library_shards(const char *prefix,
+                             int num_shards,
+                             int num_threads)
+{
+    if (!prefix || num_shards < 1 || num_shards > MAX_LIBRARY_SHARDS ||
+        num_threads < 0)
+    {
+        fprintf(stderr, "Load Library Shards Prefix or Shards is invalid\n");
+        syslog(LOG_ERR, "Load Library Shards Prefix or Shards is invalid\n");
+        return NULL;
+    }
+
+    Shard *shards = (Shard *)calloc((size_t)num_shards, sizeof(Shard));
+    Library *library = create_library();
+    int loaded = shards && library;
+    for (int i = 0; loaded && i < num_shards; i++)
+    {
+        loaded = open_shard(&shards[i], prefix, i);
+    }
+    loaded = loaded && place_shards(library, shards, num_shards);
+
+    if (loaded)
+    {
+        ShardLoad load = {shards, num_shards, 0, PTHREAD_MUTEX_INITIALIZER};
+        if (num_threads == 0 || num_threads > num_shards)
+        {
+            num_threads = num_shards;
+        }
+        run_shard_load(&load, num_threads);
+        pthread_mutex_destroy(&load.lock);
+        for (int i = 0; i < num_shards; i++)
+        {
+            loaded = loaded && shards[i].decoded;
+        }
+        loaded = loaded && merge_shard_indexes(library, shards, num_shards);
+    }
+
+    for (int i = 0; shards && i < num_shards; i++)
+    {
+        if (shards[i].file)
+        {
+            fclose(shards[i].file);
+        }
+        token_index_deinit(&shards[i].view.text_index);
+    }
+    free(shards);
+    if (!loaded)
+    {
+        fprintf(stderr, "Failed to load library shards %s.*\n", prefix);
+        syslog(LOG_ERR, "Failed to load library shards %s.*\n", prefix);
+        if (library)
+        {
+            delete_library(library);
+        }
+        return NULL;
+    }
+    syslog(LOG_INFO,
+           "Loaded %d library shards %s.* on %d threads\n",
+           num_shards,
+           prefix,
+           num_threads);
+    return library;
+}
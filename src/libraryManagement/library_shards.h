@@ -0,0 +1,28 @@
+// include/library_shards.h
+#ifndef LIBRARY_SHARDS_H
+#define LIBRARY_SHARDS_H
+
+#include "../include/structures.h"
+
+#define MAX_LIBRARY_SHARDS 256
+
+// Splits the library into num_shards library files "<prefix>.0",
+// "<prefix>.1", ... by ID range: shard n holds the books whose IDs fall in
+// the n-th of num_shards equal slices of 1..highest book ID, and likewise
+// for members. Each shard is an ordinary library file in the library's
+// file_encoding, and every shard of one save carries the same generation,
+// library->generation + 1. Returns 1 if every shard was written.
+int save_library_shards(const Library *library,
+                        const char *prefix,
+                        int num_shards);
+
+// Reads the shards written by save_library_shards on num_threads threads
+// (0 = one per shard). Each thread decodes its shards straight into their
+// slice of the merged arrays and builds their text index; the per-shard
+// text indexes are then merged in ID order and the remaining indexes built
+// once. Release with delete_library.
+Library *load_library_shards(const char *prefix,
+                             int num_shards,
+                             int num_threads);
+
+#endif
@@ -0,0 +1,294 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "library_snapshot.h"
+#include "library_file.h"
+#include "library_management.h"
+#include "../bookManagement/book_availability.h"
+#include "../bookManagement/book_management.h"
+#include "../indexManagement/author_dictionary.h"
+#include "../indexManagement/crc32.h"
+#include "../indexManagement/hash_index.h"
+#include "../indexManagement/token_index.h"
+#include "../memberManagement/member_management.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static int native_layout_matches(void)
+{
+    const uint16_t probe = 1;
+    return *(const unsigned char *)&probe == 1 && sizeof(time_t) == 8 &&
+           sizeof(Book) == BOOK_RECORD_SIZE &&
+           offsetof(Book, title) == 4 && offsetof(Book, author) == 104 &&
+           offsetof(Book, isbn) == 204 && offsetof(Book, is_available) == 224 &&
+           offsetof(Book, added_date) == 232 &&
+           offsetof(Book, author_id) == 240 &&
+           sizeof(Member) == MEMBER_RECORD_SIZE &&
+           offsetof(Member, name) == 4 && offsetof(Member, email) == 54 &&
+           offsetof(Member, borrowed_books) == 156 &&
+           offsetof(Member, num_borrowed_books) == 176;
+}
+
+static int section_in_bounds(const SectionEntry *section,
+                             uint32_t record_size,
+                             size_t file_size)
+{
+    return section->record_size == record_size &&
+           section->length == (uint64_t)section->count * record_size &&
+           section->count <= INT32_MAX && section->offset <= file_size &&
+           section->length <= file_size - section->offset &&
+           section->offset % LIBRARY_FILE_ALIGNMENT == 0;
+}
+
+static int section_checksum_matches(const unsigned char *mapping,
+                                    const SectionEntry *section)
+{
+    uint32_t crc =
+        crc32_update(0, mapping + section->offset, (size_t)section->length);
+    return crc == section->crc;
+}
+
+static int read_mapped_table(FILE *file,
+                             LibraryFileTable *table,
+                             size_t file_size)
+{
+    if (!library_file_read_table(file, table))
+    {
+        return 0;
+    }
+    const SectionEntry *books = library_file_find_section(table, SECTION_BOOKS);
+    const SectionEntry *members =
+        library_file_find_section(table, SECTION_MEMBERS);
+    if ((books && !section_in_bounds(books, BOOK_RECORD_SIZE, file_size)) ||
+        (members && !section_in_bounds(members, MEMBER_RECORD_SIZE, file_size)))
+    {
+        fprintf(stderr, "Library snapshot sections are malformed\n");
+        syslog(LOG_ERR, "Library snapshot sections are malformed\n");
+        return 0;
+    }
+    return 1;
+}
+
+// Serves a persisted hash index from the mapping when it is in bounds,
+// intact (if checked) and current
+static int attach_index(HashIndex *index,
+                        unsigned char *mapping,
+                        size_t file_size,
+                        const LibraryFileTable *table,
+                        uint32_t type,
+                        const Library *library,
+                        int num_slots,
+                        int verify_checksums)
+{
+    const SectionEntry *section = library_file_find_section(table, type);
+    if (!section || section->record_size != 0 ||
+        section->offset > file_size ||
+        section->length > file_size - section->offset ||
+        section->offset % LIBRARY_FILE_ALIGNMENT != 0 ||
+        (verify_checksums && !section_checksum_matches(mapping, section)))
+    {
+        return 0;
+    }
+    return library_file_attach_hash_index(index,
+                                          mapping + section->offset,
+                                          table,
+                                          section,
+                                          library->generation,
+                                          num_slots);
+}
+
+static void attach_sections(Library *library,
+                            unsigned char *mapping,
+                            const LibraryFileTable *table)
+{
+    const SectionEntry *books = library_file_find_section(table, SECTION_BOOKS);
+    const SectionEntry *members =
+        library_file_find_section(table, SECTION_MEMBERS);
+
+    if (books && books->count > 0)
+    {
+        free(library->books);
+        library->books = (Book *)(void *)(mapping + books->offset);
+        library->num_books = (int)books->count;
+        library->capacity_books = (int)books->count;
+        library->books_mapped = 1;
+    }
+    if (members && members->count > 0)
+    {
+        free(library->members);
+        library->members = (Member *)(void *)(mapping + members->offset);
+        library->num_members = (int)members->count;
+        library->capacity_members = (int)members->count;
+        library->members_mapped = 1;
+    }
+}
+
+Library *map_library_from_file(const char *filename, int verify_checksums)
+{
+    if (!filename)
+    {
+        fprintf(stderr, "Map Library from File Filename pointer is NULL\n");
+        syslog(LOG_ERR, "Map Library from File Filename pointer is NULL\n");
+        return NULL;
+    }
+    if (!native_layout_matches())
+    {
+        syslog(LOG_INFO, "Snapshot layout is not native, decoding instead\n");
+        return load_library_from_file(filename);
+    }
+
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open file for reading\n");
+        syslog(LOG_ERR, "Failed to open file for reading\n");
+        return NULL;
+    }
+
+    struct stat info;
+    LibraryFileTable table;
+    Library meta = {0};
+    const SectionEntry *id_marks = NULL;
+    const SectionEntry *generation = NULL;
+    if (fstat(fileno(file), &info) != 0 || info.st_size <= 0 ||
+        !read_mapped_table(file, &table, (size_t)info.st_size) ||
+        (library_file_find_section(&table, SECTION_META) &&
+         !library_file_read_meta(
+             file, library_file_find_section(&table, SECTION_META), &meta)) ||
+        ((id_marks = library_file_find_section(&table, SECTION_ID_MARKS)) &&
+         !library_file_read_id_marks(file, id_marks)) ||
+        ((generation = library_file_find_section(&table, SECTION_GENERATION)) &&
+         !library_file_read_generation(file, generation, &meta)))
+    {
+        fclose(file);
+        return NULL;
+    }
+    if (library_file_find_section(&table, SECTION_BOOKS_PACKED) ||
+        library_file_find_section(&table, SECTION_MEMBERS_PACKED))
+    {
+        fclose(file);
+        syslog(LOG_INFO, "Snapshot is packed, decoding instead\n");
+        return load_library_from_file(filename);
+    }
+
+    size_t size = (size_t)info.st_size;
+    void *mapping = mmap(
+        NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0);
+    fclose(file);
+    if (mapping == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to map library file\n");
+        syslog(LOG_ERR, "Failed to map library file\n");
+        return NULL;
+    }
+
+    const SectionEntry *books =
+        library_file_find_section(&table, SECTION_BOOKS);
+    const SectionEntry *members =
+        library_file_find_section(&table, SECTION_MEMBERS);
+    if (verify_checksums &&
+        ((books && !section_checksum_matches(mapping, books)) ||
+         (members && !section_checksum_matches(mapping, members))))
+    {
+        fprintf(stderr, "Library snapshot is corrupt\n");
+        syslog(LOG_ERR, "Library snapshot is corrupt\n");
+        munmap(mapping, size);
+        return NULL;
+    }
+
+    Library *library = create_library();
+    if (!library)
+    {
+        munmap(mapping, size);
+        return NULL;
+    }
+    library->snapshot = mapping;
+    library->snapshot_size = size;
+    library->journal_lsn = meta.journal_lsn;
+    library->generation = meta.generation;
+    attach_sections(library, (unsigned char *)mapping, &table);
+
+    // Empty secondary indexes would hide the mapped books; unbuilt ones
+    // fall back to scans
+    hash_index_deinit(&library->isbn_index);
+    token_index_deinit(&library->text_index);
+    author_dictionary_deinit(&library->authors);
+
+    // Persisted ID and ISBN tables are used in place; the rest is rebuilt
+    unsigned char *bytes = (unsigned char *)mapping;
+    int book_ids = attach_index(&library->book_index,
+                                bytes,
+                                size,
+                                &table,
+                                SECTION_BOOK_ID_INDEX,
+                                library,
+                                library->num_books,
+                                verify_checksums);
+    int member_ids = attach_index(&library->member_index,
+                                  bytes,
+                                  size,
+                                  &table,
+                                  SECTION_MEMBER_ID_INDEX,
+                                  library,
+                                  library->num_members,
+                                  verify_checksums);
+    attach_index(&library->isbn_index,
+                 bytes,
+                 size,
+                 &table,
+                 SECTION_ISBN_INDEX,
+                 library,
+                 0,
+                 verify_checksums);
+
+    if (!(book_ids ? rebuild_book_availability(library)
+                   : rebuild_book_id_index(library)) ||
+        (!member_ids && !rebuild_member_index(library)))
+    {
+        fprintf(stderr, "Failed to build library indexes\n");
+        syslog(LOG_ERR, "Failed to build library indexes\n");
+        delete_library(library);
+        return NULL;
+    }
+
+    syslog(LOG_INFO,
+           "Mapped library snapshot %s with %d books and %d members\n",
+           filename,
+           library->num_books,
+           library->num_members);
+    return library;
+}
+
+void unmap_library_snapshot(Library *library)
+{
+    if (!library || !library->snapshot)
+    {
+        return;
+    }
+    if (library->books_mapped)
+    {
+        library->books = NULL;
+        library->books_mapped = 0;
+    }
+    if (library->members_mapped)
+    {
+        library->members = NULL;
+        library->members_mapped = 0;
+    }
+    HashIndex *indexes[] = {
+        &library->book_index, &library->isbn_index, &library->member_index};
+    for (size_t i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++)
+    {
+        if (indexes[i]->borrowed)
+        {
+            hash_index_deinit(indexes[i]);
+        }
+    }
+    munmap(library->snapshot, library->snapshot_size);
+    library->snapshot = NULL;
+    library->snapshot_size = 0;
+}
@@ -0,0 +1,21 @@
+// include/library_snapshot.h
+#ifndef LIBRARY_SNAPSHOT_H
+#define LIBRARY_SNAPSHOT_H
+
+#include "../include/structures.h"
+
+// Opens a library file by mapping it privately instead of reading it.
+// Book and member records are served straight from the mapping, which the
+// page cache shares between processes; a write to a record copies only
+// the touched page, and adding past the snapshot's size moves the array
+// to the heap. The file itself is never modified. Current persisted ID
+// and ISBN indexes are served from the mapping the same way; otherwise
+// only the ID indexes are built on open (see rebuild_book_id_index).
+// Section checksums cost a full pass over the file and are only checked
+// when verify_checksums is set. Hosts whose struct layout differs from the
+// file records fall back to load_library_from_file. Release with
+// delete_library.
+Library *map_library_from_file(const char *filename, int verify_checksums);
+void unmap_library_snapshot(Library *library);
+
+#endif
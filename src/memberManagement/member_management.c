@@ -1,27 +1,45 @@
 #include "member_management.h"
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
 
+#include "../bookManagement/book_availability.h"
 #include "../bookManagement/book_management.h"
+#include "../indexManagement/growth_policy.h"
+#include "../indexManagement/hash_index.h"
+#include "../indexManagement/id_allocator.h"
+#include "../indexManagement/library_lock.h"
 
-static int next_member_id = 1;
+static IdAllocator member_ids = ID_ALLOCATOR_INIT;
 
 void reset_next_member_id(void) {
-    next_member_id = 1;
+    id_allocator_reset(&member_ids, 1);
 }
 
-void init_member(Member *member, const char *name, const char *email)
+int get_next_member_id(void)
 {
-    if (!member)
-    {
-        fprintf(stderr, "Init Member pointer is NULL\n");
-        syslog(LOG_ERR, "Init Member pointer is NULL\n");
-        return;
-    }
+    return id_allocator_peek(&member_ids);
+}
 
-    member->ident = next_member_id++;
+void set_next_member_id(int ident)
+{
+    id_allocator_reset(&member_ids, ident);
+}
+
+IdAllocator *member_id_allocator(void)
+{
+    return &member_ids;
+}
+
+static void fill_member(Member *member,
+                        int ident,
+                        const char *name,
+                        const char *email)
+{
+    member->ident = ident;
     strncpy(member->name, name ? name : "", MAX_NAME_LENGTH - 1);
     strncpy(member->email, email ? email : "", MAX_EMAIL_LENGTH - 1);
 
@@ -37,6 +55,18 @@ void init_member(Member *member, const char *name, const char *email)
            member->email);
 }
 
+void init_member(Member *member, const char *name, const char *email)
+{
+    if (!member)
+    {
+        fprintf(stderr, "Init Member pointer is NULL\n");
+        syslog(LOG_ERR, "Init Member pointer is NULL\n");
+        return;
+    }
+
+    fill_member(member, id_allocator_next(&member_ids), name, email);
+}
+
 void deinit_member(Member *member)
 {
     (void)member; // Unused parameter
@@ -93,35 +123,227 @@ void print_member(const Member *member)
     syslog(LOG_INFO, "Printed member with ID: %d\n", member->ident);
 }
 
-int add_member_to_library(Library *library, const char *name, const char *email)
+int count_members(const Library *library)
 {
-    if (!library || !name || !email)
+    return library ? library->num_members - library->num_free_members : 0;
+}
+
+static void compact_members_unlocked(Library *library)
+{
+    if (!library || library->num_free_members == 0)
     {
-        fprintf(stderr, "Invalid parameters for adding a member\n");
-        syslog(LOG_ERR, "Invalid parameters for adding a member\n");
-        return 0;
+        return;
     }
 
-    if (library->num_members >= library->capacity_members)
+    int live = 0;
+    for (int i = 0; i < library->num_members; i++)
     {
-        int new_capacity = library->capacity_members * 2;
-        Member *new_members =
-            realloc(library->members, (size_t)new_capacity * sizeof(Member));
-        if (!new_members)
+        if (library->members[i].ident == 0)
+        {
+            continue;
+        }
+        if (i != live)
+        {
+            library->members[live] = library->members[i];
+            hash_index_put(&library->member_index,
+                           (uint64_t)library->members[live].ident,
+                           live);
+        }
+        live++;
+    }
+
+    memset(&library->members[live],
+           0,
+           (size_t)(library->num_members - live) * sizeof(Member));
+    syslog(LOG_INFO,
+           "Compacted members: %d slots reclaimed\n",
+           library->num_members - live);
+    library->num_members = live;
+    library->num_free_members = 0;
+}
+
+void compact_members(Library *library)
+{
+    library_lock_exclusive(library);
+    compact_members_unlocked(library);
+    library_unlock_exclusive(library);
+}
+
+// A tombstoned slot is zeroed and keeps ident 0. If the list of free slots
+// cannot grow, the members are compacted instead.
+static void push_free_member_slot(Library *library, int slot)
+{
+    memset(&library->members[slot], 0, sizeof(Member));
+    library->num_free_members++;
+    if (library->num_free_members > library->capacity_free_member_slots)
+    {
+        int capacity = library->capacity_free_member_slots > 0
+                           ? library->capacity_free_member_slots * 2
+                           : INITIAL_CAPACITY;
+        int *slots = (int *)realloc(library->free_member_slots,
+                                    (size_t)capacity * sizeof(int));
+        if (!slots)
         {
             fprintf(stderr,
-                    "Memory reallocation failed to add library members\n");
+                    "Memory allocation failed for free member slots\n");
             syslog(LOG_ERR,
-                   "Memory reallocation failed to add library members\n");
-            return 0;
+                   "Memory allocation failed for free member slots\n");
+            compact_members_unlocked(library);
+            return;
         }
+        library->free_member_slots = slots;
+        library->capacity_free_member_slots = capacity;
+    }
+    library->free_member_slots[library->num_free_members - 1] = slot;
+}
 
-        library->members = new_members;
-        library->capacity_members = new_capacity;
+static int pop_free_member_slot(Library *library)
+{
+    if (library->num_free_members <= 0)
+    {
+        return -1;
     }
+    return library->free_member_slots[--library->num_free_members];
+}
 
-    init_member(&library->members[library->num_members], name, email);
-    library->num_members++;
+static int resize_members(Library *library, int new_capacity)
+{
+    Member *new_members = NULL;
+    if (new_capacity >= 0 && library->members_mapped)
+    {
+        // Mapped snapshot records move to the heap on first growth
+        new_members = (Member *)malloc((size_t)new_capacity * sizeof(Member));
+        if (new_members)
+        {
+            memcpy(new_members,
+                   library->members,
+                   (size_t)library->num_members * sizeof(Member));
+            library->members_mapped = 0;
+        }
+    }
+    else if (new_capacity >= 0)
+    {
+        new_members =
+            realloc(library->members, (size_t)new_capacity * sizeof(Member));
+    }
+    if (!new_members)
+    {
+        fprintf(stderr, "Memory reallocation failed to add library members\n");
+        syslog(LOG_ERR, "Memory reallocation failed to add library members\n");
+        return 0;
+    }
+
+    library->members = new_members;
+    library->capacity_members = new_capacity;
+    return 1;
+}
+
+static int reserve_members_unlocked(Library *library, int capacity)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Reserve Members Library pointer is NULL\n");
+        syslog(LOG_ERR, "Reserve Members Library pointer is NULL\n");
+        return 0;
+    }
+    if (capacity <= library->capacity_members)
+    {
+        return 1;
+    }
+    return resize_members(library,
+                          growth_policy_exact_capacity(&library->growth_policy,
+                                                       capacity,
+                                                       sizeof(Member)));
+}
+
+int reserve_members(Library *library, int capacity)
+{
+    library_lock_exclusive(library);
+    int result = reserve_members_unlocked(library, capacity);
+    library_unlock_exclusive(library);
+    return result;
+}
+
+static int find_member_slot(const Library *library, int ident)
+{
+    if (hash_index_is_built(&library->member_index))
+    {
+        return hash_index_get(&library->member_index, (uint64_t)ident);
+    }
+
+    // Libraries assembled without an index fall back to a linear scan
+    for (int i = 0; ident != 0 && i < library->num_members; i++)
+    {
+        if (library->members[i].ident == ident)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ident 0 takes the next ID; an explicit one keeps the counter past it
+static int add_member_to_library_unlocked(Library *library,
+                                          int ident,
+                                          const char *name,
+                                          const char *email)
+{
+    if (!library || !name || !email || ident < 0)
+    {
+        fprintf(stderr, "Invalid parameters for adding a member\n");
+        syslog(LOG_ERR, "Invalid parameters for adding a member\n");
+        return 0;
+    }
+    if (ident > 0 && find_member_slot(library, ident) >= 0)
+    {
+        fprintf(stderr, "Member with ID: %d already exists\n", ident);
+        syslog(LOG_ERR, "Member with ID: %d already exists\n", ident);
+        return 0;
+    }
+
+    int slot = pop_free_member_slot(library);
+    if (slot < 0 && library->num_members >= library->capacity_members &&
+        !resize_members(library,
+                        growth_policy_next_capacity(&library->growth_policy,
+                                                    library->capacity_members,
+                                                    library->num_members + 1,
+                                                    sizeof(Member))))
+    {
+        return 0;
+    }
+
+    if (slot < 0)
+    {
+        slot = library->num_members;
+    }
+    Member *member = &library->members[slot];
+    if (ident == 0)
+    {
+        init_member(member, name, email);
+    }
+    else
+    {
+        fill_member(member, ident, name, email);
+        if (ident < INT_MAX)
+        {
+            id_allocator_raise(&member_ids, ident + 1);
+        }
+    }
+    if (hash_index_is_built(&library->member_index) &&
+        !hash_index_put(&library->member_index, (uint64_t)member->ident, slot))
+    {
+        fprintf(stderr, "Failed to index member with ID: %d\n", member->ident);
+        syslog(LOG_ERR, "Failed to index member with ID: %d\n", member->ident);
+        if (slot < library->num_members)
+        {
+            push_free_member_slot(library, slot);
+        }
+        return 0;
+    }
+    if (slot == library->num_members)
+    {
+        library->num_members++;
+    }
     syslog(LOG_INFO,
            "Added member to the library with Name: %s, Email: %s\n",
            name,
@@ -129,6 +351,67 @@ int add_member_to_library(Library *library, const char *name, const char *email)
     return 1;
 }
 
+int add_member_to_library(Library *library, const char *name, const char *email)
+{
+    library_lock_exclusive(library);
+    int result = add_member_to_library_unlocked(library, 0, name, email);
+    library_unlock_exclusive(library);
+    return result;
+}
+
+int add_member_with_id(Library *library,
+                       int ident,
+                       const char *name,
+                       const char *email)
+{
+    if (ident <= 0)
+    {
+        fprintf(stderr, "Invalid member ID: %d\n", ident);
+        syslog(LOG_ERR, "Invalid member ID: %d\n", ident);
+        return 0;
+    }
+    library_lock_exclusive(library);
+    int result = add_member_to_library_unlocked(library, ident, name, email);
+    library_unlock_exclusive(library);
+    return result;
+}
+
+int rebuild_member_index(Library *library)
+{
+    if (!library)
+    {
+        fprintf(stderr, "Rebuild Member Index Library pointer is NULL\n");
+        syslog(LOG_ERR, "Rebuild Member Index Library pointer is NULL\n");
+        return 0;
+    }
+
+    if (hash_index_is_built(&library->member_index))
+    {
+        hash_index_clear(&library->member_index);
+        if (!hash_index_reserve(&library->member_index, library->num_members))
+        {
+            return 0;
+        }
+    }
+    else if (!hash_index_init(&library->member_index, library->num_members))
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < library->num_members; i++)
+    {
+        if (library->members[i].ident != 0 &&
+            !hash_index_put(&library->member_index,
+                            (uint64_t)library->members[i].ident,
+                            i))
+        {
+            hash_index_deinit(&library->member_index);
+            return 0;
+        }
+    }
+    return 1;
+}
+
 Member *find_member_by_id(Library *library, int ident)
 {
     if (!library)
@@ -138,18 +421,16 @@ Member *find_member_by_id(Library *library, int ident)
         return NULL;
     }
 
-    for (int i = 0; i < library->num_members; i++)
+    int slot = find_member_slot(library, ident);
+    if (slot < 0)
     {
-        if (library->members[i].ident == ident)
-        {
-            syslog(LOG_INFO, "Found member with ID: %d\n", ident);
-            return &library->members[i];
-        }
+        return NULL;
     }
-    return NULL;
+    syslog(LOG_INFO, "Found member with ID: %d\n", ident);
+    return &library->members[slot];
 }
 
-void remove_member_from_library(Library *library, int ident)
+static void remove_member_from_library_unlocked(Library *library, int ident)
 {
     if (!library)
     {
@@ -158,29 +439,59 @@ void remove_member_from_library(Library *library, int ident)
         return;
     }
 
-    int found_index = -1;
-    for (int i = 0; i < library->num_members; i++)
+    if (library->removal_mode == REMOVAL_SHIFT)
     {
-        if (library->members[i].ident == ident)
-        {
-            syslog(LOG_INFO, "Removing member with ID: %d\n Found", ident);
-            found_index = i;
-            break;
-        }
+        // Shifting would invalidate the free-list left by tombstone mode
+        compact_members_unlocked(library);
     }
 
+    int found_index = find_member_slot(library, ident);
     if (found_index != -1)
     {
+        syslog(LOG_INFO, "Removing member with ID: %d\n Found", ident);
         deinit_member(&library->members[found_index]);
         syslog(LOG_INFO, "Removed member with ID: %d\n", ident);
+
+        if (library->removal_mode == REMOVAL_TOMBSTONE)
+        {
+            hash_index_remove(&library->member_index, (uint64_t)ident);
+            push_free_member_slot(library, found_index);
+            if (library->compaction_threshold > 0 &&
+                (long long)library->num_free_members * 100 >=
+                    (long long)library->compaction_threshold *
+                        library->num_members)
+            {
+                compact_members_unlocked(library);
+            }
+            return;
+        }
+
+        int indexed = hash_index_is_built(&library->member_index);
         for (int i = found_index; i < library->num_members - 1; i++)
         {
             library->members[i] = library->members[i + 1];
+            if (indexed)
+            {
+                hash_index_put(&library->member_index,
+                               (uint64_t)library->members[i].ident,
+                               i);
+            }
+        }
+        if (indexed)
+        {
+            hash_index_remove(&library->member_index, (uint64_t)ident);
         }
         library->num_members--;
     }
 }
 
+void remove_member_from_library(Library *library, int ident)
+{
+    library_lock_exclusive(library);
+    remove_member_from_library_unlocked(library, ident);
+    library_unlock_exclusive(library);
+}
+
 void list_all_members(const Library *library)
 {
     if (!library)
@@ -190,24 +501,99 @@ void list_all_members(const Library *library)
         return;
     }
 
-    printf("\nLibrary Members (%d):\n", library->num_members);
+    printf("\nLibrary Members (%d):\n", count_members(library));
     for (int i = 0; i < library->num_members; i++)
     {
+        if (library->members[i].ident == 0)
+        {
+            continue;
+        }
         print_member(&library->members[i]);
         syslog(LOG_INFO, "Listed all members in library\n");
     }
 }
 
-int borrow_book(Library *library, int member_id, int book_id)
+// Reserves one of the member's loans, then claims a free slot for it. The
+// reservation comes first so that every reserver is sure to find a slot;
+// returns 0 when all loans are taken.
+static int claim_loan_slot(Member *member, int book_id)
 {
-    if (!library)
+    int reserved = atomic_load(&member->num_borrowed_books);
+    do
+    {
+        if (reserved >= MAX_BORROWED_BOOKS)
+        {
+            return 0;
+        }
+    } while (!atomic_compare_exchange_weak(
+        &member->num_borrowed_books, &reserved, reserved + 1));
+
+    for (int i = 0;; i = (i + 1) % MAX_BORROWED_BOOKS)
+    {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(
+                &member->borrowed_books[i], &expected, book_id))
+        {
+            return 1;
+        }
+    }
+}
+
+// Frees the slot holding book_id; only one caller can win a given loan
+static int release_loan_slot(Member *member, int book_id)
+{
+    for (int i = 0; i < MAX_BORROWED_BOOKS; i++)
+    {
+        int expected = book_id;
+        if (atomic_compare_exchange_strong(
+                &member->borrowed_books[i], &expected, 0))
+        {
+            atomic_fetch_sub(&member->num_borrowed_books, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Lock-free: the book and the loan slot are each claimed with
+// compare-and-swap, and the book is put back if the member has no slot left
+static LoanResult lend_book(Library *library, Member *member, Book *book)
+{
+    if (!claim_book(library, book))
+    {
+        return LOAN_BOOK_UNAVAILABLE;
+    }
+    if (!claim_loan_slot(member, book->ident))
+    {
+        release_book(library, book);
+        return LOAN_LIMIT_REACHED;
+    }
+    return LOAN_OK;
+}
+
+static LoanResult take_back_book(Library *library, Member *member, Book *book)
+{
+    if (!release_loan_slot(member, book->ident))
+    {
+        return LOAN_NOT_BORROWED;
+    }
+    release_book(library, book);
+    return LOAN_OK;
+}
+
+static int borrow_book_unlocked(Library *member_library,
+                                int member_id,
+                                Library *book_library,
+                                int book_id)
+{
+    if (!member_library || !book_library)
     {
         fprintf(stderr, "Borrow Book Library pointer is NULL\n");
         syslog(LOG_ERR, "Borrow Book Library pointer is NULL\n");
         return 0;
     }
-    Member *member = find_member_by_id(library, member_id);
-    Book *book = find_book_by_id(library, book_id);
+    Member *member = find_member_by_id(member_library, member_id);
+    Book *book = find_book_by_id(book_library, book_id);
 
     if (!member || !book)
     {
@@ -216,37 +602,43 @@ int borrow_book(Library *library, int member_id, int book_id)
         return 0;
     }
 
-    if (!book->is_available)
+    LoanResult result = lend_book(book_library, member, book);
+    if (result == LOAN_BOOK_UNAVAILABLE)
     {
         fprintf(stderr, "Book is not available\n");
         syslog(LOG_ERR, "Book is not available\n");
-        return 0;
     }
-
-    if (member->num_borrowed_books >= MAX_BORROWED_BOOKS)
+    else if (result == LOAN_LIMIT_REACHED)
     {
         fprintf(stderr,
                 "Member has reached maximum number of borrowed books\n");
         syslog(LOG_ERR,
                "Member has reached maximum number of borrowed books\n");
-        return 0;
     }
-    book->is_available = 0;
-    member->borrowed_books[member->num_borrowed_books++] = book_id;
+    return result == LOAN_OK;
+}
 
-    return 1;
+int borrow_book(Library *library, int member_id, int book_id)
+{
+    library_lock_shared(library);
+    int result = borrow_book_unlocked(library, member_id, library, book_id);
+    library_unlock_shared(library);
+    return result;
 }
 
-int return_book(Library *library, int member_id, int book_id)
+static int return_book_unlocked(Library *member_library,
+                                int member_id,
+                                Library *book_library,
+                                int book_id)
 {
-    if (!library)
+    if (!member_library || !book_library)
     {
         fprintf(stderr, "Return Book Library pointer is NULL\n");
         syslog(LOG_ERR, "Return Book Library pointer is NULL\n");
         return 0;
     }
-    Member *member = find_member_by_id(library, member_id);
-    Book *book = find_book_by_id(library, book_id);
+    Member *member = find_member_by_id(member_library, member_id);
+    Book *book = find_book_by_id(book_library, book_id);
 
     if (!member || !book)
     {
@@ -254,24 +646,12 @@ int return_book(Library *library, int member_id, int book_id)
         syslog(LOG_ERR, "Return Book Member or Book ID pointer is NULL\n");
         return 0;
     }
-    int found = 0;
-    for (int i = 0; i < member->num_borrowed_books; i++)
+    int found = take_back_book(book_library, member, book) == LOAN_OK;
+    if (found)
     {
-        if (member->borrowed_books[i] == book_id)
-        {
-            syslog(LOG_INFO, "Returned book with ID: %d\n", book_id);
-            for (int j = i; j < member->num_borrowed_books - 1; j++)
-            {
-                member->borrowed_books[j] = member->borrowed_books[j + 1];
-            }
-            member->num_borrowed_books--;
-            book->is_available = 1;
-            found = 1;
-            break;
-        }
+        syslog(LOG_INFO, "Returned book with ID: %d\n", book_id);
     }
-
-    if (!found)
+    else
     {
         syslog(LOG_INFO,
                "Book with ID: %d not found in member's borrowed books\n",
@@ -280,3 +660,197 @@ int return_book(Library *library, int member_id, int book_id)
 
     return found;
 }
+
+int return_book(Library *library, int member_id, int book_id)
+{
+    library_lock_shared(library);
+    int result = return_book_unlocked(library, member_id, library, book_id);
+    library_unlock_shared(library);
+    return result;
+}
+
+// Shared locks on two libraries are always taken in address order, so two
+// loans crossing the same pair of libraries in opposite directions cannot
+// each hold one while a writer queued on the other holds up the second
+static void lock_library_pair(const Library *first, const Library *second)
+{
+    if (first == second)
+    {
+        library_lock_shared(first);
+        return;
+    }
+    if ((uintptr_t)first > (uintptr_t)second)
+    {
+        const Library *swap = first;
+        first = second;
+        second = swap;
+    }
+    library_lock_shared(first);
+    library_lock_shared(second);
+}
+
+static void unlock_library_pair(const Library *first, const Library *second)
+{
+    library_unlock_shared(first);
+    if (first != second)
+    {
+        library_unlock_shared(second);
+    }
+}
+
+int borrow_book_between(Library *member_library,
+                        int member_id,
+                        Library *book_library,
+                        int book_id)
+{
+    lock_library_pair(member_library, book_library);
+    int result =
+        borrow_book_unlocked(member_library, member_id, book_library, book_id);
+    unlock_library_pair(member_library, book_library);
+    return result;
+}
+
+int return_book_between(Library *member_library,
+                        int member_id,
+                        Library *book_library,
+                        int book_id)
+{
+    lock_library_pair(member_library, book_library);
+    int result =
+        return_book_unlocked(member_library, member_id, book_library, book_id);
+    unlock_library_pair(member_library, book_library);
+    return result;
+}
+
+typedef struct
+{
+    int member_id;
+    int request;
+} BatchMember;
+
+static int compare_batch_members(const void *left, const void *right)
+{
+    const BatchMember *a = (const BatchMember *)left;
+    const BatchMember *b = (const BatchMember *)right;
+    if (a->member_id != b->member_id)
+    {
+        return a->member_id < b->member_id ? -1 : 1;
+    }
+    return a->request < b->request ? -1 : a->request > b->request;
+}
+
+// Looks each distinct member of a batch up once, by sorting the requests
+// by member; entry i is request i's member, or NULL if it is unknown
+static Member **resolve_batch_members(Library *library,
+                                      const LoanRequest *requests,
+                                      int count)
+{
+    Member **members = (Member **)malloc((size_t)count * sizeof(Member *));
+    BatchMember *order =
+        (BatchMember *)malloc((size_t)count * sizeof(BatchMember));
+    if (!members || !order)
+    {
+        free(members);
+        free(order);
+        fprintf(stderr, "Memory allocation failed for loan batch\n");
+        syslog(LOG_ERR, "Memory allocation failed for loan batch\n");
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        order[i].member_id = requests[i].member_id;
+        order[i].request = i;
+    }
+    qsort(order, (size_t)count, sizeof(BatchMember), compare_batch_members);
+    Member *member = NULL;
+    for (int i = 0; i < count; i++)
+    {
+        if (i == 0 || order[i].member_id != order[i - 1].member_id)
+        {
+            int slot = find_member_slot(library, order[i].member_id);
+            member = slot < 0 ? NULL : &library->members[slot];
+        }
+        members[order[i].request] = member;
+    }
+    free(order);
+    return members;
+}
+
+typedef LoanResult (*LoanOperation)(Library *library,
+                                    Member *member,
+                                    Book *book);
+
+static int apply_loan_batch(Library *library,
+                            const LoanRequest *requests,
+                            int count,
+                            LoanResult *results,
+                            LoanOperation operation,
+                            const char *name)
+{
+    if (!library || count < 0 || (count > 0 && (!requests || !results)))
+    {
+        fprintf(stderr, "%s Batch Library or Requests pointer is NULL\n", name);
+        syslog(LOG_ERR, "%s Batch Library or Requests pointer is NULL\n", name);
+        return -1;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    library_lock_shared(library);
+    Member **members = resolve_batch_members(library, requests, count);
+    if (!members)
+    {
+        library_unlock_shared(library);
+        return -1;
+    }
+
+    // Requests are applied in order, so conflicts resolve as if they had
+    // arrived one by one
+    int outcomes[LOAN_NOT_BORROWED + 1] = {0};
+    for (int i = 0; i < count; i++)
+    {
+        int slot = members[i] ? find_book_slot(library, requests[i].book_id)
+                              : -1;
+        Book *book = slot < 0 ? NULL : &library->books[slot];
+        results[i] = !members[i] ? LOAN_UNKNOWN_MEMBER
+                     : !book     ? LOAN_UNKNOWN_BOOK
+                                 : operation(library, members[i], book);
+        outcomes[results[i]]++;
+    }
+    library_unlock_shared(library);
+    free(members);
+
+    syslog(LOG_INFO,
+           "%s batch applied %d of %d: %d unknown member, %d unknown book, "
+           "%d unavailable, %d over limit, %d not borrowed\n",
+           name,
+           outcomes[LOAN_OK],
+           count,
+           outcomes[LOAN_UNKNOWN_MEMBER],
+           outcomes[LOAN_UNKNOWN_BOOK],
+           outcomes[LOAN_BOOK_UNAVAILABLE],
+           outcomes[LOAN_LIMIT_REACHED],
+           outcomes[LOAN_NOT_BORROWED]);
+    return outcomes[LOAN_OK];
+}
+
+int borrow_books_batch(Library *library,
+                       const LoanRequest *requests,
+                       int count,
+                       LoanResult *results)
+{
+    return apply_loan_batch(
+        library, requests, count, results, lend_book, "Borrow");
+}
+
+int return_books_batch(Library *library,
+                       const LoanRequest *requests,
+                       int count,
+                       LoanResult *results)
+{
+    return apply_loan_batch(
+        library, requests, count, results, take_back_book, "Return");
+}
@@ -2,20 +2,62 @@
 #define MEMBER_MANAGEMENT_H
 
 #include "../include/structures.h"
+#include "../indexManagement/id_allocator.h"
 
 void reset_next_member_id(void);
+int get_next_member_id(void);
+void set_next_member_id(int ident);
+IdAllocator *member_id_allocator(void);
 void init_member(Member *member, const char *name, const char *email);
 void deinit_member(Member *member);
 Member *create_member(const char *name, const char *email);
 void delete_member(Member *member);
 void print_member(const Member *member);
+// Grows the member array to hold at least capacity members; never shrinks
+int reserve_members(Library *library, int capacity);
 int add_member_to_library(Library *library,
                           const char *name,
                           const char *email);
+// Adds a member under an ID the caller chose, e.g. one taken from
+// member_id_allocator to route the member before adding it; fails if a
+// member of this library already has the ID
+int add_member_with_id(Library *library,
+                       int ident,
+                       const char *name,
+                       const char *email);
+int count_members(const Library *library);
+void compact_members(Library *library);
+int rebuild_member_index(Library *library);
 Member *find_member_by_id(Library *library, int identity);
 void remove_member_from_library(Library *library, int identity);
 void list_all_members(const Library *library);
 int borrow_book(Library *library, int member_id, int book_id);
 int return_book(Library *library, int member_id, int book_id);
+// Lend a book of one library to a member of another, or take it back, as
+// between the branches of a consortium. The loan is recorded on the
+// member and the book's availability in its own library; both libraries
+// are held shared for the call.
+int borrow_book_between(Library *member_library,
+                        int member_id,
+                        Library *book_library,
+                        int book_id);
+int return_book_between(Library *member_library,
+                        int member_id,
+                        Library *book_library,
+                        int book_id);
+// Apply a batch of loans or returns in order under one shared lock. Each
+// member is looked up once however many of its operations are in the
+// batch, nothing is logged per operation, and one summary is logged per
+// batch. results (count entries) receives each operation's outcome.
+// Returns the number of operations that succeeded, or -1 on invalid
+// arguments or allocation failure.
+int borrow_books_batch(Library *library,
+                       const LoanRequest *requests,
+                       int count,
+                       LoanResult *results);
+int return_books_batch(Library *library,
+                       const LoanRequest *requests,
+                       int count,
+                       LoanResult *results);
 
 #endif
@@ -5,7 +5,12 @@
 
 #include "unity.h"
 
+#include "book_availability.h"
+#include "book_columns.h"
+#include "book_import.h"
 #include "book_management.h"
+#include "hash_index.h"
+#include "parallel_for.h"
 #include "unity_internals.h"
 
 
@@ -286,6 +291,332 @@ void test_remove_book_from_library_with_multiple_books(void)
     library.capacity_books = 0;
 }
 
+void test_book_index_tracks_add_and_remove(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 2;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    TEST_ASSERT_EQUAL(1, rebuild_book_index(&library));
+
+    // Act
+    for (int i = 0; i < 50; i++) {
+        char title[MAX_TITLE_LENGTH];
+        snprintf(title, sizeof(title), "Book %d", i + 1);
+        add_book_to_library(&library, title, "Author", "ISBN");
+    }
+    remove_book_from_library(&library, 10);
+
+    // Assert
+    TEST_ASSERT_EQUAL(49, library.num_books);
+    TEST_ASSERT_EQUAL(49, library.book_index.count);
+    TEST_ASSERT_NULL(find_book_by_id(&library, 10));
+    for (int ident = 11; ident <= 50; ident++) {
+        Book *book = find_book_by_id(&library, ident);
+        TEST_ASSERT_NOT_NULL(book);
+        TEST_ASSERT_EQUAL(ident, book->ident);
+    }
+    TEST_ASSERT_EQUAL_STRING("Book 9", find_book_by_id(&library, 9)->title);
+
+    deinit_book_indexes(&library);
+    free(library.books);
+}
+
+void test_search_books_intersects_title_and_author_terms(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 4;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    rebuild_book_index(&library);
+    add_book_to_library(&library, "The C Programming Language", "Kernighan", "1");
+    add_book_to_library(&library, "The Practice of Programming", "Kernighan", "2");
+    add_book_to_library(&library, "Programming Pearls", "Bentley", "3");
+
+    // Act
+    int num_results = -1;
+    Book *results = search_books(&library, "kernighan PROGRAMMING", &num_results);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(results);
+    TEST_ASSERT_EQUAL(2, num_results);
+    TEST_ASSERT_EQUAL(1, results[0].ident);
+    TEST_ASSERT_EQUAL(2, results[1].ident);
+    free(results);
+
+    remove_book_from_library(&library, 1);
+    results = search_books(&library, "kernighan", &num_results);
+    TEST_ASSERT_EQUAL(1, num_results);
+    TEST_ASSERT_EQUAL_STRING("The Practice of Programming", results[0].title);
+    free(results);
+
+    results = search_books(&library, "pearls missing", &num_results);
+    TEST_ASSERT_NULL(results);
+    TEST_ASSERT_EQUAL(0, num_results);
+
+    deinit_book_indexes(&library);
+    free(library.books);
+}
+
+void test_search_books_without_index_scans_catalog(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 2;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    library.num_books = 2;
+    init_book(&library.books[0], "Dune", "Frank Herbert", "1");
+    init_book(&library.books[1], "Children of Dune", "Frank Herbert", "2");
+
+    // Act
+    int num_results = 0;
+    Book *results = search_books(&library, "dune children", &num_results);
+
+    // Assert
+    TEST_ASSERT_EQUAL(1, num_results);
+    TEST_ASSERT_EQUAL(2, results[0].ident);
+
+    free(results);
+    free(library.books);
+}
+
+void test_find_book_by_isbn_matches_isbn10_and_isbn13_forms(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 2;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    rebuild_book_index(&library);
+    add_book_to_library(&library, "Title", "Author", "0-306-40615-2");
+
+    // Act
+    Book *book = find_book_by_isbn(&library, "9780306406157");
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(book);
+    TEST_ASSERT_EQUAL(1, book->ident);
+    TEST_ASSERT_NULL(find_book_by_isbn(&library, "978-1-4028-9462-6"));
+
+    deinit_book_indexes(&library);
+    free(library.books);
+}
+
+void test_add_book_to_library_applies_isbn_duplicate_policy(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 2;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    rebuild_book_index(&library);
+    add_book_to_library(&library, "Title", "Author", "978-0-306-40615-7");
+
+    // Act & Assert
+    TEST_ASSERT_EQUAL(0, add_book_to_library(&library, "Copy", "Author", "0306406152"));
+    TEST_ASSERT_EQUAL(1, library.num_books);
+
+    library.isbn_duplicate_policy = ISBN_DUPLICATE_MERGE;
+    TEST_ASSERT_EQUAL(1, add_book_to_library(&library, "Copy", "Author", "0306406152"));
+    TEST_ASSERT_EQUAL(1, library.num_books);
+
+    remove_book_from_library(&library, 1);
+    TEST_ASSERT_NULL(find_book_by_isbn(&library, "0306406152"));
+    TEST_ASSERT_EQUAL(1, add_book_to_library(&library, "New", "Author", "0306406152"));
+    TEST_ASSERT_EQUAL_STRING("New", find_book_by_isbn(&library, "9780306406157")->title);
+
+    deinit_book_indexes(&library);
+    free(library.books);
+}
+
+void test_book_columns_mirror_hot_fields(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 2;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    TEST_ASSERT_EQUAL(1, enable_book_columns(&library));
+    for (int i = 0; i < 6; i++) {
+        add_book_to_library(&library, "Title", "Author", "ISBN");
+    }
+    library.books[4].added_date = 100;
+
+    // Act
+    set_book_available(&library, find_book_by_id(&library, 2), 0);
+    set_book_available(&library, find_book_by_id(&library, 5), 0);
+    remove_book_from_library(&library, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL(5, library.num_books);
+    TEST_ASSERT_EQUAL(2, book_ident_at(&library, 0));
+    TEST_ASSERT_EQUAL(0, book_available_at(&library, 0));
+    TEST_ASSERT_EQUAL(6, book_ident_at(&library, 4));
+    TEST_ASSERT_EQUAL(3, count_available_books(&library));
+    TEST_ASSERT_EQUAL(0, library.books[3].is_available);
+    TEST_ASSERT_EQUAL(1, count_books_added_between(&library, 0, 1000));
+    TEST_ASSERT_EQUAL(100, book_added_date_at(&library, 3));
+
+    disable_book_columns(&library);
+    TEST_ASSERT_EQUAL(3, count_available_books(&library));
+    TEST_ASSERT_EQUAL(1, count_books_added_between(&library, 0, 1000));
+
+    free(library.books);
+}
+
+void test_find_books_by_author_uses_interned_ids(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 4;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    rebuild_book_index(&library);
+    add_book_to_library(&library, "Dune", "Frank Herbert", "1");
+    add_book_to_library(&library, "Emma", "Jane Austen", "2");
+    add_book_to_library(&library, "Dune Messiah", "Frank Herbert", "3");
+
+    // Act
+    int num_results = 0;
+    Book *results = find_books_by_author(&library, "Frank Herbert", &num_results);
+
+    // Assert
+    TEST_ASSERT_EQUAL(2, num_results);
+    TEST_ASSERT_EQUAL(1, results[0].ident);
+    TEST_ASSERT_EQUAL(3, results[1].ident);
+    TEST_ASSERT_EQUAL(library.books[0].author_id, library.books[2].author_id);
+    TEST_ASSERT_NOT_EQUAL(library.books[0].author_id, library.books[1].author_id);
+    TEST_ASSERT_EQUAL(2, library.authors.num_names);
+    free(results);
+
+    remove_book_from_library(&library, 1);
+    results = find_books_by_author(&library, "Frank Herbert", &num_results);
+    TEST_ASSERT_EQUAL(1, num_results);
+    TEST_ASSERT_EQUAL_STRING("Dune Messiah", results[0].title);
+    free(results);
+
+    TEST_ASSERT_NULL(find_books_by_author(&library, "frank herbert", &num_results));
+    TEST_ASSERT_EQUAL(0, num_results);
+
+    deinit_book_indexes(&library);
+    free(library.books);
+}
+
+void test_add_books_bulk_reserves_once_and_applies_isbn_policy(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 1;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    rebuild_book_index(&library);
+    BookRecord records[] = {
+        {"Dune", "Frank Herbert", "978-0-306-40615-7", 0, 0},
+        {"Emma", "Jane Austen", "ISBN", 0, 0},
+        {"Copy", "Frank Herbert", "0306406152", 0, 0},
+        {NULL, "Nobody", "1", 0, 0},
+    };
+
+    // Act
+    int added = add_books_bulk(&library, records, 4);
+
+    // Assert
+    TEST_ASSERT_EQUAL(2, added);
+    TEST_ASSERT_EQUAL(2, library.num_books);
+    TEST_ASSERT_EQUAL(4, library.capacity_books);
+    TEST_ASSERT_EQUAL(library.books[0].added_date, library.books[1].added_date);
+    TEST_ASSERT_EQUAL_STRING("Emma", find_book_by_id(&library, 2)->title);
+    TEST_ASSERT_EQUAL(-1, add_books_bulk(&library, NULL, 1));
+
+    deinit_book_indexes(&library);
+    free(library.books);
+}
+
+void test_import_books_from_file_parses_quoted_csv(void)
+{
+    // Arrange
+    const char *filename = "test_import_books.csv";
+    FILE *file = fopen(filename, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs("title,author,isbn\r\n", file);
+    fputs("\"Dune, Part One\",Frank Herbert,1\r\n", file);
+    fputs("\"The \"\"C\"\" Book\",\"Kernighan\",2\n", file);
+    fputs("missing fields\n\n", file);
+    fputs("Emma,Jane Austen,3", file);
+    fclose(file);
+
+    reset_book_id();
+    Library library = {0};
+    library.capacity_books = 1;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    rebuild_book_index(&library);
+
+    // Act
+    int imported = import_books_from_file(&library, filename, ',', 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL(3, imported);
+    TEST_ASSERT_EQUAL_STRING("Dune, Part One", library.books[0].title);
+    TEST_ASSERT_EQUAL_STRING("The \"C\" Book", library.books[1].title);
+    TEST_ASSERT_EQUAL_STRING("Kernighan", library.books[1].author);
+    TEST_ASSERT_EQUAL_STRING("Jane Austen", library.books[2].author);
+    TEST_ASSERT_EQUAL_STRING("3", library.books[2].isbn);
+    TEST_ASSERT_EQUAL(-1, import_books_from_file(&library, "missing.csv", ',', 0));
+
+    remove(filename);
+    deinit_book_indexes(&library);
+    free(library.books);
+}
+
+void test_catalog_scans_merge_chunks_in_order(void)
+{
+    // Arrange
+    reset_book_id();
+    Library library = {0};
+    int num_books = 5 * parallel_for_chunk_items(sizeof(Book)) + 7;
+    library.capacity_books = num_books;
+    library.books = malloc(sizeof(Book) * (size_t)library.capacity_books);
+    library.num_books = num_books;
+    for (int i = 0; i < num_books; i++) {
+        init_book(&library.books[i],
+                  i % 3 == 0 ? "Dune Messiah" : "Emma",
+                  i % 2 == 0 ? "Frank Herbert" : "Jane Austen",
+                  "");
+        library.books[i].is_available = i % 4 != 0;
+        library.books[i].added_date = i;
+    }
+    set_parallel_for_threads(4);
+
+    // Act
+    int num_dune = 0;
+    Book *dune = search_books(&library, "messiah", &num_dune);
+    int num_austen = 0;
+    Book *austen = find_books_by_author(&library, "Jane Austen", &num_austen);
+    int available = count_available_books(&library);
+    int added = count_books_added_between(&library, 10, num_books - 10);
+
+    // Assert
+    TEST_ASSERT_EQUAL(4, get_parallel_for_threads());
+    TEST_ASSERT_EQUAL((num_books + 2) / 3, num_dune);
+    for (int i = 0; i < num_dune; i++) {
+        TEST_ASSERT_EQUAL(library.books[3 * i].ident, dune[i].ident);
+    }
+    TEST_ASSERT_EQUAL(num_books / 2, num_austen);
+    for (int i = 0; i < num_austen; i++) {
+        TEST_ASSERT_EQUAL(library.books[2 * i + 1].ident, austen[i].ident);
+    }
+    TEST_ASSERT_EQUAL(num_books - (num_books + 3) / 4, available);
+    TEST_ASSERT_EQUAL(num_books - 20, added);
+
+    set_parallel_for_threads(0);
+    free(dune);
+    free(austen);
+    free(library.books);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -301,5 +632,15 @@ int main(void)
     RUN_TEST(test_add_book_to_empty_library);
     RUN_TEST(test_find_book_by_id_with_valid_id);
     RUN_TEST(test_remove_book_from_library_with_multiple_books);
+    RUN_TEST(test_book_index_tracks_add_and_remove);
+    RUN_TEST(test_search_books_intersects_title_and_author_terms);
+    RUN_TEST(test_search_books_without_index_scans_catalog);
+    RUN_TEST(test_find_book_by_isbn_matches_isbn10_and_isbn13_forms);
+    RUN_TEST(test_add_book_to_library_applies_isbn_duplicate_policy);
+    RUN_TEST(test_book_columns_mirror_hot_fields);
+    RUN_TEST(test_find_books_by_author_uses_interned_ids);
+    RUN_TEST(test_add_books_bulk_reserves_once_and_applies_isbn_policy);
+    RUN_TEST(test_import_books_from_file_parses_quoted_csv);
+    RUN_TEST(test_catalog_scans_merge_chunks_in_order);
     return UNITY_END();
 }
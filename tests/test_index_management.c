@@ -0,0 +1,604 @@
+#include "unity.h"
+#include "bitset.h"
+#include "block_compress.h"
+#include "crc32.h"
+#include "growth_policy.h"
+#include "hash_index.h"
+#include "id_allocator.h"
+#include "isbn.h"
+#include "parallel_for.h"
+#include "token_index.h"
+#include "work_stealing.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_hash_index_put_and_get(void)
+{
+    // Arrange
+    HashIndex index = {0};
+    TEST_ASSERT_EQUAL(1, hash_index_init(&index, 4));
+
+    // Act
+    hash_index_put(&index, 7, 70);
+    hash_index_put(&index, 8, 80);
+
+    // Assert
+    TEST_ASSERT_EQUAL(70, hash_index_get(&index, 7));
+    TEST_ASSERT_EQUAL(80, hash_index_get(&index, 8));
+    TEST_ASSERT_EQUAL(HASH_INDEX_NOT_FOUND, hash_index_get(&index, 9));
+    TEST_ASSERT_EQUAL(2, index.count);
+
+    hash_index_deinit(&index);
+}
+
+void test_hash_index_put_overwrites_existing_key(void)
+{
+    // Arrange
+    HashIndex index = {0};
+    hash_index_init(&index, 4);
+    hash_index_put(&index, 5, 1);
+
+    // Act
+    hash_index_put(&index, 5, 2);
+
+    // Assert
+    TEST_ASSERT_EQUAL(2, hash_index_get(&index, 5));
+    TEST_ASSERT_EQUAL(1, index.count);
+
+    hash_index_deinit(&index);
+}
+
+void test_hash_index_grows_and_keeps_entries(void)
+{
+    // Arrange
+    HashIndex index = {0};
+    hash_index_init(&index, 1);
+
+    // Act
+    for (int i = 1; i <= 10000; i++) {
+        TEST_ASSERT_EQUAL(1, hash_index_put(&index, (uint64_t)i, i * 2));
+    }
+
+    // Assert
+    TEST_ASSERT_EQUAL(10000, index.count);
+    for (int i = 1; i <= 10000; i++) {
+        TEST_ASSERT_EQUAL(i * 2, hash_index_get(&index, (uint64_t)i));
+    }
+
+    hash_index_deinit(&index);
+}
+
+void test_hash_index_remove_keeps_probe_chains_intact(void)
+{
+    // Arrange
+    HashIndex index = {0};
+    hash_index_init(&index, 2000);
+    for (int i = 1; i <= 1000; i++) {
+        hash_index_put(&index, (uint64_t)i, i);
+    }
+
+    // Act
+    for (int i = 1; i <= 1000; i += 2) {
+        TEST_ASSERT_EQUAL(1, hash_index_remove(&index, (uint64_t)i));
+    }
+
+    // Assert
+    TEST_ASSERT_EQUAL(500, index.count);
+    for (int i = 1; i <= 1000; i++) {
+        int expected = (i % 2) ? HASH_INDEX_NOT_FOUND : i;
+        TEST_ASSERT_EQUAL(expected, hash_index_get(&index, (uint64_t)i));
+    }
+    TEST_ASSERT_EQUAL(0, hash_index_remove(&index, 1));
+
+    hash_index_deinit(&index);
+}
+
+void test_hash_index_rejects_zero_key_and_unbuilt_index(void)
+{
+    // Arrange
+    HashIndex index = {0};
+
+    // Act & Assert
+    TEST_ASSERT_EQUAL(0, hash_index_is_built(&index));
+    TEST_ASSERT_EQUAL(0, hash_index_put(&index, 1, 1));
+    TEST_ASSERT_EQUAL(HASH_INDEX_NOT_FOUND, hash_index_get(&index, 1));
+
+    hash_index_init(&index, 1);
+    TEST_ASSERT_EQUAL(0, hash_index_put(&index, 0, 1));
+
+    hash_index_deinit(&index);
+}
+
+void test_next_token_folds_case_and_skips_punctuation(void)
+{
+    // Arrange
+    const char *cursor = "  Hello, WORLD-42!";
+    char token[MAX_TOKEN_LENGTH];
+
+    // Act & Assert
+    TEST_ASSERT_EQUAL(1, next_token(&cursor, token, sizeof(token)));
+    TEST_ASSERT_EQUAL_STRING("hello", token);
+    TEST_ASSERT_EQUAL(1, next_token(&cursor, token, sizeof(token)));
+    TEST_ASSERT_EQUAL_STRING("world", token);
+    TEST_ASSERT_EQUAL(1, next_token(&cursor, token, sizeof(token)));
+    TEST_ASSERT_EQUAL_STRING("42", token);
+    TEST_ASSERT_EQUAL(0, next_token(&cursor, token, sizeof(token)));
+}
+
+void test_token_index_query_intersects_posting_lists(void)
+{
+    // Arrange
+    TokenIndex index = {0};
+    token_index_init(&index, 0);
+    for (int doc = 1; doc <= 300; doc++) {
+        token_index_add_document(&index, doc, "common words here");
+        if (doc % 3 == 0) {
+            token_index_add_document(&index, doc, "fizz");
+        }
+        if (doc % 5 == 0) {
+            token_index_add_document(&index, doc, "Buzz");
+        }
+    }
+
+    // Act
+    int *ids = NULL;
+    int count = token_index_query(&index, "fizz buzz common", &ids);
+
+    // Assert
+    TEST_ASSERT_EQUAL(20, count);
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL((i + 1) * 15, ids[i]);
+    }
+    free(ids);
+
+    TEST_ASSERT_EQUAL(0, token_index_query(&index, "fizz absent", &ids));
+    TEST_ASSERT_NULL(ids);
+
+    token_index_deinit(&index);
+}
+
+void test_token_index_query_uses_every_term_of_a_long_query(void)
+{
+    // Arrange
+    TokenIndex index = {0};
+    token_index_init(&index, 0);
+    const char *shared = "t1 t2 t3 t4 t5 t6 t7 t8 t9 t10 "
+                         "t11 t12 t13 t14 t15 t16 t17 t18 t19";
+    token_index_add_document(&index, 1, shared);
+    token_index_add_document(&index, 2, shared);
+    token_index_add_document(&index, 2, "t20");
+
+    // Act
+    int *ids = NULL;
+    int count = token_index_query(
+        &index,
+        "t1 t2 t3 t4 t5 t6 t7 t8 t9 t10 "
+        "t11 t12 t13 t14 t15 t16 t17 t18 t19 t20",
+        &ids);
+
+    // Assert
+    TEST_ASSERT_EQUAL(1, count);
+    TEST_ASSERT_EQUAL(2, ids[0]);
+    free(ids);
+
+    token_index_deinit(&index);
+}
+
+void test_token_index_remove_document_drops_postings(void)
+{
+    // Arrange
+    TokenIndex index = {0};
+    token_index_init(&index, 0);
+    token_index_add_document(&index, 2, "alpha beta");
+    token_index_add_document(&index, 1, "alpha");
+
+    // Act
+    token_index_remove_document(&index, 2, "alpha beta");
+
+    // Assert
+    const PostingList *alpha = token_index_lookup(&index, "alpha");
+    TEST_ASSERT_NOT_NULL(alpha);
+    TEST_ASSERT_EQUAL(1, alpha->count);
+    TEST_ASSERT_EQUAL(1, alpha->ids[0]);
+    TEST_ASSERT_EQUAL(0, token_index_lookup(&index, "beta")->count);
+
+    token_index_deinit(&index);
+}
+
+void test_normalize_isbn_converts_isbn10_to_isbn13(void)
+{
+    // Act & Assert
+    TEST_ASSERT_EQUAL_UINT64(9780306406157ULL, normalize_isbn("0-306-40615-2"));
+    TEST_ASSERT_EQUAL_UINT64(9780306406157ULL, normalize_isbn("978-0-306-40615-7"));
+    TEST_ASSERT_EQUAL_UINT64(9780804429573ULL, normalize_isbn("080442957X"));
+}
+
+void test_normalize_isbn_rejects_malformed_values(void)
+{
+    // Act & Assert
+    TEST_ASSERT_EQUAL_UINT64(0, normalize_isbn(NULL));
+    TEST_ASSERT_EQUAL_UINT64(0, normalize_isbn(""));
+    TEST_ASSERT_EQUAL_UINT64(0, normalize_isbn("ISBN1"));
+    TEST_ASSERT_EQUAL_UINT64(0, normalize_isbn("0-306-40615-3"));
+    TEST_ASSERT_EQUAL_UINT64(0, normalize_isbn("978-0-306-40615-8"));
+    TEST_ASSERT_EQUAL_UINT64(0, normalize_isbn("97803064061570"));
+}
+
+void test_bitset_count_range_across_words(void)
+{
+    // Arrange
+    Bitset bitset = {0};
+    bitset_init(&bitset, 10);
+    bitset_reserve(&bitset, 300);
+    for (int bit = 0; bit < 300; bit += 3) {
+        bitset_set(&bitset, bit);
+    }
+
+    // Act & Assert
+    TEST_ASSERT_EQUAL(100, bitset_count_range(&bitset, 0, 300));
+    TEST_ASSERT_EQUAL(22, bitset_count_range(&bitset, 60, 126));
+    TEST_ASSERT_EQUAL(1, bitset_count_range(&bitset, 63, 64));
+    TEST_ASSERT_EQUAL(0, bitset_count_range(&bitset, 64, 64));
+    bitset_reset(&bitset, 63);
+    TEST_ASSERT_EQUAL(0, bitset_test(&bitset, 63));
+    TEST_ASSERT_EQUAL(21, bitset_count_range(&bitset, 60, 126));
+
+    bitset_deinit(&bitset);
+}
+
+void test_bitset_find_next_skips_empty_words(void)
+{
+    // Arrange
+    Bitset bitset = {0};
+    bitset_init(&bitset, 1000);
+    bitset_set(&bitset, 5);
+    bitset_set(&bitset, 700);
+
+    // Act & Assert
+    TEST_ASSERT_EQUAL(5, bitset_find_next(&bitset, 0, 1000));
+    TEST_ASSERT_EQUAL(700, bitset_find_next(&bitset, 6, 1000));
+    TEST_ASSERT_EQUAL(-1, bitset_find_next(&bitset, 6, 700));
+    TEST_ASSERT_EQUAL(-1, bitset_find_next(&bitset, 701, 5000));
+
+    bitset_deinit(&bitset);
+}
+
+void test_growth_policy_applies_factor_cap_and_huge_pages(void)
+{
+    // Arrange
+    GrowthPolicy doubling = {0};
+    GrowthPolicy capped = {150, 1000, 0};
+    GrowthPolicy huge = {200, 0, 1};
+
+    // Act & Assert
+    TEST_ASSERT_EQUAL(20, growth_policy_next_capacity(&doubling, 10, 11, 8));
+    TEST_ASSERT_EQUAL(1, growth_policy_next_capacity(&doubling, 0, 1, 8));
+    TEST_ASSERT_EQUAL(15, growth_policy_next_capacity(&capped, 10, 11, 8));
+    TEST_ASSERT_EQUAL(11000, growth_policy_next_capacity(&capped, 10000, 10001, 8));
+    TEST_ASSERT_EQUAL(50000, growth_policy_next_capacity(&capped, 10000, 50000, 8));
+    TEST_ASSERT_EQUAL(1000, growth_policy_exact_capacity(&huge, 1000, 1000));
+    TEST_ASSERT_EQUAL(4194304 / 1000,
+                      growth_policy_exact_capacity(&huge, 3000, 1000));
+    TEST_ASSERT_EQUAL(0, growth_policy_is_valid(&doubling));
+    TEST_ASSERT_EQUAL(1, growth_policy_is_valid(&capped));
+}
+
+void test_crc32_matches_reference_and_chains(void)
+{
+    // Arrange
+    const char *text = "123456789";
+
+    // Act
+    uint32_t whole = crc32_update(0, text, 9);
+    uint32_t chained = crc32_update(crc32_update(0, text, 4), text + 4, 5);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT32(0xCBF43926U, whole);
+    TEST_ASSERT_EQUAL_UINT32(whole, chained);
+    TEST_ASSERT_EQUAL_UINT32(0, crc32_update(0, text, 0));
+}
+
+void test_block_compress_round_trip_and_incompressible_input(void)
+{
+    // Arrange
+    static unsigned char input[BLOCK_COMPRESS_MAX_INPUT];
+    static unsigned char packed[BLOCK_COMPRESS_MAX_INPUT];
+    static unsigned char output[BLOCK_COMPRESS_MAX_INPUT];
+    size_t length = 0;
+    while (length + 40 < sizeof(input))
+    {
+        length += (size_t)sprintf((char *)input + length,
+                                  "Dune|Frank Herbert|%u;", (unsigned)length);
+    }
+    unsigned char noise[256];
+    uint32_t state = 12345;
+    for (size_t i = 0; i < sizeof(noise); i++)
+    {
+        state = state * 1103515245U + 12345U;
+        noise[i] = (unsigned char)(state >> 24);
+    }
+
+    // Act
+    size_t packed_length = block_compress(input, length, packed, length - 1);
+    int decoded = block_decompress(packed, packed_length, output, length);
+
+    // Assert
+    TEST_ASSERT_TRUE(packed_length > 0 && packed_length * 3 < length);
+    TEST_ASSERT_EQUAL_INT(1, decoded);
+    TEST_ASSERT_EQUAL_MEMORY(input, output, length);
+    TEST_ASSERT_EQUAL_INT(0, block_decompress(packed, packed_length, output, length - 1));
+    TEST_ASSERT_EQUAL_UINT(0, block_compress(noise, sizeof(noise), packed, sizeof(noise) - 1));
+}
+
+void test_token_index_merge_appends_and_moves_postings(void)
+{
+    // Arrange
+    TokenIndex index;
+    TokenIndex other;
+    token_index_init(&index, 4);
+    token_index_init(&other, 4);
+    token_index_add_document(&index, 1, "Dune");
+    token_index_add_document(&index, 5, "Emma");
+    token_index_add_document(&other, 7, "Dune Messiah");
+    token_index_add_document(&other, 3, "Emma");
+
+    // Act
+    int merged = token_index_merge(&index, &other);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, merged);
+    TEST_ASSERT_FALSE(token_index_is_built(&other));
+    const PostingList *dune = token_index_lookup(&index, "dune");
+    TEST_ASSERT_EQUAL_INT(2, dune->count);
+    TEST_ASSERT_EQUAL_INT(7, dune->ids[1]);
+    const PostingList *emma = token_index_lookup(&index, "emma");
+    TEST_ASSERT_EQUAL_INT(2, emma->count);
+    TEST_ASSERT_EQUAL_INT(3, emma->ids[0]);
+    TEST_ASSERT_EQUAL_INT(7, token_index_lookup(&index, "messiah")->ids[0]);
+
+    token_index_deinit(&index);
+}
+
+void test_id_allocator_blocks_raise_and_release(void)
+{
+    // Arrange
+    IdAllocator allocator = ID_ALLOCATOR_INIT;
+    IdBlock block = {0, 0};
+    IdBlock other = {0, 0};
+
+    // Act & Assert
+    TEST_ASSERT_EQUAL_INT(1, id_allocator_next(&allocator));
+    TEST_ASSERT_EQUAL_INT(2, id_block_take(&block, &allocator, 10));
+    TEST_ASSERT_EQUAL_INT(3, id_block_take(&block, &allocator, 10));
+    TEST_ASSERT_EQUAL_INT(12, id_allocator_peek(&allocator));
+    id_block_release(&block, &allocator);
+    TEST_ASSERT_EQUAL_INT(4, id_allocator_peek(&allocator));
+
+    TEST_ASSERT_EQUAL_INT(4, id_allocator_reserve(&allocator, 5, &block));
+    TEST_ASSERT_EQUAL_INT(9, id_allocator_reserve(&allocator, 5, &other));
+    id_block_release(&block, &allocator);
+    TEST_ASSERT_EQUAL_INT(14, id_allocator_peek(&allocator));
+
+    id_allocator_raise(&allocator, 100);
+    id_allocator_raise(&allocator, 50);
+    TEST_ASSERT_EQUAL_INT(100, id_allocator_next(&allocator));
+
+    id_allocator_reset(&allocator, INT_MAX - 1);
+    TEST_ASSERT_EQUAL_INT(0, id_allocator_reserve(&allocator, 2, &block));
+    TEST_ASSERT_EQUAL_INT(INT_MAX - 1, id_allocator_next(&allocator));
+    TEST_ASSERT_EQUAL_INT(0, id_allocator_next(&allocator));
+}
+
+typedef struct
+{
+    int *visits;
+    long long *partials;
+    int nested_chunks;
+} SumScan;
+
+static void visit_and_sum(void *context, int chunk, int begin, int end)
+{
+    SumScan *scan = (SumScan *)context;
+    long long sum = 0;
+    for (int i = begin; i < end; i++)
+    {
+        scan->visits[i]++;
+        sum += i;
+    }
+    scan->partials[chunk] = sum;
+}
+
+static void count_nested_chunk(void *context, int chunk, int begin, int end)
+{
+    (void)chunk;
+    (void)begin;
+    (void)end;
+    SumScan *scan = (SumScan *)context;
+    scan->nested_chunks++;
+}
+
+static void nest_parallel_for(void *context, int chunk, int begin, int end)
+{
+    (void)begin;
+    (void)end;
+    if (chunk == 0)
+    {
+        // Runs inline on this thread instead of waiting on the busy pool
+        parallel_for(
+            3 * parallel_for_chunk_items(1), 1, count_nested_chunk, context);
+    }
+}
+
+void test_parallel_for_visits_every_item_once_per_chunk(void)
+{
+    // Arrange
+    int count = 10 * parallel_for_chunk_items(sizeof(int)) + 3;
+    int num_chunks = parallel_for_chunks(count, sizeof(int));
+    SumScan scan = {calloc((size_t)count, sizeof(int)),
+                    calloc((size_t)num_chunks, sizeof(long long)),
+                    0};
+    set_parallel_for_threads(4);
+
+    // Act
+    int ran = parallel_for(count, sizeof(int), visit_and_sum, &scan);
+    int nested = parallel_for(count, sizeof(int), nest_parallel_for, &scan);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, ran);
+    TEST_ASSERT_EQUAL_INT(1, nested);
+    TEST_ASSERT_EQUAL_INT(11, num_chunks);
+    long long total = 0;
+    for (int i = 0; i < num_chunks; i++)
+    {
+        total += scan.partials[i];
+    }
+    TEST_ASSERT_TRUE(total == (long long)count * (count - 1) / 2);
+    for (int i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL_INT(1, scan.visits[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(3, scan.nested_chunks);
+    TEST_ASSERT_EQUAL_INT(0, parallel_for(-1, 1, visit_and_sum, &scan));
+    TEST_ASSERT_EQUAL_INT(0, parallel_for_chunks(0, 1));
+
+    // Cleanup
+    set_parallel_for_threads(0);
+    free(scan.visits);
+    free(scan.partials);
+}
+
+static void *scan_from_other_thread(void *context)
+{
+    parallel_for(
+        3 * parallel_for_chunk_items(1), 1, count_nested_chunk, context);
+    return NULL;
+}
+
+static void wait_for_other_caller(void *context, int chunk, int begin, int end)
+{
+    (void)begin;
+    (void)end;
+    if (chunk == 0)
+    {
+        // This job holds the pool; waiting on it here would never return
+        pthread_t caller;
+        pthread_create(&caller, NULL, scan_from_other_thread, context);
+        pthread_join(caller, NULL);
+    }
+}
+
+void test_parallel_for_runs_inline_while_the_pool_is_busy(void)
+{
+    // Arrange
+    SumScan scan = {NULL, NULL, 0};
+    set_parallel_for_threads(2);
+
+    // Act
+    int ran = parallel_for(
+        4 * parallel_for_chunk_items(1), 1, wait_for_other_caller, &scan);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, ran);
+    TEST_ASSERT_EQUAL_INT(3, scan.nested_chunks);
+
+    // Cleanup
+    set_parallel_for_threads(0);
+}
+
+typedef struct
+{
+    WorkStealingPool *pool;
+    WorkGroup *group;
+    atomic_int *visits;
+    int begin;
+    int end;
+} SplitTask;
+
+// Hands the upper half of its range back to the pool until the rest is
+// small, then visits what is left
+static void split_and_visit(void *context)
+{
+    SplitTask *task = (SplitTask *)context;
+    while (task->end - task->begin > 64)
+    {
+        SplitTask *upper = malloc(sizeof(SplitTask));
+        *upper = *task;
+        upper->begin = task->begin + (task->end - task->begin) / 2;
+        task->end = upper->begin;
+        work_pool_submit(task->pool, task->group, split_and_visit, upper);
+    }
+    for (int i = task->begin; i < task->end; i++)
+    {
+        atomic_fetch_add(&task->visits[i], 1);
+    }
+    free(task);
+}
+
+void test_work_pool_runs_split_tasks_once_each(void)
+{
+    for (int threads = 1; threads <= 4; threads += 3)
+    {
+        // Arrange
+        int count = 10000;
+        atomic_int *visits = calloc((size_t)count, sizeof(atomic_int));
+        WorkStealingPool *pool = work_pool_create(threads);
+        WorkGroup group = WORK_GROUP_INIT;
+        SplitTask *root = malloc(sizeof(SplitTask));
+        *root = (SplitTask){pool, &group, visits, 0, count};
+
+        // Act
+        int submitted = work_pool_submit(pool, &group, split_and_visit, root);
+        work_group_wait(pool, &group);
+
+        // Assert
+        TEST_ASSERT_EQUAL_INT(1, submitted);
+        TEST_ASSERT_EQUAL_INT(threads, work_pool_threads(pool));
+        TEST_ASSERT_EQUAL_INT(0, atomic_load(&group.pending));
+        for (int i = 0; i < count; i++)
+        {
+            TEST_ASSERT_EQUAL_INT(1, atomic_load(&visits[i]));
+        }
+        TEST_ASSERT_EQUAL_INT(0, work_pool_submit(pool, &group, NULL, NULL));
+
+        // Cleanup
+        work_pool_destroy(pool);
+        free(visits);
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hash_index_put_and_get);
+    RUN_TEST(test_hash_index_put_overwrites_existing_key);
+    RUN_TEST(test_hash_index_grows_and_keeps_entries);
+    RUN_TEST(test_hash_index_remove_keeps_probe_chains_intact);
+    RUN_TEST(test_hash_index_rejects_zero_key_and_unbuilt_index);
+    RUN_TEST(test_next_token_folds_case_and_skips_punctuation);
+    RUN_TEST(test_token_index_query_intersects_posting_lists);
+    RUN_TEST(test_token_index_query_uses_every_term_of_a_long_query);
+    RUN_TEST(test_token_index_remove_document_drops_postings);
+    RUN_TEST(test_normalize_isbn_converts_isbn10_to_isbn13);
+    RUN_TEST(test_normalize_isbn_rejects_malformed_values);
+    RUN_TEST(test_bitset_count_range_across_words);
+    RUN_TEST(test_bitset_find_next_skips_empty_words);
+    RUN_TEST(test_growth_policy_applies_factor_cap_and_huge_pages);
+    RUN_TEST(test_crc32_matches_reference_and_chains);
+    RUN_TEST(test_block_compress_round_trip_and_incompressible_input);
+    RUN_TEST(test_token_index_merge_appends_and_moves_postings);
+    RUN_TEST(test_id_allocator_blocks_raise_and_release);
+    RUN_TEST(test_parallel_for_visits_every_item_once_per_chunk);
+    RUN_TEST(test_parallel_for_runs_inline_while_the_pool_is_busy);
+    RUN_TEST(test_work_pool_runs_split_tasks_once_each);
+
+    return UNITY_END();
+}
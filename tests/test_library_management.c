@@ -1,10 +1,27 @@
 // test_library_management.c
 #include "unity.h"
 #include "library_management.h"
+#include "background_snapshot.h"
+#include "consortium.h"
+#include "library_export.h"
+#include "library_file.h"
+#include "library_journal.h"
+#include "library_lazy.h"
+#include "library_shards.h"
+#include "library_snapshot.h"
+#include "book_availability.h"
+#include "book_columns.h"
+#include "book_import.h"
 #include "book_management.h"
+#include "library_lock.h"
 #include "member_management.h"
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <threads.h>
+#include <time.h>
 
 void setUp(void) {
     // Setup runs before each test
@@ -126,13 +143,11 @@ void test_save_library_to_file_with_empty_library(void) {
     FILE *file = fopen(filename, "rb");
     TEST_ASSERT_NOT_NULL(file);
 
-    int num_books = -1;
-    int num_members = -1;
-    fread(&num_books, sizeof(int), 1, file);
-    fread(&num_members, sizeof(int), 1, file);
-
-    TEST_ASSERT_EQUAL(0, num_books);
-    TEST_ASSERT_EQUAL(0, num_members);
+    LibraryFileTable table;
+    TEST_ASSERT_EQUAL(1, library_file_read_table(file, &table));
+    TEST_ASSERT_EQUAL(LIBRARY_FILE_VERSION_MAJOR, table.version_major);
+    TEST_ASSERT_EQUAL(0, library_file_find_section(&table, SECTION_BOOKS)->count);
+    TEST_ASSERT_EQUAL(0, library_file_find_section(&table, SECTION_MEMBERS)->count);
 
     fclose(file);
     remove(filename);
@@ -165,26 +180,25 @@ void test_save_library_to_file_with_books_and_members(void) {
     FILE *file = fopen(filename, "rb");
     TEST_ASSERT_NOT_NULL(file);
 
-    int num_books = -1;
-    int num_members = -1;
-    fread(&num_books, sizeof(int), 1, file);
-    fread(&num_members, sizeof(int), 1, file);
+    LibraryFileTable table;
+    TEST_ASSERT_EQUAL(1, library_file_read_table(file, &table));
+    TEST_ASSERT_EQUAL(1, library_file_find_section(&table, SECTION_BOOKS)->count);
+    TEST_ASSERT_EQUAL(1, library_file_find_section(&table, SECTION_MEMBERS)->count);
+    fclose(file);
 
-    TEST_ASSERT_EQUAL(1, num_books);
-    TEST_ASSERT_EQUAL(1, num_members);
+    Library *loaded_library = load_library_from_file(filename);
+    TEST_ASSERT_NOT_NULL(loaded_library);
 
-    Book read_book;
-    fread(&read_book, sizeof(Book), 1, file);
+    Book read_book = loaded_library->books[0];
     TEST_ASSERT_EQUAL_STRING("Test Book", read_book.title);
     TEST_ASSERT_EQUAL_STRING("Test Author", read_book.author);
     TEST_ASSERT_EQUAL_STRING("1234567890", read_book.isbn);
 
-    Member read_member;
-    fread(&read_member, sizeof(Member), 1, file);
+    Member read_member = loaded_library->members[0];
     TEST_ASSERT_EQUAL_STRING("Test Member", read_member.name);
     TEST_ASSERT_EQUAL_STRING("test@example.com", read_member.email);
 
-    fclose(file);
+    delete_library(loaded_library);
     remove(filename);
     deinit_library(&library);
 }
@@ -232,6 +246,1561 @@ void test_load_library_from_file_with_no_books_and_no_members(void) {
     deinit_library(&library);
 }
 
+void test_load_library_from_file_rebuilds_book_index(void) {
+    const char *filename = "test_indexed_library.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    for (int i = 0; i < 25; i++) {
+        add_book_to_library(&library, "Title", "Author", "ISBN");
+    }
+    save_library_to_file(&library, filename);
+
+    // Act
+    Library *loaded_library = load_library_from_file(filename);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(loaded_library);
+    TEST_ASSERT_EQUAL_INT(25, loaded_library->book_index.count);
+    Book *book = find_book_by_id(loaded_library, 17);
+    TEST_ASSERT_NOT_NULL(book);
+    TEST_ASSERT_EQUAL_INT(17, book->ident);
+
+    // Cleanup
+    delete_library(loaded_library);
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_tombstone_removal_reuses_slots_and_keeps_indexes(void) {
+    Library library = {0};
+    init_library(&library);
+    library.removal_mode = REMOVAL_TOMBSTONE;
+    library.compaction_threshold = 0;
+    reset_book_id();
+    for (int i = 0; i < 8; i++) {
+        add_book_to_library(&library, "Title", "Author", "ISBN");
+    }
+
+    // Act
+    remove_book_from_library(&library, 3);
+    remove_book_from_library(&library, 6);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(8, library.num_books);
+    TEST_ASSERT_EQUAL_INT(6, count_books(&library));
+    TEST_ASSERT_NULL(find_book_by_id(&library, 3));
+    TEST_ASSERT_EQUAL_INT(7, find_book_by_id(&library, 7)->ident);
+    // Freed slots are never on the shelf for a lock-free checkout
+    TEST_ASSERT_EQUAL_INT(0, library.books[2].is_available);
+    TEST_ASSERT_EQUAL_INT(0, library.books[5].is_available);
+
+    // Most recently freed slot is reused first
+    enable_book_columns(&library);
+    TEST_ASSERT_EQUAL_INT(6, count_available_books(&library));
+    add_book_to_library(&library, "Reused", "Author", "ISBN");
+    TEST_ASSERT_EQUAL_INT(8, library.num_books);
+    TEST_ASSERT_EQUAL_STRING("Reused", library.books[5].title);
+    TEST_ASSERT_EQUAL_PTR(&library.books[5], find_book_by_id(&library, 9));
+
+    compact_library(&library);
+    TEST_ASSERT_EQUAL_INT(7, library.num_books);
+    TEST_ASSERT_EQUAL_INT(0, library.num_free_books);
+    TEST_ASSERT_EQUAL_INT(4, library.books[2].ident);
+    TEST_ASSERT_EQUAL_PTR(&library.books[2], find_book_by_id(&library, 4));
+    TEST_ASSERT_EQUAL_PTR(&library.books[4], find_book_by_id(&library, 9));
+    TEST_ASSERT_EQUAL_INT(9, book_ident_at(&library, 4));
+    TEST_ASSERT_EQUAL_INT(7, count_available_books(&library));
+
+    deinit_library(&library);
+}
+
+void test_tombstone_removal_compacts_past_threshold(void) {
+    Library library = {0};
+    init_library(&library);
+    library.removal_mode = REMOVAL_TOMBSTONE;
+    library.compaction_threshold = 50;
+    reset_next_member_id();
+    for (int i = 0; i < 4; i++) {
+        add_member_to_library(&library, "Member", "member@example.com");
+    }
+
+    // Act & Assert
+    remove_member_from_library(&library, 1);
+    TEST_ASSERT_EQUAL_INT(4, library.num_members);
+    TEST_ASSERT_EQUAL_INT(3, count_members(&library));
+
+    remove_member_from_library(&library, 2);
+    TEST_ASSERT_EQUAL_INT(2, library.num_members);
+    TEST_ASSERT_EQUAL_INT(0, library.num_free_members);
+    TEST_ASSERT_EQUAL_INT(3, library.members[0].ident);
+    TEST_ASSERT_EQUAL_PTR(&library.members[1], find_member_by_id(&library, 4));
+
+    deinit_library(&library);
+}
+
+void test_save_library_to_file_skips_tombstones(void) {
+    const char *filename = "test_tombstoned_library.dat";
+    Library library = {0};
+    init_library(&library);
+    library.removal_mode = REMOVAL_TOMBSTONE;
+    library.compaction_threshold = 0;
+    reset_book_id();
+    for (int i = 0; i < 5; i++) {
+        add_book_to_library(&library, "Title", "Author", "ISBN");
+    }
+    remove_book_from_library(&library, 2);
+    remove_book_from_library(&library, 4);
+    save_library_to_file(&library, filename);
+
+    // Act
+    Library *loaded_library = load_library_from_file(filename);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(loaded_library);
+    TEST_ASSERT_EQUAL_INT(3, loaded_library->num_books);
+    TEST_ASSERT_EQUAL_INT(1, loaded_library->books[0].ident);
+    TEST_ASSERT_EQUAL_INT(3, loaded_library->books[1].ident);
+    TEST_ASSERT_EQUAL_INT(5, loaded_library->books[2].ident);
+
+    // Cleanup
+    delete_library(loaded_library);
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_availability_counters_follow_transactions(void) {
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    for (int i = 0; i < 100; i++) {
+        add_book_to_library(&library, "Title", "Author", "ISBN");
+    }
+    add_member_to_library(&library, "Member", "member@example.com");
+
+    // Act
+    borrow_book(&library, 1, 1);
+    borrow_book(&library, 1, 2);
+    borrow_book(&library, 1, 70);
+    return_book(&library, 1, 2);
+    remove_book_from_library(&library, 50);
+    remove_book_from_library(&library, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(97, available_book_total(&library));
+    TEST_ASSERT_EQUAL_INT(count_available_books(&library),
+                          available_book_total(&library));
+    TEST_ASSERT_EQUAL_INT(19, count_available_books_in_range(&library, 41, 60));
+    TEST_ASSERT_EQUAL_INT(30, count_available_books_in_range(&library, 70, 100));
+    TEST_ASSERT_EQUAL_INT(2, find_first_available_book(&library, 1, 100)->ident);
+    TEST_ASSERT_EQUAL_INT(71, find_first_available_book(&library, 70, 100)->ident);
+    TEST_ASSERT_NULL(find_first_available_book(&library, 70, 70));
+
+    deinit_library(&library);
+}
+
+void test_load_library_from_file_keeps_author_ids(void) {
+    const char *filename = "test_author_library.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    add_book_to_library(&library, "Emma", "Jane Austen", "1");
+    add_book_to_library(&library, "Dune", "Frank Herbert", "2");
+    add_book_to_library(&library, "Dune Messiah", "Frank Herbert", "3");
+    remove_book_from_library(&library, 1);
+    uint32_t herbert = find_book_by_id(&library, 2)->author_id;
+    save_library_to_file(&library, filename);
+
+    // Act
+    Library *loaded_library = load_library_from_file(filename);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(loaded_library);
+    TEST_ASSERT_EQUAL_UINT32(herbert, find_book_by_id(loaded_library, 3)->author_id);
+    int num_results = 0;
+    Book *results = find_books_by_author(loaded_library, "Frank Herbert", &num_results);
+    TEST_ASSERT_EQUAL_INT(2, num_results);
+    free(results);
+    add_book_to_library(loaded_library, "Persuasion", "Jane Austen", "4");
+    TEST_ASSERT_EQUAL_INT(2, loaded_library->authors.num_names);
+
+    // Cleanup
+    delete_library(loaded_library);
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_library_reserve_and_growth_policy(void) {
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    GrowthPolicy invalid = {100, 0, 0};
+    GrowthPolicy linear = {150, 4, 0};
+
+    // Act & Assert
+    TEST_ASSERT_EQUAL_INT(1, library_reserve(&library, 1000, 50));
+    TEST_ASSERT_EQUAL_INT(1000, library.capacity_books);
+    TEST_ASSERT_EQUAL_INT(50, library.capacity_members);
+    TEST_ASSERT_EQUAL_INT(1, library_reserve(&library, 10, 10));
+    TEST_ASSERT_EQUAL_INT(1000, library.capacity_books);
+
+    TEST_ASSERT_EQUAL_INT(0, set_library_growth_policy(&library, &invalid));
+    TEST_ASSERT_EQUAL_INT(1, set_library_growth_policy(&library, &linear));
+    for (int i = 0; i < 51; i++) {
+        add_member_to_library(&library, "Name", "email");
+    }
+    TEST_ASSERT_EQUAL_INT(54, library.capacity_members);
+
+    deinit_library(&library);
+}
+
+void test_load_library_from_file_rejects_corrupt_sections(void) {
+    const char *filename = "test_corrupt_library.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    add_book_to_library(&library, "Dune", "Frank Herbert", "1");
+    save_library_to_file(&library, filename);
+
+    FILE *file = fopen(filename, "r+b");
+    TEST_ASSERT_NOT_NULL(file);
+    LibraryFileTable table;
+    TEST_ASSERT_EQUAL(1, library_file_read_table(file, &table));
+    const SectionEntry *books = library_file_find_section(&table, SECTION_BOOKS);
+    TEST_ASSERT_EQUAL(0, books->offset % LIBRARY_FILE_ALIGNMENT);
+    TEST_ASSERT_EQUAL(BOOK_RECORD_SIZE, books->length);
+
+    // Act
+    fseek(file, (long)books->offset + 10, SEEK_SET);
+    fputc('X', file);
+    fclose(file);
+    Library *loaded_library = load_library_from_file(filename);
+
+    // Assert
+    TEST_ASSERT_NULL(loaded_library);
+
+    file = fopen(filename, "r+b");
+    fputc('X', file);
+    fclose(file);
+    TEST_ASSERT_NULL(load_library_from_file(filename));
+
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_map_library_from_file_copies_on_write(void) {
+    const char *filename = "test_mapped_library.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    add_book_to_library(&library, "Dune", "Frank Herbert", "1");
+    add_book_to_library(&library, "Emma", "Jane Austen", "2");
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    save_library_to_file(&library, filename);
+
+    // Act
+    Library *mapped = map_library_from_file(filename, 1);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(mapped);
+    TEST_ASSERT_EQUAL_INT(1, mapped->books_mapped);
+    TEST_ASSERT_EQUAL_STRING("Emma", find_book_by_id(mapped, 2)->title);
+    int num_results = 0;
+    Book *results = search_books(mapped, "dune", &num_results);
+    TEST_ASSERT_EQUAL_INT(1, num_results);
+    free(results);
+
+    TEST_ASSERT_EQUAL_INT(1, borrow_book(mapped, 1, 1));
+    TEST_ASSERT_EQUAL_INT(1, available_book_total(mapped));
+    Library *reopened = map_library_from_file(filename, 0);
+    TEST_ASSERT_EQUAL_INT(1, find_book_by_id(reopened, 1)->is_available);
+    deinit_library(reopened);
+    free(reopened);
+
+    TEST_ASSERT_EQUAL_INT(
+        1, add_book_to_library(mapped, "Persuasion", "Jane Austen", "3"));
+    TEST_ASSERT_EQUAL_INT(0, mapped->books_mapped);
+    TEST_ASSERT_EQUAL_INT(0, find_book_by_id(mapped, 1)->is_available);
+    TEST_ASSERT_EQUAL_INT(3, count_books(mapped));
+
+    // Cleanup
+    deinit_library(mapped);
+    free(mapped);
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_journal_replay_restores_operations_and_drops_torn_tail(void) {
+    const char *journal_path = "test_replay.journal";
+    remove(journal_path);
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    LibraryJournal journal;
+    TEST_ASSERT_EQUAL_INT(1, journal_open(&journal, journal_path, NULL, &library));
+    journal_add_book(&journal, &library, "Dune", "Frank Herbert", "1");
+    journal_add_book(&journal, &library, "Emma", "Jane Austen", "2");
+    journal_add_member(&journal, &library, "Reader", "reader@example.com");
+    journal_borrow_book(&journal, &library, 1, 2);
+    journal_remove_book(&journal, &library, 1);
+    TEST_ASSERT_EQUAL_INT(1, journal_close(&journal));
+    time_t added = find_book_by_id(&library, 2)->added_date;
+    // Replay on a later second, so a date restamped on replay would show
+    struct timespec pause = {0, 20000000};
+    while (time(NULL) == added) {
+        thrd_sleep(&pause, NULL);
+    }
+
+    // A crash in the middle of the next append leaves a partial record
+    FILE *file = fopen(journal_path, "ab");
+    fputs("torn", file);
+    fclose(file);
+
+    // Act
+    Library replayed = {0};
+    init_library(&replayed);
+    reset_book_id();
+    reset_next_member_id();
+    int opened = journal_open(&journal, journal_path, NULL, &replayed);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, opened);
+    TEST_ASSERT_EQUAL_INT(5, journal.replayed_records);
+    TEST_ASSERT_EQUAL_INT(5, (int)replayed.journal_lsn);
+    TEST_ASSERT_NULL(find_book_by_id(&replayed, 1));
+    TEST_ASSERT_EQUAL_INT(0, find_book_by_id(&replayed, 2)->is_available);
+    TEST_ASSERT_TRUE(find_book_by_id(&replayed, 2)->added_date == added);
+    TEST_ASSERT_EQUAL_INT(1, find_member_by_id(&replayed, 1)->num_borrowed_books);
+    TEST_ASSERT_EQUAL_INT(1, journal_add_book(&journal, &replayed, "Persuasion", "Jane Austen", "3"));
+    TEST_ASSERT_NOT_NULL(find_book_by_id(&replayed, 3));
+    TEST_ASSERT_EQUAL_INT(6, (int)replayed.journal_lsn);
+
+    // Cleanup
+    journal_close(&journal);
+    remove(journal_path);
+    deinit_library(&replayed);
+    deinit_library(&library);
+}
+
+void test_journal_adds_keep_reserved_ids_and_skip_merges(void) {
+    const char *journal_path = "test_reserved_ids.journal";
+    remove(journal_path);
+    Library library = {0};
+    init_library(&library);
+    library.isbn_duplicate_policy = ISBN_DUPLICATE_MERGE;
+    reset_book_id();
+    reset_next_member_id();
+    LibraryJournal journal;
+    journal_open(&journal, journal_path, NULL, &library);
+    // IDs drawn elsewhere, e.g. by a consortium sharing the allocators
+    id_allocator_next(book_id_allocator());
+    id_allocator_next(book_id_allocator());
+    id_allocator_next(member_id_allocator());
+
+    // Act
+    int added = journal_add_book(
+        &journal, &library, "Dune", "Frank Herbert", "9780441013593");
+    int merged = journal_add_book(
+        &journal, &library, "Dune", "Frank Herbert", "9780441013593");
+    int member = journal_add_member(
+        &journal, &library, "Reader", "reader@example.com");
+    uint64_t lsn = library.journal_lsn;
+    journal_close(&journal);
+    Library replayed = {0};
+    init_library(&replayed);
+    reset_book_id();
+    reset_next_member_id();
+    journal_open(&journal, journal_path, NULL, &replayed);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, added);
+    TEST_ASSERT_EQUAL_INT(1, merged);
+    TEST_ASSERT_EQUAL_INT(1, member);
+    TEST_ASSERT_EQUAL_INT(2, (int)lsn);
+    TEST_ASSERT_EQUAL_INT(1, count_books(&library));
+    TEST_ASSERT_EQUAL_INT(2, journal.replayed_records);
+    TEST_ASSERT_EQUAL_STRING("Dune", find_book_by_id(&replayed, 3)->title);
+    TEST_ASSERT_NOT_NULL(find_member_by_id(&replayed, 2));
+
+    // Cleanup
+    journal_close(&journal);
+    remove(journal_path);
+    deinit_library(&replayed);
+    deinit_library(&library);
+}
+
+typedef struct {
+    LibraryJournal *journal;
+    Library *library;
+    int member_id;
+    int recorded;
+} FrontDesk;
+
+static void *lend_one_book(void *argument) {
+    FrontDesk *desk = (FrontDesk *)argument;
+    for (int i = 0; i < 500; i++) {
+        if (journal_borrow_book(desk->journal, desk->library, desk->member_id, 1)) {
+            desk->recorded++;
+            desk->recorded += journal_return_book(desk->journal, desk->library, desk->member_id, 1);
+        }
+    }
+    return NULL;
+}
+
+void test_journal_records_concurrent_loans_in_applied_order(void) {
+    const char *journal_path = "test_concurrent.journal";
+    remove(journal_path);
+    Library library = {0};
+    init_library(&library);
+    enable_library_concurrency(&library);
+    reset_book_id();
+    reset_next_member_id();
+    LibraryJournal journal;
+    journal_open(&journal, journal_path, NULL, &library);
+    journal_add_book(&journal, &library, "Dune", "Frank Herbert", "1");
+    journal_add_member(&journal, &library, "First", "first@example.com");
+    journal_add_member(&journal, &library, "Second", "second@example.com");
+    FrontDesk desks[2] = {{&journal, &library, 1, 0}, {&journal, &library, 2, 0}};
+    pthread_t threads[2];
+
+    // Act
+    for (int i = 0; i < 2; i++) {
+        pthread_create(&threads[i], NULL, lend_one_book, &desks[i]);
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    journal_close(&journal);
+    Library replayed = {0};
+    init_library(&replayed);
+    journal_open(&journal, journal_path, NULL, &replayed);
+
+    // Assert
+    int recorded = 3 + desks[0].recorded + desks[1].recorded;
+    TEST_ASSERT_EQUAL_INT(recorded, (int)library.journal_lsn);
+    TEST_ASSERT_EQUAL_INT(recorded, journal.replayed_records);
+    TEST_ASSERT_EQUAL_INT(1, find_book_by_id(&replayed, 1)->is_available);
+    TEST_ASSERT_EQUAL_INT(0, find_member_by_id(&replayed, 1)->num_borrowed_books);
+    TEST_ASSERT_EQUAL_INT(0, find_member_by_id(&replayed, 2)->num_borrowed_books);
+
+    // Cleanup
+    journal_close(&journal);
+    remove(journal_path);
+    deinit_library(&replayed);
+    deinit_library(&library);
+}
+
+void test_journal_checkpoint_truncates_and_skips_applied_records(void) {
+    const char *journal_path = "test_checkpoint.journal";
+    const char *snapshot_path = "test_checkpoint.dat";
+    remove(journal_path);
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    LibraryJournal journal;
+    journal_open(&journal, journal_path, snapshot_path, &library);
+    journal_add_book(&journal, &library, "Dune", "Frank Herbert", "1");
+    journal_add_member(&journal, &library, "Reader", "reader@example.com");
+
+    // Act
+    int checkpointed = journal_checkpoint(&journal, &library);
+    journal_borrow_book(&journal, &library, 1, 1);
+    journal_close(&journal);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, checkpointed);
+    reset_book_id();
+    reset_next_member_id();
+    Library *loaded = load_library_from_file(snapshot_path);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(2, (int)loaded->journal_lsn);
+    TEST_ASSERT_EQUAL_INT(1, journal_open(&journal, journal_path, snapshot_path, loaded));
+    TEST_ASSERT_EQUAL_INT(1, journal.replayed_records);
+    TEST_ASSERT_EQUAL_INT(1, count_books(loaded));
+    TEST_ASSERT_EQUAL_INT(0, find_book_by_id(loaded, 1)->is_available);
+    TEST_ASSERT_EQUAL_INT(2, get_next_book_id());
+
+    // Cleanup
+    journal_close(&journal);
+    remove(journal_path);
+    remove(snapshot_path);
+    deinit_library(loaded);
+    free(loaded);
+    deinit_library(&library);
+}
+
+void test_saving_a_mapped_library_over_its_file_keeps_the_mapping(void) {
+    const char *filename = "test_mapped_resave_library.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    BookRecord *records = calloc(20000, sizeof(BookRecord));
+    for (int i = 0; i < 20000; i++) {
+        records[i] = (BookRecord){"Title", "Author", "", 0, 0};
+    }
+    add_books_bulk(&library, records, 20000);
+    save_library_to_file(&library, filename);
+    Library *mapped = map_library_from_file(filename, 0);
+
+    // Act
+    int saved = save_library_to_file(mapped, filename);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, saved);
+    TEST_ASSERT_EQUAL_INT(1, mapped->books_mapped);
+    TEST_ASSERT_EQUAL_INT(20000, find_book_by_id(mapped, 20000)->ident);
+    Library *reloaded = load_library_from_file(filename);
+    TEST_ASSERT_NOT_NULL(reloaded);
+    TEST_ASSERT_EQUAL_INT(20000, count_books(reloaded));
+
+    // Cleanup
+    delete_library(reloaded);
+    delete_library(mapped);
+    remove(filename);
+    free(records);
+    deinit_library(&library);
+}
+
+void test_background_snapshot_captures_point_in_time(void) {
+    const char *filename = "test_background.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    add_book_to_library(&library, "Dune", "Frank Herbert", "1");
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    BackgroundSnapshot snapshot = {0};
+
+    // Act
+    int started = background_snapshot_start(&snapshot, &library, filename);
+    borrow_book(&library, 1, 1);
+    add_book_to_library(&library, "Emma", "Jane Austen", "2");
+    SnapshotState state = background_snapshot_poll(&snapshot, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, started);
+    TEST_ASSERT_EQUAL_INT(SNAPSHOT_COMPLETED, state);
+    TEST_ASSERT_EQUAL_INT(SNAPSHOT_IDLE, background_snapshot_poll(&snapshot, 0));
+    TEST_ASSERT_EQUAL_INT(1, snapshot.metrics.completed);
+    TEST_ASSERT_TRUE(snapshot.metrics.bytes_written > 0);
+    TEST_ASSERT_TRUE(snapshot.metrics.duration_ms >= 0);
+    Library *loaded = load_library_from_file(filename);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(1, count_books(loaded));
+    TEST_ASSERT_EQUAL_INT(1, find_book_by_id(loaded, 1)->is_available);
+
+    // Cleanup
+    background_snapshot_deinit(&snapshot);
+    deinit_library(loaded);
+    free(loaded);
+    remove(filename);
+    deinit_library(&library);
+}
+
+typedef struct {
+    Library *library;
+    atomic_int stop;
+    int loans;
+} LendingDesk;
+
+static void *lend_until_stopped(void *argument) {
+    LendingDesk *desk = (LendingDesk *)argument;
+    while (!atomic_load(&desk->stop)) {
+        desk->loans += borrow_book(desk->library, 1, 2) && return_book(desk->library, 1, 2);
+    }
+    return NULL;
+}
+
+void test_background_snapshot_runs_beside_other_threads(void) {
+    const char *filename = "test_background_threads.dat";
+    Library library = {0};
+    init_library(&library);
+    enable_library_concurrency(&library);
+    reset_book_id();
+    reset_next_member_id();
+    add_book_to_library(&library, "Dune", "Frank Herbert", "1");
+    add_book_to_library(&library, "Emma", "Jane Austen", "2");
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    borrow_book(&library, 1, 1);
+    BackgroundSnapshot snapshot = {0};
+    LendingDesk desk = {&library, 0, 0};
+    pthread_t front_desk;
+    pthread_create(&front_desk, NULL, lend_until_stopped, &desk);
+
+    // Act
+    int started = background_snapshot_start(&snapshot, &library, filename);
+    SnapshotState state = background_snapshot_poll(&snapshot, 1);
+    atomic_store(&desk.stop, 1);
+    pthread_join(front_desk, NULL);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, started);
+    TEST_ASSERT_EQUAL_INT(SNAPSHOT_COMPLETED, state);
+    TEST_ASSERT_EQUAL_INT(1, (int)library.generation);
+    Library *loaded = load_library_from_file(filename);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(2, count_books(loaded));
+    TEST_ASSERT_EQUAL_INT(0, find_book_by_id(loaded, 1)->is_available);
+    TEST_ASSERT_EQUAL_INT(1, (int)loaded->generation);
+    TEST_ASSERT_EQUAL_UINT32(find_book_by_id(&library, 2)->author_id,
+                             find_book_by_id(loaded, 2)->author_id);
+
+    // Cleanup
+    background_snapshot_deinit(&snapshot);
+    deinit_library(loaded);
+    free(loaded);
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_journal_checkpoints_in_background(void) {
+    const char *journal_path = "test_background.journal";
+    const char *snapshot_path = "test_background_checkpoint.dat";
+    remove(journal_path);
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    LibraryJournal journal;
+    journal_open(&journal, journal_path, snapshot_path, &library);
+    journal.checkpoint_records = 2;
+
+    // Act
+    journal_add_book(&journal, &library, "Dune", "Frank Herbert", "1");
+    journal_add_book(&journal, &library, "Emma", "Jane Austen", "2");
+    journal_add_book(&journal, &library, "Persuasion", "Jane Austen", "3");
+    journal_close(&journal);
+
+    // Assert
+    FILE *file = fopen(journal_path, "rb");
+    fseek(file, 0, SEEK_END);
+    long journal_size = ftell(file);
+    fclose(file);
+    // Header plus the one record the snapshot does not cover
+    TEST_ASSERT_EQUAL_INT(JOURNAL_HEADER_SIZE + 17 + 4 + 11 + 12 + 2 + 8, (int)journal_size);
+    reset_book_id();
+    Library *loaded = load_library_from_file(snapshot_path);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(2, (int)loaded->journal_lsn);
+    TEST_ASSERT_EQUAL_INT(1, journal_open(&journal, journal_path, snapshot_path, loaded));
+    TEST_ASSERT_EQUAL_INT(1, journal.replayed_records);
+    TEST_ASSERT_EQUAL_INT(3, count_books(loaded));
+
+    // Cleanup
+    journal_close(&journal);
+    remove(journal_path);
+    remove(snapshot_path);
+    deinit_library(loaded);
+    free(loaded);
+    deinit_library(&library);
+}
+
+static void assert_dump_round_trip(DumpFormat format) {
+    const char *books_path = "test_dump_books.txt";
+    const char *members_path = "test_dump_members.txt";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    add_book_to_library(&library, "Dune", "Frank Herbert", "1");
+    add_book_to_library(&library, "Say \"Hi\", \\Bye", "Tab\tAuthor", "2");
+    add_book_to_library(&library, "Caf\xc3\xa9", "Jane Austen", "3");
+    remove_book_from_library(&library, 1);
+    add_member_to_library(&library, "Reader, A", "reader@example.com");
+    borrow_book(&library, 1, 3);
+
+    // Act
+    int books_written = export_library_books(&library, books_path, format);
+    int members_written = export_library_members(&library, members_path, format);
+    Library restored = {0};
+    init_library(&restored);
+    reset_book_id();
+    reset_next_member_id();
+    int books_read = import_library_books(&restored, books_path, format);
+    int members_read = import_library_members(&restored, members_path, format);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(2, books_written);
+    TEST_ASSERT_EQUAL_INT(1, members_written);
+    TEST_ASSERT_EQUAL_INT(2, books_read);
+    TEST_ASSERT_EQUAL_INT(1, members_read);
+    TEST_ASSERT_NULL(find_book_by_id(&restored, 1));
+    Book *quoted = find_book_by_id(&restored, 2);
+    TEST_ASSERT_EQUAL_STRING("Say \"Hi\", \\Bye", quoted->title);
+    TEST_ASSERT_EQUAL_STRING("Tab\tAuthor", quoted->author);
+    TEST_ASSERT_EQUAL(find_book_by_id(&library, 2)->added_date, quoted->added_date);
+    TEST_ASSERT_EQUAL_STRING("Caf\xc3\xa9", find_book_by_id(&restored, 3)->title);
+    TEST_ASSERT_EQUAL_INT(0, find_book_by_id(&restored, 3)->is_available);
+    TEST_ASSERT_EQUAL_STRING("Reader, A", find_member_by_id(&restored, 1)->name);
+    TEST_ASSERT_EQUAL_INT(3, find_member_by_id(&restored, 1)->borrowed_books[0]);
+    TEST_ASSERT_EQUAL_INT(4, get_next_book_id());
+    TEST_ASSERT_EQUAL_INT(0, import_library_books(&restored, books_path, format));
+
+    // Cleanup
+    remove(books_path);
+    remove(members_path);
+    deinit_library(&restored);
+    deinit_library(&library);
+}
+
+void test_json_lines_dump_round_trip(void) {
+    assert_dump_round_trip(DUMP_JSON_LINES);
+}
+
+void test_csv_dump_round_trip(void) {
+    assert_dump_round_trip(DUMP_CSV);
+}
+
+void test_import_library_books_reads_escapes_and_skips_bad_rows(void) {
+    const char *filename = "test_dump_escapes.jsonl";
+    FILE *file = fopen(filename, "wb");
+    fputs("{\"title\":\"Caf\\u00e9 \\ud83d\\ude00\",\"author\":\"A\",\"isbn\":\"1\","
+          "\"tags\":[\"x\",{\"y\":null}]}\n"
+          "{\"title\":\"Broken\"\n"
+          "\n"
+          "{\"id\":7,\"title\":\"Seven\",\"author\":\"B\",\"isbn\":\"7\"}\n",
+          file);
+    fclose(file);
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+
+    // Act
+    int added = import_library_books(&library, filename, DUMP_JSON_LINES);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(2, added);
+    TEST_ASSERT_EQUAL_STRING("Caf\xc3\xa9 \xf0\x9f\x98\x80", find_book_by_id(&library, 1)->title);
+    TEST_ASSERT_EQUAL_STRING("Seven", find_book_by_id(&library, 7)->title);
+    TEST_ASSERT_EQUAL_INT(8, get_next_book_id());
+
+    // Cleanup
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_csv_book_dump_is_readable_by_import_books_from_file(void) {
+    const char *filename = "test_dump_books.csv";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    add_book_to_library(&library, "Dune, Part One", "Frank Herbert", "1");
+    export_library_books(&library, filename, DUMP_CSV);
+    Library imported = {0};
+    init_library(&imported);
+
+    // Act
+    int added = import_books_from_file(&imported, filename, ',', 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, added);
+    TEST_ASSERT_EQUAL_STRING("Dune, Part One", imported.books[0].title);
+    TEST_ASSERT_EQUAL_STRING("1", imported.books[0].isbn);
+
+    // Cleanup
+    remove(filename);
+    deinit_library(&imported);
+    deinit_library(&library);
+}
+
+static long file_size(const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+void test_packed_encoding_round_trip_is_smaller(void) {
+    const char *records_file = "test_records_library.dat";
+    const char *packed_file = "test_packed_library.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    for (int i = 0; i < 500; i++) {
+        char isbn[MAX_ISBN_LENGTH];
+        snprintf(isbn, sizeof(isbn), "97804411%05d", i);
+        add_book_to_library(&library, i % 2 ? "Dune" : "Emma",
+                            i % 2 ? "Frank Herbert" : "Jane Austen", isbn);
+    }
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    borrow_book(&library, 1, 3);
+    borrow_book(&library, 1, 400);
+    remove_book_from_library(&library, 2);
+    library.books[0].added_date = 1700000000;
+    library.journal_lsn = 42;
+    save_library_to_file(&library, records_file);
+
+    // Act
+    library.file_encoding = FILE_ENCODING_PACKED;
+    int saved = save_library_to_file(&library, packed_file);
+    Library *loaded = load_library_from_file(packed_file);
+    Library *mapped = map_library_from_file(packed_file, 1);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, saved);
+    TEST_ASSERT_TRUE(file_size(packed_file) * 5 < file_size(records_file));
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_NOT_NULL(mapped);
+    TEST_ASSERT_EQUAL_INT(499, loaded->num_books);
+    TEST_ASSERT_EQUAL_INT(499, mapped->num_books);
+    TEST_ASSERT_EQUAL_INT(0, mapped->books_mapped);
+    TEST_ASSERT_NULL(find_book_by_id(loaded, 2));
+    TEST_ASSERT_EQUAL_STRING("Emma", find_book_by_id(loaded, 1)->title);
+    TEST_ASSERT_EQUAL_INT(1700000000, (long)find_book_by_id(loaded, 1)->added_date);
+    TEST_ASSERT_EQUAL_STRING("Frank Herbert", find_book_by_id(loaded, 500)->author);
+    TEST_ASSERT_EQUAL_STRING("9780441100499", find_book_by_id(loaded, 500)->isbn);
+    TEST_ASSERT_FALSE(find_book_by_id(loaded, 400)->is_available);
+    TEST_ASSERT_EQUAL_INT(2, find_member_by_id(loaded, 1)->num_borrowed_books);
+    TEST_ASSERT_EQUAL_INT(400, find_member_by_id(loaded, 1)->borrowed_books[1]);
+    TEST_ASSERT_EQUAL_STRING("reader@example.com", find_member_by_id(loaded, 1)->email);
+    TEST_ASSERT_EQUAL_UINT32(find_book_by_id(&library, 4)->author_id,
+                             find_book_by_id(loaded, 4)->author_id);
+    TEST_ASSERT_EQUAL_UINT64(42, loaded->journal_lsn);
+
+    // Cleanup
+    delete_library(mapped);
+    delete_library(loaded);
+    remove(records_file);
+    remove(packed_file);
+    deinit_library(&library);
+}
+
+void test_open_library_lazily_pages_records_on_demand(void) {
+    const char *filename = "test_lazy_library.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    for (int i = 0; i < 600; i++) {
+        add_book_to_library(&library, "Title", "Author", "ISBN");
+    }
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    borrow_book(&library, 1, 550);
+    remove_book_from_library(&library, 10);
+    save_library_to_file(&library, filename);
+
+    // Act
+    LazyLibrary *lazy = open_library_lazily(filename, 2);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(lazy);
+    TEST_ASSERT_EQUAL_INT(599, lazy_count_books(lazy));
+    TEST_ASSERT_EQUAL_INT(598, lazy_available_books(lazy));
+    TEST_ASSERT_EQUAL_INT(0, lazy->page_reads);
+    TEST_ASSERT_FALSE(lazy_find_book_by_id(lazy, 550)->is_available);
+    TEST_ASSERT_EQUAL_INT(1, lazy->page_reads);
+    TEST_ASSERT_EQUAL_INT(551, lazy_find_book_by_id(lazy, 551)->ident);
+    TEST_ASSERT_EQUAL_INT(1, lazy->cache_hits);
+    TEST_ASSERT_NULL(lazy_find_book_by_id(lazy, 10));
+    TEST_ASSERT_NULL(lazy_find_book_by_id(lazy, 601));
+    TEST_ASSERT_EQUAL_INT(1, lazy_book_at(lazy, 0)->ident);
+    TEST_ASSERT_EQUAL_INT(300, lazy_book_at(lazy, 298)->ident);
+    TEST_ASSERT_EQUAL_INT(550, lazy_find_member_by_id(lazy, 1)->borrowed_books[0]);
+    TEST_ASSERT_NULL(lazy_book_at(lazy, 599));
+    TEST_ASSERT_EQUAL_INT(4, lazy->page_reads);
+
+    // Cleanup
+    close_lazy_library(lazy);
+    library.file_encoding = FILE_ENCODING_PACKED;
+    save_library_to_file(&library, filename);
+    TEST_ASSERT_NULL(open_library_lazily(filename, 2));
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_load_library_shards_merges_shards_in_id_order(void) {
+    const char *prefix = "test_shard_library";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    for (int i = 0; i < 1000; i++) {
+        char title[MAX_TITLE_LENGTH];
+        char isbn[MAX_ISBN_LENGTH];
+        snprintf(title, sizeof(title), "Volume %d", i + 1);
+        snprintf(isbn, sizeof(isbn), "97804411%05d", i);
+        add_book_to_library(&library, title, i % 2 ? "Frank Herbert" : "Jane Austen", isbn);
+    }
+    for (int i = 0; i < 10; i++) {
+        add_member_to_library(&library, "Reader", "reader@example.com");
+    }
+    borrow_book(&library, 9, 777);
+    remove_book_from_library(&library, 250);
+    library.journal_lsn = 7;
+
+    // Act
+    int saved = save_library_shards(&library, prefix, 4);
+    Library *loaded = load_library_shards(prefix, 4, 2);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, saved);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(999, loaded->num_books);
+    TEST_ASSERT_EQUAL_INT(10, loaded->num_members);
+    TEST_ASSERT_EQUAL_UINT64(7, loaded->journal_lsn);
+    for (int i = 1; i < loaded->num_books; i++) {
+        TEST_ASSERT_TRUE(loaded->books[i - 1].ident < loaded->books[i].ident);
+    }
+    TEST_ASSERT_NULL(find_book_by_id(loaded, 250));
+    TEST_ASSERT_FALSE(find_book_by_id(loaded, 777)->is_available);
+    TEST_ASSERT_EQUAL_INT(998, available_book_total(loaded));
+    TEST_ASSERT_EQUAL_STRING("Volume 1000", find_book_by_id(loaded, 1000)->title);
+    TEST_ASSERT_EQUAL_INT(777, find_member_by_id(loaded, 9)->borrowed_books[0]);
+    int num_results = 0;
+    Book *results = search_books(loaded, "volume", &num_results);
+    TEST_ASSERT_EQUAL_INT(999, num_results);
+    free(results);
+    results = find_books_by_author(loaded, "Jane Austen", &num_results);
+    TEST_ASSERT_EQUAL_INT(500, num_results);
+    free(results);
+    TEST_ASSERT_NULL(load_library_shards(prefix, 5, 2));
+
+    // Cleanup
+    delete_library(loaded);
+    for (int i = 0; i < 4; i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "%s.%d", prefix, i);
+        remove(path);
+    }
+    deinit_library(&library);
+}
+
+void test_load_library_shards_rejects_shards_of_different_generations(void) {
+    const char *prefix = "test_shard_generations";
+    const char *next_prefix = "test_shard_generations_next";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    for (int i = 0; i < 10; i++) {
+        add_book_to_library(&library, "Volume", "Jane Austen", "");
+    }
+    save_library_shards(&library, prefix, 2);
+    Library *first = load_library_shards(prefix, 2, 1);
+    advance_library_generation(&library);
+    save_library_shards(&library, next_prefix, 2);
+
+    // Act
+    // Shard 1 of the next save, with the same journal position, replaces
+    // shard 1 of the first
+    char path[64];
+    char next_path[64];
+    snprintf(path, sizeof(path), "%s.1", prefix);
+    snprintf(next_path, sizeof(next_path), "%s.1", next_prefix);
+    rename(next_path, path);
+    Library *mixed = load_library_shards(prefix, 2, 1);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_EQUAL_UINT64(1, first->generation);
+    TEST_ASSERT_NULL(mixed);
+
+    // Cleanup
+    deinit_library(first);
+    free(first);
+    for (int i = 0; i < 2; i++) {
+        snprintf(path, sizeof(path), "%s.%d", prefix, i);
+        remove(path);
+        snprintf(path, sizeof(path), "%s.%d", next_prefix, i);
+        remove(path);
+    }
+    deinit_library(&library);
+}
+
+void test_load_library_from_file_restores_id_high_water_marks(void) {
+    const char *filename = "test_id_marks_library.dat";
+    Library library = {0};
+    init_library(&library);
+    reset_book_id();
+    reset_next_member_id();
+    add_book_to_library(&library, "Emma", "Jane Austen", "1");
+    add_book_to_library(&library, "Dune", "Frank Herbert", "2");
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    add_member_to_library(&library, "Other", "other@example.com");
+    remove_book_from_library(&library, 2);
+    remove_member_from_library(&library, 2);
+    save_library_to_file(&library, filename);
+    reset_book_id();
+    reset_next_member_id();
+
+    // Act
+    Library *loaded = load_library_from_file(filename);
+
+    // Assert
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(3, get_next_book_id());
+    TEST_ASSERT_EQUAL_INT(3, get_next_member_id());
+    add_book_to_library(loaded, "Persuasion", "Jane Austen", "3");
+    TEST_ASSERT_EQUAL_INT(3, loaded->books[loaded->num_books - 1].ident);
+
+    // Cleanup
+    delete_library(loaded);
+    remove(filename);
+    deinit_library(&library);
+}
+
+typedef struct {
+    int *ids;
+    int count;
+} IdWorker;
+
+static void *take_ids(void *argument) {
+    IdWorker *worker = (IdWorker *)argument;
+    IdBlock block = {0, 0};
+    for (int i = 0; i < worker->count; i++) {
+        worker->ids[i] = id_block_take(&block, book_id_allocator(), 64);
+    }
+    id_block_release(&block, book_id_allocator());
+    return NULL;
+}
+
+void test_book_id_blocks_are_unique_across_threads(void) {
+    enum { WORKERS = 4, PER_WORKER = 10000 };
+    static int ids[WORKERS * PER_WORKER];
+    IdWorker workers[WORKERS];
+    pthread_t threads[WORKERS];
+    reset_book_id();
+
+    // Act
+    for (int i = 0; i < WORKERS; i++) {
+        workers[i].ids = ids + i * PER_WORKER;
+        workers[i].count = PER_WORKER;
+        pthread_create(&threads[i], NULL, take_ids, &workers[i]);
+    }
+    for (int i = 0; i < WORKERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Assert
+    int highest = get_next_book_id();
+    unsigned char *seen = (unsigned char *)calloc((size_t)highest, 1);
+    for (int i = 0; i < WORKERS * PER_WORKER; i++) {
+        TEST_ASSERT_TRUE(ids[i] > 0 && ids[i] < highest);
+        TEST_ASSERT_EQUAL_INT(0, seen[ids[i]]);
+        seen[ids[i]] = 1;
+    }
+    TEST_ASSERT_TRUE(highest <= WORKERS * PER_WORKER + WORKERS * 64 + 1);
+
+    // Cleanup
+    free(seen);
+}
+
+void test_persisted_indexes_are_restored_until_stale(void) {
+    const char *filename = "test_persisted_indexes_library.dat";
+    Library library = {0};
+    init_library(&library);
+    library.removal_mode = REMOVAL_TOMBSTONE;
+    add_book_to_library(&library, "Emma", "Jane Austen", "9780141439518");
+    add_book_to_library(&library, "Dune", "Frank Herbert", "9780441013593");
+    add_book_to_library(&library, "Persuasion", "Jane Austen", "9780143105428");
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    int dune = library.books[1].ident;
+    int persuasion = library.books[2].ident;
+    remove_book_from_library(&library, dune);
+    save_library_to_file(&library, filename);
+    advance_library_generation(&library);
+
+    // Act
+    Library *loaded = load_library_from_file(filename);
+    Library *mapped = map_library_from_file(filename, 1);
+    FILE *file = fopen(filename, "rb");
+    LibraryFileTable table;
+    Library restored = {0};
+    init_library(&restored);
+    library_file_read_table(file, &table);
+    library_file_read_generation(
+        file, library_file_find_section(&table, SECTION_GENERATION), &restored);
+    int parts = library_file_read_book_indexes(file, &table, &restored);
+    int member_index = library_file_read_member_index(file, &table, &restored);
+    const SectionEntry *ids =
+        library_file_find_section(&table, SECTION_BOOK_ID_INDEX);
+    unsigned char record[INDEX_STAMP_SIZE];
+    IndexStamp stamp;
+    fseek(file, (long)ids->offset, SEEK_SET);
+    TEST_ASSERT_EQUAL_size_t(sizeof(record), fread(record, 1, sizeof(record), file));
+    decode_index_stamp(record, &stamp);
+    fclose(file);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT64(1, library.generation);
+    TEST_ASSERT_EQUAL_UINT64(library.generation, restored.generation);
+    TEST_ASSERT_EQUAL_INT(BOOK_INDEX_ID | BOOK_INDEX_ISBN | BOOK_INDEX_TEXT,
+                          parts);
+    TEST_ASSERT_EQUAL_INT(1, member_index);
+    TEST_ASSERT_TRUE(
+        library_file_index_is_current(&table, &stamp, restored.generation));
+    stamp.generation++;
+    TEST_ASSERT_FALSE(
+        library_file_index_is_current(&table, &stamp, restored.generation));
+    stamp.generation--;
+    stamp.source_crc ^= 1;
+    TEST_ASSERT_FALSE(
+        library_file_index_is_current(&table, &stamp, restored.generation));
+
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_NULL(find_book_by_id(loaded, dune));
+    TEST_ASSERT_EQUAL_STRING("Persuasion",
+                             find_book_by_id(loaded, persuasion)->title);
+    TEST_ASSERT_EQUAL_INT(
+        persuasion, find_book_by_isbn(loaded, "9780143105428")->ident);
+    int num_results = 0;
+    Book *results = search_books(loaded, "austen", &num_results);
+    TEST_ASSERT_EQUAL_INT(2, num_results);
+    free(results);
+
+    TEST_ASSERT_NOT_NULL(mapped);
+    TEST_ASSERT_TRUE(mapped->book_index.borrowed);
+    TEST_ASSERT_EQUAL_INT(persuasion,
+                          find_book_by_isbn(mapped, "9780143105428")->ident);
+    add_book_to_library(mapped, "Dune Messiah", "Frank Herbert", "9780306406157");
+    TEST_ASSERT_EQUAL_STRING(
+        "Dune Messiah",
+        find_book_by_isbn(mapped, "9780306406157")->title);
+    TEST_ASSERT_EQUAL_STRING("Emma",
+                             find_book_by_id(mapped, library.books[0].ident)->title);
+
+    // Cleanup
+    deinit_library(&restored);
+    delete_library(loaded);
+    delete_library(mapped);
+    remove(filename);
+    deinit_library(&library);
+}
+
+void test_persisted_index_without_an_empty_slot_is_rebuilt(void) {
+    const char *filename = "test_full_index_library.dat";
+    Library library = {0};
+    init_library(&library);
+    add_book_to_library(&library, "Emma", "Jane Austen", "9780141439518");
+    add_book_to_library(&library, "Dune", "Frank Herbert", "9780441013593");
+    save_library_to_file(&library, filename);
+    advance_library_generation(&library);
+    save_library_to_file(&library, filename);
+    advance_library_generation(&library);
+    // Damage the book ID table so that every slot holds a key
+    FILE *file = fopen(filename, "r+b");
+    LibraryFileTable table;
+    library_file_read_table(file, &table);
+    const SectionEntry *ids =
+        library_file_find_section(&table, SECTION_BOOK_ID_INDEX);
+    unsigned char record[INDEX_STAMP_SIZE];
+    IndexStamp stamp;
+    fseek(file, (long)ids->offset, SEEK_SET);
+    TEST_ASSERT_EQUAL_size_t(sizeof(record), fread(record, 1, sizeof(record), file));
+    decode_index_stamp(record, &stamp);
+    fseek(file, (long)(ids->offset + INDEX_STAMP_SIZE), SEEK_SET);
+    for (uint32_t i = 0; i < stamp.capacity; i++) {
+        uint64_t key = 1000 + i;
+        fwrite(&key, sizeof(key), 1, file);
+    }
+    for (uint32_t i = 0; i < stamp.capacity; i++) {
+        int slot = 0;
+        fwrite(&slot, sizeof(slot), 1, file);
+    }
+    fclose(file);
+
+    // Act
+    Library *mapped = map_library_from_file(filename, 0);
+
+    // Assert
+    TEST_ASSERT_EQUAL_UINT64(2, library.generation);
+    TEST_ASSERT_NOT_NULL(mapped);
+    TEST_ASSERT_FALSE(mapped->book_index.borrowed);
+    TEST_ASSERT_NULL(find_book_by_id(mapped, 999));
+    TEST_ASSERT_EQUAL_STRING("Dune",
+                             find_book_by_id(mapped, library.books[1].ident)->title);
+
+    // Cleanup
+    delete_library(mapped);
+    remove(filename);
+    deinit_library(&library);
+}
+
+typedef struct {
+    Library *library;
+    int member_id;
+    int first_book;
+    int num_books;
+    int rounds;
+} CheckoutWorker;
+
+static void *churn_checkouts(void *argument) {
+    CheckoutWorker *worker = (CheckoutWorker *)argument;
+    for (int round = 0; round < worker->rounds; round++) {
+        for (int i = 0; i < worker->num_books; i++) {
+            int book_id = worker->first_book + i;
+            if (borrow_book(worker->library, worker->member_id, book_id)) {
+                return_book(worker->library, worker->member_id, book_id);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void *add_more_books(void *argument) {
+    CheckoutWorker *worker = (CheckoutWorker *)argument;
+    for (int i = 0; i < worker->num_books; i++) {
+        add_book_to_library(worker->library, "Sequel", "Author", "");
+    }
+    return NULL;
+}
+
+void test_concurrent_checkouts_keep_counts_consistent(void) {
+    enum { WORKERS = 4, BOOKS_PER_WORKER = 16, ADDED = 500 };
+    Library library = {0};
+    init_library(&library);
+    for (int i = 0; i < WORKERS * BOOKS_PER_WORKER; i++) {
+        add_book_to_library(&library, "Title", "Author", "");
+    }
+    CheckoutWorker workers[WORKERS + 1];
+    pthread_t threads[WORKERS + 1];
+    for (int i = 0; i < WORKERS; i++) {
+        add_member_to_library(&library, "Reader", "reader@example.com");
+        workers[i] = (CheckoutWorker){&library,
+                                      library.members[i].ident,
+                                      library.books[0].ident,
+                                      WORKERS * BOOKS_PER_WORKER,
+                                      200};
+    }
+    workers[WORKERS] = (CheckoutWorker){&library, 0, 0, ADDED, 1};
+    TEST_ASSERT_EQUAL_INT(1, enable_library_concurrency(&library));
+
+    // Act
+    for (int i = 0; i < WORKERS; i++) {
+        pthread_create(&threads[i], NULL, churn_checkouts, &workers[i]);
+    }
+    pthread_create(&threads[WORKERS], NULL, add_more_books, &workers[WORKERS]);
+    for (int i = 0; i <= WORKERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Assert
+    int total = WORKERS * BOOKS_PER_WORKER + ADDED;
+    TEST_ASSERT_EQUAL_INT(total, library.num_books);
+    TEST_ASSERT_EQUAL_INT(total, library.num_available_books);
+    TEST_ASSERT_EQUAL_INT(
+        total,
+        count_available_books_in_range(
+            &library, 1, library.books[total - 1].ident));
+    for (int i = 0; i < WORKERS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, library.members[i].num_borrowed_books);
+    }
+    for (int i = 0; i < total; i++) {
+        TEST_ASSERT_EQUAL_INT(1, library.books[i].is_available);
+        TEST_ASSERT_EQUAL_PTR(&library.books[i],
+                              find_book_by_id(&library, library.books[i].ident));
+    }
+
+    // Cleanup
+    disable_library_concurrency(&library);
+    deinit_library(&library);
+}
+
+enum { HOT_BOOKS = 8, MOST_HELD = 3 };
+
+typedef struct {
+    Library *library;
+    int member_id;
+    int first_book;
+    unsigned int seed;
+    atomic_int *holders;
+    atomic_int *double_lends;
+} StressWorker;
+
+static void *stress_checkouts(void *argument) {
+    StressWorker *worker = (StressWorker *)argument;
+    int held[MOST_HELD];
+    int num_held = 0;
+    for (int round = 0; round < 1000; round++) {
+        worker->seed = worker->seed * 1103515245U + 12345U;
+        int slot = (int)(worker->seed >> 16) % HOT_BOOKS;
+        int book_id = worker->first_book + slot;
+        if (num_held < MOST_HELD &&
+            worker->library->books[slot].is_available &&
+            borrow_book(worker->library, worker->member_id, book_id)) {
+            if (atomic_fetch_add(&worker->holders[slot], 1) != 0) {
+                atomic_fetch_add(worker->double_lends, 1);
+            }
+            held[num_held++] = book_id;
+        } else if (num_held > 0) {
+            int returned = held[--num_held];
+            atomic_fetch_sub(&worker->holders[returned - worker->first_book],
+                             1);
+            return_book(worker->library, worker->member_id, returned);
+        }
+    }
+    while (num_held > 0) {
+        int returned = held[--num_held];
+        atomic_fetch_sub(&worker->holders[returned - worker->first_book], 1);
+        return_book(worker->library, worker->member_id, returned);
+    }
+    return NULL;
+}
+
+void test_lock_free_checkouts_never_double_lend(void) {
+    enum { WORKERS = 6 };
+    Library library = {0};
+    init_library(&library);
+    for (int i = 0; i < HOT_BOOKS; i++) {
+        add_book_to_library(&library, "Title", "Author", "");
+    }
+    // Threads share members, so loan slots are contended as well as books
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    atomic_int holders[HOT_BOOKS] = {0};
+    atomic_int double_lends = 0;
+    StressWorker workers[WORKERS];
+    pthread_t threads[WORKERS];
+    for (int i = 0; i < WORKERS; i++) {
+        workers[i] = (StressWorker){&library,
+                                    library.members[i % 2].ident,
+                                    library.books[0].ident,
+                                    (unsigned int)i + 1U,
+                                    holders,
+                                    &double_lends};
+    }
+    enable_library_concurrency(&library);
+
+    // Act
+    for (int i = 0; i < WORKERS; i++) {
+        pthread_create(&threads[i], NULL, stress_checkouts, &workers[i]);
+    }
+    for (int i = 0; i < WORKERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(0, double_lends);
+    TEST_ASSERT_EQUAL_INT(HOT_BOOKS, library.num_available_books);
+    TEST_ASSERT_EQUAL_INT(
+        HOT_BOOKS,
+        count_available_books_in_range(
+            &library, 1, library.books[HOT_BOOKS - 1].ident));
+    for (int i = 0; i < HOT_BOOKS; i++) {
+        TEST_ASSERT_EQUAL_INT(1, library.books[i].is_available);
+    }
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL_INT(0, library.members[i].num_borrowed_books);
+        for (int j = 0; j < MAX_BORROWED_BOOKS; j++) {
+            TEST_ASSERT_EQUAL_INT(0, library.members[i].borrowed_books[j]);
+        }
+    }
+
+    // Cleanup
+    disable_library_concurrency(&library);
+    deinit_library(&library);
+}
+
+void test_loans_may_sit_in_any_slot(void) {
+    const char *filename = "test_loan_slots_library.dat";
+    Library library = {0};
+    init_library(&library);
+    library.file_encoding = FILE_ENCODING_PACKED;
+    for (int i = 0; i < 3; i++) {
+        add_book_to_library(&library, "Title", "Author", "");
+    }
+    add_member_to_library(&library, "Reader", "reader@example.com");
+    int member_id = library.members[0].ident;
+    for (int i = 0; i < 3; i++) {
+        borrow_book(&library, member_id, library.books[i].ident);
+    }
+
+    // Act
+    return_book(&library, member_id, library.books[0].ident);
+    save_library_to_file(&library, filename);
+    Library *loaded = load_library_from_file(filename);
+
+    // Assert
+    Member *member = &library.members[0];
+    TEST_ASSERT_EQUAL_INT(0, member->borrowed_books[0]);
+    TEST_ASSERT_EQUAL_INT(2, member->num_borrowed_books);
+    TEST_ASSERT_NOT_NULL(loaded);
+    Member *restored = find_member_by_id(loaded, member_id);
+    TEST_ASSERT_EQUAL_INT(2, restored->num_borrowed_books);
+    TEST_ASSERT_EQUAL_INT(library.books[1].ident, restored->borrowed_books[0]);
+    TEST_ASSERT_EQUAL_INT(library.books[2].ident, restored->borrowed_books[1]);
+    TEST_ASSERT_EQUAL_INT(
+        1, return_book(loaded, member_id, library.books[2].ident));
+    TEST_ASSERT_EQUAL_INT(
+        1, borrow_book(&library, member_id, library.books[0].ident));
+    TEST_ASSERT_EQUAL_INT(library.books[0].ident, member->borrowed_books[0]);
+
+    // Cleanup
+    remove(filename);
+    deinit_library(loaded);
+    free(loaded);
+    deinit_library(&library);
+}
+
+void test_consortium_shards_by_hash_and_lends_across_branches(void) {
+    Consortium *consortium = create_consortium(4, CONSORTIUM_SHARD_BY_HASH, 2);
+    int book_ids[40];
+    for (int i = 0; i < 40; i++) {
+        book_ids[i] = consortium_add_book(consortium, -1, "Title", "A", "");
+    }
+    int member_id = consortium_add_member(
+        consortium, -1, "Reader", "reader@example.com");
+
+    // Act
+    int member_branch = consortium_member_branch(consortium, member_id);
+    int far_book = 0;
+    for (int i = 0; i < 40 && !far_book; i++) {
+        if (consortium_book_branch(consortium, book_ids[i]) != member_branch) {
+            far_book = book_ids[i];
+        }
+    }
+    int borrowed = consortium_borrow_book(consortium, member_id, far_book);
+
+    // Assert
+    int total = 0;
+    int used_branches = 0;
+    for (int i = 0; i < 4; i++) {
+        int books = count_books(consortium_branch(consortium, i));
+        total += books;
+        used_branches += books > 0;
+    }
+    TEST_ASSERT_EQUAL_INT(40, total);
+    TEST_ASSERT_EQUAL_INT(4, used_branches);
+    for (int i = 0; i < 40; i++) {
+        Library *branch = consortium_branch(
+            consortium, consortium_book_branch(consortium, book_ids[i]));
+        TEST_ASSERT_TRUE(find_book_slot(branch, book_ids[i]) >= 0);
+    }
+    TEST_ASSERT_NOT_EQUAL(0, far_book);
+    TEST_ASSERT_EQUAL_INT(1, borrowed);
+    Library *home = consortium_branch(consortium, member_branch);
+    Member *member = find_member_by_id(home, member_id);
+    TEST_ASSERT_EQUAL_INT(1, member->num_borrowed_books);
+    TEST_ASSERT_EQUAL_INT(
+        0, consortium_borrow_book(consortium, member_id, far_book));
+    TEST_ASSERT_EQUAL_INT(
+        1, consortium_return_book(consortium, member_id, far_book));
+    TEST_ASSERT_EQUAL_INT(0, member->num_borrowed_books);
+    int available = 0;
+    for (int i = 0; i < 4; i++) {
+        available += available_book_total(consortium_branch(consortium, i));
+    }
+    TEST_ASSERT_EQUAL_INT(40, available);
+
+    // Cleanup
+    delete_consortium(consortium);
+}
+
+void test_consortium_finds_nearest_available_copy(void) {
+    Consortium *consortium = create_consortium(3, CONSORTIUM_SHARD_BY_BRANCH, 4);
+    const char *isbn = "978-0-441-01359-3";
+    int first = consortium_add_book(consortium, 0, "Dune", "Herbert", isbn);
+    int last = consortium_add_book(consortium, 2, "Dune", "Herbert", isbn);
+    // A branch big enough that its title scan is split across threads
+    BookRecord *filler = calloc(10000, sizeof(BookRecord));
+    for (int i = 0; i < 10000; i++) {
+        filler[i] = (BookRecord){"Filler", "Author", "", 0, 0};
+    }
+    add_books_bulk(consortium_branch(consortium, 1), filler, 10000);
+    int middle = consortium_add_book(consortium, 1, "DUNE", "Herbert", "");
+    int member_id = consortium_add_member(
+        consortium, 2, "Reader", "reader@example.com");
+    ConsortiumCopy copy = {-1, 0};
+
+    // Act
+    int found = consortium_find_available_copy(consortium, isbn, 1, &copy);
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, found);
+    TEST_ASSERT_EQUAL_INT(2, copy.branch);
+    TEST_ASSERT_EQUAL_INT(last, copy.book_id);
+    TEST_ASSERT_EQUAL_INT(2, consortium_member_branch(consortium, member_id));
+    TEST_ASSERT_EQUAL_INT(
+        0,
+        add_member_with_id(
+            consortium_branch(consortium, 2), member_id, "Copy", "c@d.e"));
+
+    TEST_ASSERT_EQUAL_INT(
+        1, consortium_find_available_copy(consortium, "dune", 1, &copy));
+    TEST_ASSERT_EQUAL_INT(1, copy.branch);
+    TEST_ASSERT_EQUAL_INT(middle, copy.book_id);
+
+    TEST_ASSERT_EQUAL_INT(
+        1, consortium_borrow_book(consortium, member_id, first));
+    TEST_ASSERT_EQUAL_INT(
+        1, consortium_find_available_copy(consortium, isbn, 0, &copy));
+    TEST_ASSERT_EQUAL_INT(2, copy.branch);
+    TEST_ASSERT_EQUAL_INT(
+        0, consortium_find_available_copy(consortium, "Missing", 0, &copy));
+    TEST_ASSERT_EQUAL_INT(0, consortium_add_book(consortium, 3, "X", "Y", ""));
+
+    // Cleanup
+    free(filler);
+    delete_consortium(consortium);
+}
+
+void test_exclusive_locks_on_several_libraries_stay_reentrant(void) {
+    Library first = {0};
+    Library second = {0};
+    init_library(&first);
+    init_library(&second);
+    enable_library_concurrency(&first);
+    enable_library_concurrency(&second);
+
+    // Act
+    library_lock_exclusive(&first);
+    library_lock_exclusive(&second);
+    library_unlock_exclusive(&second);
+    // Both lock first again; neither may block on the held lock
+    int added = add_book_to_library(&first, "Emma", "Jane Austen", "");
+    int found = find_book_by_id(&first, first.books[0].ident) != NULL;
+    library_unlock_exclusive(&first);
+    int added_after = add_book_to_library(&first, "Dune", "Herbert", "");
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(1, added);
+    TEST_ASSERT_EQUAL_INT(1, found);
+    TEST_ASSERT_EQUAL_INT(1, added_after);
+    TEST_ASSERT_EQUAL_INT(2, count_books(&first));
+
+    // Cleanup
+    deinit_library(&first);
+    deinit_library(&second);
+}
+
+void test_exclusive_locks_stay_reentrant_past_the_inline_table(void) {
+    enum { HELD = 20 };
+    Library branches[HELD] = {0};
+    for (int i = 0; i < HELD; i++) {
+        init_library(&branches[i]);
+        enable_library_concurrency(&branches[i]);
+    }
+
+    // Act
+    for (int i = 0; i < HELD; i++) {
+        library_lock_exclusive(&branches[i]);
+    }
+    // Every held library may be locked again without blocking
+    int added = 0;
+    for (int i = 0; i < HELD; i++) {
+        added += add_book_to_library(&branches[i], "Emma", "Jane Austen", "");
+    }
+    for (int i = HELD - 1; i >= 0; i--) {
+        library_unlock_exclusive(&branches[i]);
+    }
+    int added_after = add_book_to_library(&branches[HELD - 1], "Dune", "Herbert", "");
+
+    // Assert
+    TEST_ASSERT_EQUAL_INT(HELD, added);
+    TEST_ASSERT_EQUAL_INT(1, added_after);
+    TEST_ASSERT_EQUAL_INT(2, count_books(&branches[HELD - 1]));
+
+    // Cleanup
+    for (int i = 0; i < HELD; i++) {
+        deinit_library(&branches[i]);
+    }
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_init_library_with_valid_pointer);
@@ -246,5 +1815,41 @@ int main(void) {
     RUN_TEST(test_load_library_from_file_with_null_filename_pointer);
     RUN_TEST(test_load_library_from_file_with_unreadable_file);
     RUN_TEST(test_load_library_from_file_with_no_books_and_no_members);
+    RUN_TEST(test_load_library_from_file_rebuilds_book_index);
+    RUN_TEST(test_tombstone_removal_reuses_slots_and_keeps_indexes);
+    RUN_TEST(test_tombstone_removal_compacts_past_threshold);
+    RUN_TEST(test_save_library_to_file_skips_tombstones);
+    RUN_TEST(test_availability_counters_follow_transactions);
+    RUN_TEST(test_load_library_from_file_keeps_author_ids);
+    RUN_TEST(test_library_reserve_and_growth_policy);
+    RUN_TEST(test_load_library_from_file_rejects_corrupt_sections);
+    RUN_TEST(test_map_library_from_file_copies_on_write);
+    RUN_TEST(test_saving_a_mapped_library_over_its_file_keeps_the_mapping);
+    RUN_TEST(test_journal_replay_restores_operations_and_drops_torn_tail);
+    RUN_TEST(test_journal_adds_keep_reserved_ids_and_skip_merges);
+    RUN_TEST(test_journal_records_concurrent_loans_in_applied_order);
+    RUN_TEST(test_journal_checkpoint_truncates_and_skips_applied_records);
+    RUN_TEST(test_background_snapshot_captures_point_in_time);
+    RUN_TEST(test_background_snapshot_runs_beside_other_threads);
+    RUN_TEST(test_journal_checkpoints_in_background);
+    RUN_TEST(test_json_lines_dump_round_trip);
+    RUN_TEST(test_csv_dump_round_trip);
+    RUN_TEST(test_import_library_books_reads_escapes_and_skips_bad_rows);
+    RUN_TEST(test_csv_book_dump_is_readable_by_import_books_from_file);
+    RUN_TEST(test_packed_encoding_round_trip_is_smaller);
+    RUN_TEST(test_open_library_lazily_pages_records_on_demand);
+    RUN_TEST(test_load_library_shards_merges_shards_in_id_order);
+    RUN_TEST(test_load_library_shards_rejects_shards_of_different_generations);
+    RUN_TEST(test_load_library_from_file_restores_id_high_water_marks);
+    RUN_TEST(test_book_id_blocks_are_unique_across_threads);
+    RUN_TEST(test_persisted_indexes_are_restored_until_stale);
+    RUN_TEST(test_persisted_index_without_an_empty_slot_is_rebuilt);
+    RUN_TEST(test_concurrent_checkouts_keep_counts_consistent);
+    RUN_TEST(test_lock_free_checkouts_never_double_lend);
+    RUN_TEST(test_loans_may_sit_in_any_slot);
+    RUN_TEST(test_exclusive_locks_on_several_libraries_stay_reentrant);
+    RUN_TEST(test_exclusive_locks_stay_reentrant_past_the_inline_table);
+    RUN_TEST(test_consortium_shards_by_hash_and_lends_across_branches);
+    RUN_TEST(test_consortium_finds_nearest_available_copy);
     return UNITY_END();
 }
@@ -1,5 +1,8 @@
 #include "unity.h"
 #include "member_management.h"
+#include "book_management.h"
+#include "hash_index.h"
+#include "library_management.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -41,7 +44,7 @@ void test_init_member_with_empty_strings(void)
 void test_add_member_to_library_increases_member_count(void)
 {
     // Arrange
-    Library library;
+    Library library = {0};
     library.num_members = 0;
     library.capacity_members = 2;
     library.members = (Member *)malloc((size_t)library.capacity_members * sizeof(Member));
@@ -75,7 +78,7 @@ void test_find_member_by_id_in_null_library(void)
 void test_remove_member_from_library_decreases_member_count(void)
 {
     // Arrange
-    Library library;
+    Library library = {0};
     library.num_members = 2;
     library.capacity_members = 2;
     library.members = (Member *)malloc((size_t)library.capacity_members * sizeof(Member));
@@ -100,7 +103,7 @@ void test_remove_member_from_library_decreases_member_count(void)
 void test_borrow_book_when_member_reached_max_borrowed_books(void)
 {
     // Arrange
-    Library library;
+    Library library = {0};
     library.num_members = 1;
     library.capacity_members = 1;
     library.members = (Member *)malloc((size_t)library.capacity_members * sizeof(Member));
@@ -127,7 +130,7 @@ void test_list_all_members_prints_member_details(void)
 {
     reset_next_member_id();
     // Arrange
-    Library library;
+    Library library = {0};
     library.num_members = 2;
     library.capacity_members = 2;
     library.members = (Member *)malloc((size_t)library.capacity_members * sizeof(Member));
@@ -136,7 +139,7 @@ void test_list_all_members_prints_member_details(void)
     init_member(&library.members[1], "Bob Johnson", "bob.johnson@example.com");
 
     // Redirect stdout to a buffer to capture print output
-    char buffer[1024];
+    char buffer[1024] = {0};
     FILE *stream = tmpfile();
     if (!stream) {
         perror("tmpfile");
@@ -175,6 +178,88 @@ void test_list_all_members_prints_member_details(void)
     free(library.members);
 }
 
+void test_member_index_tracks_add_and_remove(void)
+{
+    // Arrange
+    reset_next_member_id();
+    Library library = {0};
+    library.capacity_members = 2;
+    library.members = (Member *)malloc((size_t)library.capacity_members * sizeof(Member));
+    TEST_ASSERT_EQUAL(1, rebuild_member_index(&library));
+
+    // Act
+    for (int i = 0; i < 40; i++) {
+        add_member_to_library(&library, "Member", "member@example.com");
+    }
+    remove_member_from_library(&library, 5);
+
+    // Assert
+    TEST_ASSERT_EQUAL(39, library.num_members);
+    TEST_ASSERT_EQUAL(39, library.member_index.count);
+    TEST_ASSERT_NULL(find_member_by_id(&library, 5));
+    for (int ident = 6; ident <= 40; ident++) {
+        Member *member = find_member_by_id(&library, ident);
+        TEST_ASSERT_NOT_NULL(member);
+        TEST_ASSERT_EQUAL(ident, member->ident);
+    }
+
+    // Clean up
+    hash_index_deinit(&library.member_index);
+    free(library.members);
+}
+
+void test_loan_batches_report_each_outcome_in_order(void)
+{
+    // Arrange
+    Library library = {0};
+    init_library(&library);
+    for (int i = 0; i < 7; i++) {
+        add_book_to_library(&library, "Title", "Author", "");
+    }
+    add_member_to_library(&library, "Alice", "alice@example.com");
+    add_member_to_library(&library, "Bob", "bob@example.com");
+    int alice = library.members[0].ident;
+    int bob = library.members[1].ident;
+    int book[7];
+    for (int i = 0; i < 7; i++) {
+        book[i] = library.books[i].ident;
+    }
+    LoanRequest borrows[] = {
+        {alice, book[0]}, {bob, book[0]}, {alice, book[1]}, {bob, book[2]},
+        {alice, book[3]}, {alice, book[4]}, {alice, book[5]},
+        {alice, book[6]}, {-1, book[6]}, {bob, -1}};
+    LoanRequest returns[] = {{bob, book[0]}, {alice, book[0]}, {bob, book[2]}};
+    LoanResult borrowed[10];
+    LoanResult returned[3];
+
+    // Act
+    int lent = borrow_books_batch(&library, borrows, 10, borrowed);
+    int taken_back = return_books_batch(&library, returns, 3, returned);
+
+    // Assert
+    TEST_ASSERT_EQUAL(6, lent);
+    TEST_ASSERT_EQUAL(LOAN_OK, borrowed[0]);
+    TEST_ASSERT_EQUAL(LOAN_BOOK_UNAVAILABLE, borrowed[1]);
+    TEST_ASSERT_EQUAL(LOAN_OK, borrowed[3]);
+    TEST_ASSERT_EQUAL(LOAN_OK, borrowed[6]);
+    TEST_ASSERT_EQUAL(LOAN_LIMIT_REACHED, borrowed[7]);
+    TEST_ASSERT_EQUAL(LOAN_UNKNOWN_MEMBER, borrowed[8]);
+    TEST_ASSERT_EQUAL(LOAN_UNKNOWN_BOOK, borrowed[9]);
+    TEST_ASSERT_EQUAL(1, library.books[6].is_available);
+    TEST_ASSERT_EQUAL(2, taken_back);
+    TEST_ASSERT_EQUAL(LOAN_NOT_BORROWED, returned[0]);
+    TEST_ASSERT_EQUAL(LOAN_OK, returned[1]);
+    TEST_ASSERT_EQUAL(LOAN_OK, returned[2]);
+    TEST_ASSERT_EQUAL(4, library.members[0].num_borrowed_books);
+    TEST_ASSERT_EQUAL(0, library.members[1].num_borrowed_books);
+    TEST_ASSERT_EQUAL(3, library.num_available_books);
+    TEST_ASSERT_EQUAL(0, borrow_books_batch(&library, NULL, 0, NULL));
+    TEST_ASSERT_EQUAL(-1, return_books_batch(&library, NULL, 1, returned));
+
+    // Clean up
+    deinit_library(&library);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_create_member_with_null_name_and_email);
@@ -184,6 +269,8 @@ int main(void) {
     RUN_TEST(test_remove_member_from_library_decreases_member_count);
     RUN_TEST(test_borrow_book_when_member_reached_max_borrowed_books);
     RUN_TEST(test_list_all_members_prints_member_details);
+    RUN_TEST(test_member_index_tracks_add_and_remove);
+    RUN_TEST(test_loan_batches_report_each_outcome_in_order);
 
     return UNITY_END();
 }